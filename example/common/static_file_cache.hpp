@@ -0,0 +1,600 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_EXAMPLE_COMMON_STATIC_FILE_CACHE_HPP
+#define BOOST_BEAST_EXAMPLE_COMMON_STATIC_FILE_CACHE_HPP
+
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/response_template.hpp>
+#include <boost/beast/http/rfc7230.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/zlib/checksum.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/asio/buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*  An in-memory cache of static files for HTTP servers.
+
+    Files are read once and kept, together with a gzip encoded
+    copy when that is smaller, an entity tag and the serialized
+    response headers for each encoding. A cache hit produces a
+    response whose body refers to the cached bytes, so serving
+    it performs no disk I/O, no compression, no formatting of
+    the header and no copy of the payload.
+
+    The least recently used files are evicted when the total
+    size of the cached representations exceeds the capacity.
+    Files larger than the maximum file size are not cached;
+    @ref get returns null without an error for those, and the
+    caller should serve them with `http::file_body` instead.
+
+    Changes to files on disk are not detected. Call @ref clear
+    or @ref erase after updating the document root.
+
+    All member functions may be called concurrently.
+*/
+class static_file_cache
+{
+public:
+    /// A cached file
+    class asset
+    {
+        friend class static_file_cache;
+
+        struct variant
+        {
+            std::string data;
+            std::string etag;
+
+            // For HTTP/1.0 and HTTP/1.1, each
+            // with and without keep-alive
+            std::vector<boost::beast::http::response_template> headers;
+        };
+
+        variant identity_;
+        variant gzip_;
+        bool has_gzip_ = false;
+        std::string path_;
+
+    public:
+        /// The file name relative to the document root
+        std::string const&
+        path() const
+        {
+            return path_;
+        }
+
+        /// The entity tag of the contents, including the quotes
+        std::string const&
+        etag() const
+        {
+            return identity_.etag;
+        }
+
+        /// The entity tag of the gzip encoded contents, or empty
+        std::string const&
+        gzip_etag() const
+        {
+            return gzip_.etag;
+        }
+
+        /// The contents of the file
+        boost::beast::string_view
+        identity() const
+        {
+            return identity_.data;
+        }
+
+        /// The gzip encoded contents, or empty if not worthwhile
+        boost::beast::string_view
+        gzip() const
+        {
+            if(! has_gzip_)
+                return {};
+            return gzip_.data;
+        }
+
+        /// The number of bytes charged against the capacity
+        std::size_t
+        cost() const
+        {
+            return identity_.data.size() + gzip_.data.size();
+        }
+    };
+
+    /** A response produced for a cache hit.
+
+        The header is a copy of one serialized when the file was
+        loaded, which costs a single allocation. Only its slots,
+        such as the `Date` field, are changed per request. The body
+        refers to the data in the asset, which must remain valid
+        until the response is sent.
+    */
+    class response
+    {
+        friend class static_file_cache;
+
+        boost::beast::http::response_template header_;
+        boost::asio::const_buffer body_;
+
+        explicit
+        response(boost::beast::http::response_template const& h)
+            : header_(h)
+        {
+        }
+
+    public:
+        /// The type of buffer sequence returned by @ref buffers
+        using const_buffers_type = boost::beast::buffers_cat_view<
+            boost::asio::const_buffer, boost::asio::const_buffer>;
+
+        /// The serialized header
+        boost::beast::http::response_template&
+        header()
+        {
+            return header_;
+        }
+
+        /// The serialized header
+        boost::beast::http::response_template const&
+        header() const
+        {
+            return header_;
+        }
+
+        /// The body, which is empty for HEAD and 304 responses
+        boost::asio::const_buffer
+        body() const
+        {
+            return body_;
+        }
+
+        /// The complete response, to be written to a stream
+        const_buffers_type
+        buffers() const
+        {
+            return boost::beast::buffers_cat(header_.data(), body_);
+        }
+    };
+
+    /** Constructor
+
+        @param doc_root The directory holding the files.
+
+        @param capacity The most bytes of file data to keep.
+
+        @param max_file_size Larger files are not cached.
+    */
+    explicit
+    static_file_cache(
+        std::string doc_root,
+        std::size_t capacity = 64 * 1024 * 1024,
+        std::size_t max_file_size = 4 * 1024 * 1024)
+        : doc_root_(std::move(doc_root))
+        , capacity_(capacity)
+        , max_file_size_(max_file_size)
+    {
+        if(! doc_root_.empty() && (
+            doc_root_.back() == '/' || doc_root_.back() == '\\'))
+            doc_root_.pop_back();
+    }
+
+    /// Return the number of bytes of file data cached
+    std::size_t
+    size() const
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return size_;
+    }
+
+    /// Remove every file from the cache
+    void
+    clear()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        map_.clear();
+        lru_.clear();
+        size_ = 0;
+    }
+
+    /// Remove the file for a request target from the cache
+    void
+    erase(boost::beast::string_view target)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto const it = map_.find(normalize(target));
+        if(it == map_.end())
+            return;
+        size_ -= (*it->second)->cost();
+        lru_.erase(it->second);
+        map_.erase(it);
+    }
+
+    /** Return the cached file for a request target.
+
+        On a miss the file is loaded and inserted. The returned
+        pointer keeps the file data alive while a response which
+        refers to it is sent, even if it is evicted meanwhile.
+
+        @param target The request target, such as "/index.html".
+
+        @param ec Set to the error, if any occurred. Targets that
+        are not absolute or which contain ".." are rejected with
+        `boost::beast::errc::no_such_file_or_directory`.
+
+        @return The file, or null if it could not be opened or is
+        too large to cache.
+    */
+    std::shared_ptr<asset const>
+    get(boost::beast::string_view target,
+        boost::beast::error_code& ec)
+    {
+        ec.assign(0, ec.category());
+        if(target.empty() || target[0] != '/' ||
+            target.find("..") != boost::beast::string_view::npos)
+        {
+            ec = boost::beast::errc::make_error_code(
+                boost::beast::errc::no_such_file_or_directory);
+            return nullptr;
+        }
+        auto key = normalize(target);
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            auto const it = map_.find(key);
+            if(it != map_.end())
+            {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return *it->second;
+            }
+        }
+
+        // Load outside the lock; a concurrent miss on the
+        // same file does the work twice, but keeps one copy.
+        auto p = load(key, ec);
+        if(! p)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(m_);
+        auto const it = map_.find(key);
+        if(it != map_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return *it->second;
+        }
+        if(p->cost() > capacity_)
+            return p;
+        lru_.push_front(p);
+        map_.emplace(std::move(key), lru_.begin());
+        size_ += p->cost();
+        while(size_ > capacity_)
+        {
+            auto const& last = lru_.back();
+            size_ -= last->cost();
+            map_.erase(last->path());
+            lru_.pop_back();
+        }
+        return p;
+    }
+
+    /** Return the response to a GET or HEAD request for a file.
+
+        The gzip encoding is used when the request's Accept-Encoding
+        allows it and the file has a gzip variant. Each encoding has
+        its own entity tag, and a request whose If-None-Match matches
+        the tag of the selected encoding receives 304 Not Modified.
+        The body refers to the data in `a`, which must remain valid
+        until the response is sent.
+
+        @param keep_alive Whether the connection stays open after
+        the response, which by default follows the request.
+    */
+    template<class Body, class Fields>
+    static
+    response
+    make_response(
+        asset const& a,
+        boost::beast::http::request<Body, Fields> const& req,
+        bool keep_alive)
+    {
+        namespace http = boost::beast::http;
+        auto const& v =
+            a.has_gzip_ && accepts_gzip(req[http::field::accept_encoding]) ?
+                a.gzip_ : a.identity_;
+        response res{v.headers[
+            (req.version() >= 11 ? 2 : 0) + (keep_alive ? 1 : 0)]};
+        if(matches(req[http::field::if_none_match], v.etag))
+        {
+            res.header_.result(http::status::not_modified);
+            res.header_.content_length(boost::none);
+            return res;
+        }
+        if(req.method() != http::verb::head)
+            res.body_ = {v.data.data(), v.data.size()};
+        return res;
+    }
+
+    /// Return the response to a GET or HEAD request for a file.
+    template<class Body, class Fields>
+    static
+    response
+    make_response(
+        asset const& a,
+        boost::beast::http::request<Body, Fields> const& req)
+    {
+        return make_response(a, req, req.keep_alive());
+    }
+
+    /// Return a reasonable mime type based on the extension of a file.
+    static
+    boost::beast::string_view
+    mime_type(boost::beast::string_view path)
+    {
+        using boost::beast::iequals;
+        auto const ext = [&path]
+        {
+            auto const pos = path.rfind(".");
+            if(pos == boost::beast::string_view::npos)
+                return boost::beast::string_view{};
+            return path.substr(pos);
+        }();
+        if(iequals(ext, ".htm"))  return "text/html";
+        if(iequals(ext, ".html")) return "text/html";
+        if(iequals(ext, ".php"))  return "text/html";
+        if(iequals(ext, ".css"))  return "text/css";
+        if(iequals(ext, ".txt"))  return "text/plain";
+        if(iequals(ext, ".js"))   return "application/javascript";
+        if(iequals(ext, ".json")) return "application/json";
+        if(iequals(ext, ".xml"))  return "application/xml";
+        if(iequals(ext, ".swf"))  return "application/x-shockwave-flash";
+        if(iequals(ext, ".flv"))  return "video/x-flv";
+        if(iequals(ext, ".png"))  return "image/png";
+        if(iequals(ext, ".jpe"))  return "image/jpeg";
+        if(iequals(ext, ".jpeg")) return "image/jpeg";
+        if(iequals(ext, ".jpg"))  return "image/jpeg";
+        if(iequals(ext, ".gif"))  return "image/gif";
+        if(iequals(ext, ".bmp"))  return "image/bmp";
+        if(iequals(ext, ".ico"))  return "image/vnd.microsoft.icon";
+        if(iequals(ext, ".tiff")) return "image/tiff";
+        if(iequals(ext, ".tif"))  return "image/tiff";
+        if(iequals(ext, ".svg"))  return "image/svg+xml";
+        if(iequals(ext, ".svgz")) return "image/svg+xml";
+        return "application/text";
+    }
+
+private:
+    using list_type = std::list<std::shared_ptr<asset const>>;
+
+    static
+    std::string
+    normalize(boost::beast::string_view target)
+    {
+        // Drop the query, and map directories to their index
+        auto const pos = target.find('?');
+        if(pos != boost::beast::string_view::npos)
+            target = target.substr(0, pos);
+        std::string s = target.to_string();
+        if(s.empty() || s.back() == '/')
+            s.append("index.html");
+        return s;
+    }
+
+    static
+    bool
+    accepts_gzip(boost::beast::string_view s)
+    {
+        // A coding with a q-value of zero is not acceptable.
+        // An explicit gzip takes precedence over "*", which
+        // only applies to codings not otherwise listed.
+        bool gzip = false;
+        bool gzip_ok = false;
+        bool star_ok = false;
+        for(auto const& c : boost::beast::http::ext_list{s})
+        {
+            bool const is_gzip =
+                boost::beast::iequals(c.first, "gzip") ||
+                boost::beast::iequals(c.first, "x-gzip");
+            if(! is_gzip && c.first != "*")
+                continue;
+            bool ok = true;
+            for(auto const& p : c.second)
+                if(boost::beast::iequals(p.first, "q") &&
+                    p.second.find_first_not_of("0.") ==
+                        boost::beast::string_view::npos)
+                    ok = false;
+            if(is_gzip)
+            {
+                gzip = true;
+                gzip_ok = gzip_ok || ok;
+            }
+            else
+            {
+                star_ok = ok;
+            }
+        }
+        if(gzip)
+            return gzip_ok;
+        return star_ok;
+    }
+
+    static
+    bool
+    matches(boost::beast::string_view s, boost::beast::string_view etag)
+    {
+        if(s.empty())
+            return false;
+        if(s == "*")
+            return true;
+        for(;;)
+        {
+            auto const pos = s.find(',');
+            auto t = s.substr(0, pos);
+            while(! t.empty() && (t.front() == ' ' || t.front() == '\t'))
+                t.remove_prefix(1);
+            while(! t.empty() && (t.back() == ' ' || t.back() == '\t'))
+                t.remove_suffix(1);
+            if(t.starts_with("W/"))
+                t.remove_prefix(2);
+            if(t == etag)
+                return true;
+            if(pos == boost::beast::string_view::npos)
+                return false;
+            s.remove_prefix(pos + 1);
+        }
+    }
+
+    // Returns true if the content type is worth compressing
+    static
+    bool
+    compressible(boost::beast::string_view type)
+    {
+        return
+            type.starts_with("text/") ||
+            type == "application/javascript" ||
+            type == "application/json" ||
+            type == "application/xml" ||
+            type == "image/svg+xml";
+    }
+
+    static
+    std::string
+    gzip(std::string const& s)
+    {
+        namespace zlib = boost::beast::zlib;
+        zlib::deflate_stream ds;
+        ds.reset(9, 15, 8, zlib::Strategy::normal);
+        ds.format(zlib::Format::gzip);
+        std::string out;
+        out.resize(ds.upper_bound(s.size()));
+        zlib::z_params zs;
+        zs.next_in = s.data();
+        zs.avail_in = s.size();
+        zs.next_out = &out[0];
+        zs.avail_out = out.size();
+        boost::beast::error_code ec;
+        ds.write(zs, zlib::Flush::finish, ec);
+        if(ec != zlib::error::end_of_stream)
+            return {};
+        out.resize(zs.total_out);
+        return out;
+    }
+
+    std::shared_ptr<asset const>
+    load(std::string const& key, boost::beast::error_code& ec)
+    {
+        namespace http = boost::beast::http;
+        boost::beast::file f;
+        f.open((doc_root_ + key).c_str(),
+            boost::beast::file_mode::scan, ec);
+        if(ec)
+            return nullptr;
+        auto const n = f.size(ec);
+        if(ec)
+            return nullptr;
+        if(n > max_file_size_)
+            return nullptr;
+
+        auto p = std::make_shared<asset>();
+        p->path_ = key;
+        auto& s = p->identity_.data;
+        s.resize(static_cast<std::size_t>(n));
+        std::size_t used = 0;
+        while(used < s.size())
+        {
+            auto const bytes = f.read(&s[used], s.size() - used, ec);
+            if(ec)
+                return nullptr;
+            if(bytes == 0)
+            {
+                // the file was truncated while reading
+                s.resize(used);
+                break;
+            }
+            used += bytes;
+        }
+
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "\"%08lx-%lx\"",
+            static_cast<unsigned long>(
+                boost::beast::zlib::crc32(0, s.data(), s.size())),
+            static_cast<unsigned long>(s.size()));
+        p->identity_.etag = buf;
+
+        auto const type = mime_type(key);
+        if(compressible(type))
+        {
+            auto z = gzip(s);
+            if(! z.empty() && z.size() < s.size())
+            {
+                p->gzip_.data = std::move(z);
+
+                // A different representation needs a
+                // different strong validator.
+                p->gzip_.etag = p->identity_.etag;
+                p->gzip_.etag.insert(p->gzip_.etag.size() - 1, "-gz");
+                p->has_gzip_ = true;
+            }
+        }
+
+        auto const prepare =
+            [&](asset::variant& v, bool gzip)
+            {
+                for(unsigned version : {10, 11})
+                {
+                    for(bool keep_alive : {false, true})
+                    {
+                        http::response<http::empty_body> h;
+                        h.version(version);
+                        h.result(http::status::ok);
+                        h.keep_alive(keep_alive);
+                        h.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                        h.set(http::field::content_type, type);
+                        h.set(http::field::etag, v.etag);
+                        if(p->has_gzip_)
+                            h.set(http::field::vary, "Accept-Encoding");
+                        if(gzip)
+                            h.set(http::field::content_encoding, "gzip");
+                        h.set(http::field::content_length,
+                            std::to_string(v.data.size()));
+                        v.headers.emplace_back(h);
+                    }
+                }
+            };
+        prepare(p->identity_, false);
+        if(p->has_gzip_)
+            prepare(p->gzip_, true);
+        return p;
+    }
+
+    mutable std::mutex m_;
+    std::string doc_root_;
+    std::size_t capacity_;
+    std::size_t max_file_size_;
+    std::size_t size_ = 0;
+    list_type lru_;
+    std::unordered_map<std::string, list_type::iterator> map_;
+};
+
+#endif
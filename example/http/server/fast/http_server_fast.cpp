@@ -14,6 +14,7 @@
 //------------------------------------------------------------------------------
 
 #include "fields_alloc.hpp"
+#include "example/common/static_file_cache.hpp"
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
@@ -32,51 +33,18 @@ namespace ip = boost::asio::ip;         // from <boost/asio.hpp>
 using tcp = boost::asio::ip::tcp;       // from <boost/asio.hpp>
 namespace http = boost::beast::http;    // from <boost/beast/http.hpp>
 
-// Return a reasonable mime type based on the extension of a file.
-boost::beast::string_view
-mime_type(boost::beast::string_view path)
-{
-    using boost::beast::iequals;
-    auto const ext = [&path]
-    {
-        auto const pos = path.rfind(".");
-        if(pos == boost::beast::string_view::npos)
-            return boost::beast::string_view{};
-        return path.substr(pos);
-    }();
-    if(iequals(ext, ".htm"))  return "text/html";
-    if(iequals(ext, ".html")) return "text/html";
-    if(iequals(ext, ".php"))  return "text/html";
-    if(iequals(ext, ".css"))  return "text/css";
-    if(iequals(ext, ".txt"))  return "text/plain";
-    if(iequals(ext, ".js"))   return "application/javascript";
-    if(iequals(ext, ".json")) return "application/json";
-    if(iequals(ext, ".xml"))  return "application/xml";
-    if(iequals(ext, ".swf"))  return "application/x-shockwave-flash";
-    if(iequals(ext, ".flv"))  return "video/x-flv";
-    if(iequals(ext, ".png"))  return "image/png";
-    if(iequals(ext, ".jpe"))  return "image/jpeg";
-    if(iequals(ext, ".jpeg")) return "image/jpeg";
-    if(iequals(ext, ".jpg"))  return "image/jpeg";
-    if(iequals(ext, ".gif"))  return "image/gif";
-    if(iequals(ext, ".bmp"))  return "image/bmp";
-    if(iequals(ext, ".ico"))  return "image/vnd.microsoft.icon";
-    if(iequals(ext, ".tiff")) return "image/tiff";
-    if(iequals(ext, ".tif"))  return "image/tiff";
-    if(iequals(ext, ".svg"))  return "image/svg+xml";
-    if(iequals(ext, ".svgz")) return "image/svg+xml";
-    return "application/text";
-}
-
 class http_worker
 {
 public:
     http_worker(http_worker const&) = delete;
     http_worker& operator=(http_worker const&) = delete;
 
-    http_worker(tcp::acceptor& acceptor, const std::string& doc_root) :
+    http_worker(tcp::acceptor& acceptor, const std::string& doc_root,
+            static_file_cache& cache, http::date_cache& dates) :
         acceptor_(acceptor),
-        doc_root_(doc_root)
+        doc_root_(doc_root),
+        cache_(cache),
+        dates_(dates)
     {
     }
 
@@ -97,6 +65,12 @@ private:
     // The path to the root of the document directory.
     std::string doc_root_;
 
+    // The cache of small files, shared by all workers.
+    static_file_cache& cache_;
+
+    // The source of the Date field, shared by all workers.
+    http::date_cache& dates_;
+
     // The socket for the currently connected client.
     tcp::socket socket_{acceptor_.get_executor().context()};
 
@@ -119,6 +93,12 @@ private:
     // The string-based response serializer.
     boost::optional<http::response_serializer<http::string_body, http::basic_fields<alloc_t>>> string_serializer_;
 
+    // The cached file being sent, kept alive until the write completes.
+    std::shared_ptr<static_file_cache::asset const> asset_;
+
+    // The serialized response for a cached file.
+    boost::optional<static_file_cache::response> cached_response_;
+
     // The file-based response message.
     boost::optional<http::response<http::file_body, http::basic_fields<alloc_t>>> file_response_;
 
@@ -187,7 +167,7 @@ private:
         switch (req.method())
         {
         case http::verb::get:
-            send_file(req.target());
+            send_file(req);
             break;
 
         default:
@@ -212,6 +192,7 @@ private:
         string_response_->result(status);
         string_response_->keep_alive(false);
         string_response_->set(http::field::server, "Beast");
+        string_response_->set(http::field::date, dates_.get());
         string_response_->set(http::field::content_type, "text/plain");
         string_response_->body() = error;
         string_response_->prepare_payload();
@@ -230,16 +211,26 @@ private:
             });
     }
 
-    void send_file(boost::beast::string_view target)
+    void send_file(http::request<request_body_t, http::basic_fields<alloc_t>> const& req)
     {
-        // Request path must be absolute and not contain "..".
-        if (target.empty() || target[0] != '/' || target.find("..") != std::string::npos)
+        auto const target = req.target();
+
+        // Small files are served from memory. The cache rejects
+        // request paths which are not absolute or contain "..".
+        boost::beast::error_code ec;
+        asset_ = cache_.get(target, ec);
+        if(ec)
         {
             send_bad_response(
                 http::status::not_found,
                 "File not found\r\n");
             return;
         }
+        if(asset_)
+        {
+            send_cached(req);
+            return;
+        }
 
         std::string full_path = doc_root_;
         full_path.append(
@@ -247,7 +238,6 @@ private:
             target.size());
 
         http::file_body::value_type file;
-        boost::beast::error_code ec;
         file.open(
             full_path.c_str(),
             boost::beast::file_mode::read,
@@ -268,7 +258,9 @@ private:
         file_response_->result(http::status::ok);
         file_response_->keep_alive(false);
         file_response_->set(http::field::server, "Beast");
-        file_response_->set(http::field::content_type, mime_type(target.to_string()));
+        file_response_->set(http::field::date, dates_.get());
+        file_response_->set(http::field::content_type,
+            static_file_cache::mime_type(target.to_string()));
         file_response_->body() = std::move(file);
         file_response_->prepare_payload();
 
@@ -286,6 +278,24 @@ private:
             });
     }
 
+    void send_cached(http::request<request_body_t, http::basic_fields<alloc_t>> const& req)
+    {
+        cached_response_.emplace(
+            static_file_cache::make_response(*asset_, req, false));
+        cached_response_->header().date(dates_.get());
+
+        boost::asio::async_write(
+            socket_,
+            cached_response_->buffers(),
+            [this](boost::beast::error_code ec, std::size_t)
+            {
+                socket_.shutdown(tcp::socket::shutdown_send, ec);
+                cached_response_.reset();
+                asset_.reset();
+                accept();
+            });
+    }
+
     void check_deadline()
     {
         // The deadline may have moved, so check it has really passed.
@@ -332,10 +342,13 @@ int main(int argc, char* argv[])
         boost::asio::io_context ioc{1};
         tcp::acceptor acceptor{ioc, {address, port}};
 
+        static_file_cache cache{doc_root};
+        http::date_cache dates;
+
         std::list<http_worker> workers;
         for (int i = 0; i < num_workers; ++i)
         {
-            workers.emplace_back(acceptor, doc_root);
+            workers.emplace_back(acceptor, doc_root, cache, dates);
             workers.back().start();
         }
 
@@ -22,6 +22,7 @@
 #include <boost/beast/core/error.hpp>
 #include <boost/beast/core/file.hpp>
 #include <boost/beast/core/file_base.hpp>
+#include <boost/beast/core/file_mmap.hpp>
 #include <boost/beast/core/file_posix.hpp>
 #include <boost/beast/core/file_stdio.hpp>
 #include <boost/beast/core/file_win32.hpp>
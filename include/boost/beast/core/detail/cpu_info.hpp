@@ -11,6 +11,7 @@
 #define BOOST_BEAST_DETAIL_CPU_INFO_HPP
 
 #include <boost/config.hpp>
+#include <cstdint>
 
 #ifndef BOOST_BEAST_NO_INTRINSICS
 # if defined(BOOST_MSVC) || ((defined(BOOST_GCC) || defined(BOOST_CLANG)) && defined(__SSE4_2__))
@@ -59,6 +60,7 @@ cpuid(
 struct cpu_info
 {
     bool sse42 = false;
+    bool pclmul = false;
 
     cpu_info();
 };
@@ -68,6 +70,7 @@ cpu_info::
 cpu_info()
 {
     constexpr std::uint32_t SSE42 = 1 << 20;
+    constexpr std::uint32_t PCLMUL = 1 << 1;
 
     std::uint32_t eax = 0;
     std::uint32_t ebx = 0;
@@ -79,6 +82,7 @@ cpu_info()
     {
         cpuid(1, eax, ebx, ecx, edx);
         sse42 = (ecx & SSE42) != 0;
+        pclmul = (ecx & PCLMUL) != 0;
     }
 }
 
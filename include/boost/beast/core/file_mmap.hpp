@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2015-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_FILE_MMAP_HPP
+#define BOOST_BEAST_CORE_FILE_MMAP_HPP
+
+#include <boost/beast/core/file_posix.hpp>
+
+#if ! defined(BOOST_BEAST_USE_MMAP_FILE)
+# if BOOST_BEAST_USE_POSIX_FILE
+#  define BOOST_BEAST_USE_MMAP_FILE 1
+# else
+#  define BOOST_BEAST_USE_MMAP_FILE 0
+# endif
+#endif
+
+#if BOOST_BEAST_USE_MMAP_FILE
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file_base.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+
+/** An implementation of File which maps the file into memory.
+
+    This class implements a @b File using POSIX interfaces. A file
+    opened for reading is mapped in its entirety, and @ref data
+    returns a pointer to its contents. Reads copy from the mapping
+    instead of calling into the operating system.
+
+    A file opened for writing is not mapped until @ref reserve is
+    called with its final size. Writes within the reserved size
+    copy into the mapping, while other writes and reads use
+    positional system calls.
+
+    The position in the file is maintained by this object, and
+    is independent of the position of the native handle.
+
+    @note The file must not be truncated by another process while
+    it is mapped. Accessing the part of a mapping which no longer
+    has a file behind it raises `SIGBUS`.
+*/
+class file_mmap
+{
+    file_posix file_;
+    char* data_ = nullptr;      // the mapping, if any
+    std::size_t size_ = 0;      // size of the mapping
+    std::uint64_t pos_ = 0;     // current position
+    std::uint64_t end_ = 0;     // end of the data written
+    bool writable_ = false;     // opened for writing
+    bool reserved_ = false;     // sized by reserve
+
+    void
+    unmap();
+
+    void
+    map(std::uint64_t size, error_code& ec);
+
+public:
+    /** The type of the underlying file handle.
+
+        This is platform-specific.
+    */
+    using native_handle_type = int;
+
+    /** Destructor
+
+        If the file is open it is first closed.
+    */
+    ~file_mmap();
+
+    /** Constructor
+
+        There is no open file initially.
+    */
+    file_mmap() = default;
+
+    /** Constructor
+
+        The moved-from object behaves as if default constructed.
+    */
+    file_mmap(file_mmap&& other);
+
+    /** Assignment
+
+        The moved-from object behaves as if default constructed.
+    */
+    file_mmap& operator=(file_mmap&& other);
+
+    /// Returns the native handle associated with the file.
+    native_handle_type
+    native_handle() const
+    {
+        return file_.native_handle();
+    }
+
+    /** Set the native handle associated with the file.
+
+        If the file is open it is first closed. The new file
+        is not mapped.
+
+        @param fd The native file handle to assign.
+    */
+    void
+    native_handle(native_handle_type fd);
+
+    /// Returns `true` if the file is open
+    bool
+    is_open() const
+    {
+        return file_.is_open();
+    }
+
+    /** Returns a pointer to the mapped contents of the file.
+
+        @return The mapping, or `nullptr` if the file is not mapped.
+    */
+    char const*
+    data() const
+    {
+        return data_;
+    }
+
+    /// Returns the number of bytes mapped
+    std::size_t
+    mapped_size() const
+    {
+        return size_;
+    }
+
+    /** Close the file if open
+
+        A reserved file is first truncated as if by @ref trim.
+
+        @param ec Set to the error, if any occurred.
+    */
+    void
+    close(error_code& ec);
+
+    /** Open a file at the given path with the specified mode
+
+        Files opened with @ref file_mode::read or @ref file_mode::scan
+        are mapped. The kernel is advised of sequential access for
+        @ref file_mode::scan.
+
+        @param path The utf-8 encoded path to the file
+
+        @param mode The file mode to use
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    open(char const* path, file_mode mode, error_code& ec);
+
+    /** Set the size of a file opened for writing, and map it.
+
+        The file is extended to at least `size` bytes and mapped
+        for writing, so that subsequent writes within the mapping
+        are copied directly into the page cache. Disk space for
+        the whole size is allocated first, and an error is reported
+        here if it is not available, rather than raising `SIGBUS`
+        when the mapping is written. A file which is already longer
+        is not truncated, and is mapped in its entirety.
+
+        If less than the reserved size is written, the file is
+        truncated to the end of the data written when @ref trim
+        or @ref close is called, or the object is destroyed.
+        Data which was in the file before the call is kept.
+
+        @param size The new size of the file in bytes
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    reserve(std::uint64_t size, error_code& ec);
+
+    /** Truncate a reserved file to the end of the data written.
+
+        If @ref reserve was called, the file is truncated to the
+        largest offset written since then, or to its size before
+        the call if that is larger. Otherwise this does nothing.
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    trim(error_code& ec);
+
+    /** Return the size of the open file
+
+        @param ec Set to the error, if any occurred
+
+        @return The size in bytes
+    */
+    std::uint64_t
+    size(error_code& ec) const;
+
+    /** Return the current position in the open file
+
+        @param ec Set to the error, if any occurred
+
+        @return The offset in bytes from the beginning of the file
+    */
+    std::uint64_t
+    pos(error_code& ec) const;
+
+    /** Adjust the current position in the open file
+
+        @param offset The offset in bytes from the beginning of the file
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    seek(std::uint64_t offset, error_code& ec);
+
+    /** Read from the open file
+
+        @param buffer The buffer for storing the result of the read
+
+        @param n The number of bytes to read
+
+        @param ec Set to the error, if any occurred
+    */
+    std::size_t
+    read(void* buffer, std::size_t n, error_code& ec);
+
+    /** Write to the open file
+
+        @param buffer The buffer holding the data to write
+
+        @param n The number of bytes to write
+
+        @param ec Set to the error, if any occurred
+    */
+    std::size_t
+    write(void const* buffer, std::size_t n, error_code& ec);
+};
+
+} // beast
+} // boost
+
+#include <boost/beast/core/impl/file_mmap.ipp>
+
+#endif
+
+#endif
@@ -163,6 +163,42 @@ public:
     */
     std::size_t
     write(void const* buffer, std::size_t n, error_code& ec);
+
+    /** Read from the open file at the given offset
+
+        The current position in the file is not used or changed,
+        so reads at different offsets may be performed concurrently.
+
+        @param offset The offset in bytes from the beginning of the file
+
+        @param buffer The buffer for storing the result of the read
+
+        @param n The number of bytes to read
+
+        @param ec Set to the error, if any occurred
+
+        @return The number of bytes read, which is less than `n`
+        only if the end of the file was reached or an error occurred.
+    */
+    std::size_t
+    read_at(std::uint64_t offset,
+        void* buffer, std::size_t n, error_code& ec) const;
+
+    /** Write to the open file at the given offset
+
+        The current position in the file is not used or changed.
+
+        @param offset The offset in bytes from the beginning of the file
+
+        @param buffer The buffer holding the data to write
+
+        @param n The number of bytes to write
+
+        @param ec Set to the error, if any occurred
+    */
+    std::size_t
+    write_at(std::uint64_t offset,
+        void const* buffer, std::size_t n, error_code& ec);
 };
 
 } // beast
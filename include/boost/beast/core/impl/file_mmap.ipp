@@ -0,0 +1,404 @@
+//
+// Copyright (c) 2015-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_FILE_MMAP_IPP
+#define BOOST_BEAST_CORE_IMPL_FILE_MMAP_IPP
+
+#if ! defined(BOOST_BEAST_NO_POSIX_FALLOCATE)
+# if defined(__APPLE__) || (defined(ANDROID) && (__ANDROID_API__ < 21))
+#  define BOOST_BEAST_NO_POSIX_FALLOCATE
+# endif
+#endif
+
+#if ! defined(BOOST_BEAST_USE_POSIX_FALLOCATE)
+# if ! defined(BOOST_BEAST_NO_POSIX_FALLOCATE)
+#  define BOOST_BEAST_USE_POSIX_FALLOCATE 1
+# else
+#  define BOOST_BEAST_USE_POSIX_FALLOCATE 0
+# endif
+#endif
+
+#include <boost/core/exchange.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace boost {
+namespace beast {
+
+namespace detail {
+
+// Allocate disk blocks for the first `to` bytes of the file,
+// where the data past `from` may be overwritten. Storing into a
+// hole in a shared mapping raises SIGBUS when the disk is full.
+inline
+int
+file_mmap_allocate(int fd, std::uint64_t from, std::uint64_t to)
+{
+#if BOOST_BEAST_USE_POSIX_FALLOCATE
+    for(;;)
+    {
+        int const ev = ::posix_fallocate(fd, 0, static_cast<off_t>(to));
+        if(ev == 0)
+            return 0;
+        if(ev == EINTR)
+            continue;
+        if(ev != EINVAL && ev != EOPNOTSUPP && ev != ENOSYS)
+            return ev;
+        // not supported by the file system
+        break;
+    }
+#endif
+    char const zeroes[4096] = {};
+    while(from < to)
+    {
+        auto const n = static_cast<std::size_t>((std::min<std::uint64_t>)(
+            to - from, sizeof(zeroes)));
+        auto const result = ::pwrite(fd, zeroes, n,
+            static_cast<off_t>(from));
+        if(result == -1)
+        {
+            int const ev = errno;
+            if(ev == EINTR)
+                continue;
+            return ev;
+        }
+        from += static_cast<std::size_t>(result);
+    }
+    return 0;
+}
+
+} // detail
+
+inline
+void
+file_mmap::
+unmap()
+{
+    if(data_)
+        ::munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+inline
+void
+file_mmap::
+map(std::uint64_t size, error_code& ec)
+{
+    unmap();
+    if(size == 0)
+    {
+        // Empty files cannot be mapped
+        ec.assign(0, ec.category());
+        return;
+    }
+    if(size > (std::numeric_limits<std::size_t>::max)())
+    {
+        ec = make_error_code(errc::file_too_large);
+        return;
+    }
+    auto const p = ::mmap(nullptr, static_cast<std::size_t>(size),
+        writable_ ? (PROT_READ | PROT_WRITE) : PROT_READ,
+        MAP_SHARED, file_.native_handle(), 0);
+    if(p == MAP_FAILED)
+    {
+        ec.assign(errno, generic_category());
+        return;
+    }
+    data_ = static_cast<char*>(p);
+    size_ = static_cast<std::size_t>(size);
+    ec.assign(0, ec.category());
+}
+
+inline
+file_mmap::
+~file_mmap()
+{
+    error_code ignored;
+    trim(ignored);
+    unmap();
+}
+
+inline
+file_mmap::
+file_mmap(file_mmap&& other)
+    : file_(std::move(other.file_))
+    , data_(boost::exchange(other.data_, nullptr))
+    , size_(boost::exchange(other.size_, 0))
+    , pos_(boost::exchange(other.pos_, 0))
+    , end_(boost::exchange(other.end_, 0))
+    , writable_(boost::exchange(other.writable_, false))
+    , reserved_(boost::exchange(other.reserved_, false))
+{
+}
+
+inline
+file_mmap&
+file_mmap::
+operator=(file_mmap&& other)
+{
+    if(&other == this)
+        return *this;
+    error_code ignored;
+    trim(ignored);
+    unmap();
+    file_ = std::move(other.file_);
+    data_ = boost::exchange(other.data_, nullptr);
+    size_ = boost::exchange(other.size_, 0);
+    pos_ = boost::exchange(other.pos_, 0);
+    end_ = boost::exchange(other.end_, 0);
+    writable_ = boost::exchange(other.writable_, false);
+    reserved_ = boost::exchange(other.reserved_, false);
+    return *this;
+}
+
+inline
+void
+file_mmap::
+native_handle(native_handle_type fd)
+{
+    error_code ignored;
+    trim(ignored);
+    unmap();
+    file_.native_handle(fd);
+    pos_ = 0;
+    writable_ = false;
+}
+
+inline
+void
+file_mmap::
+close(error_code& ec)
+{
+    error_code ev;
+    trim(ev);
+    unmap();
+    pos_ = 0;
+    writable_ = false;
+    file_.close(ec);
+    if(ev && ! ec)
+        ec = ev;
+}
+
+inline
+void
+file_mmap::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    error_code ignored;
+    trim(ignored);
+    unmap();
+    pos_ = 0;
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    writable_ =
+        mode != file_mode::read &&
+        mode != file_mode::scan;
+    if(writable_)
+        return;
+    auto const n = file_.size(ec);
+    if(ec)
+        return;
+    map(n, ec);
+    if(ec)
+        return;
+    if(data_)
+        ::madvise(data_, size_, mode == file_mode::scan ?
+            MADV_SEQUENTIAL : MADV_RANDOM);
+}
+
+inline
+void
+file_mmap::
+reserve(std::uint64_t size, error_code& ec)
+{
+    if(! file_.is_open() || ! writable_)
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return;
+    }
+    unmap();
+    if(size > static_cast<std::uint64_t>(
+        (std::numeric_limits<off_t>::max)()))
+    {
+        ec = make_error_code(errc::file_too_large);
+        return;
+    }
+    auto const n = file_.size(ec);
+    if(ec)
+        return;
+    if(! reserved_)
+    {
+        // Data already in the file is kept by trim
+        end_ = n;
+        reserved_ = true;
+    }
+    // The file is never shortened, as with file_mode::write_existing
+    auto const to = (std::max)(n, size);
+    if(to > 0)
+    {
+        // On failure trim restores the size
+        auto const ev = detail::file_mmap_allocate(
+            file_.native_handle(), n, to);
+        if(ev)
+        {
+            ec.assign(ev, generic_category());
+            return;
+        }
+    }
+    map(to, ec);
+    if(ec)
+        return;
+    if(data_)
+        ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+inline
+void
+file_mmap::
+trim(error_code& ec)
+{
+    if(! reserved_)
+    {
+        ec.assign(0, ec.category());
+        return;
+    }
+    reserved_ = false;
+
+    // The mapping may not extend past the end of the file
+    if(end_ < size_)
+        unmap();
+    for(;;)
+    {
+        if(::ftruncate(file_.native_handle(),
+                static_cast<off_t>(end_)) == 0)
+            break;
+        auto const ev = errno;
+        if(ev != EINTR)
+        {
+            ec.assign(ev, generic_category());
+            return;
+        }
+    }
+    ec.assign(0, ec.category());
+}
+
+inline
+std::uint64_t
+file_mmap::
+size(error_code& ec) const
+{
+    return file_.size(ec);
+}
+
+inline
+std::uint64_t
+file_mmap::
+pos(error_code& ec) const
+{
+    if(! file_.is_open())
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return 0;
+    }
+    ec.assign(0, ec.category());
+    return pos_;
+}
+
+inline
+void
+file_mmap::
+seek(std::uint64_t offset, error_code& ec)
+{
+    if(! file_.is_open())
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return;
+    }
+    pos_ = offset;
+    ec.assign(0, ec.category());
+}
+
+inline
+std::size_t
+file_mmap::
+read(void* buffer, std::size_t n, error_code& ec)
+{
+    if(! file_.is_open())
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return 0;
+    }
+    std::size_t nread = 0;
+    if(pos_ < size_)
+    {
+        auto const amount = (std::min)(n,
+            size_ - static_cast<std::size_t>(pos_));
+        std::memcpy(buffer, data_ + pos_, amount);
+        pos_ += amount;
+        n -= amount;
+        nread += amount;
+        buffer = static_cast<char*>(buffer) + amount;
+    }
+    if(n > 0)
+    {
+        auto const result = file_.read_at(pos_, buffer, n, ec);
+        pos_ += result;
+        nread += result;
+        return nread;
+    }
+    ec.assign(0, ec.category());
+    return nread;
+}
+
+inline
+std::size_t
+file_mmap::
+write(void const* buffer, std::size_t n, error_code& ec)
+{
+    if(! file_.is_open())
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return 0;
+    }
+    std::size_t nwritten = 0;
+    if(writable_ && pos_ < size_)
+    {
+        auto const amount = (std::min)(n,
+            size_ - static_cast<std::size_t>(pos_));
+        std::memcpy(data_ + pos_, buffer, amount);
+        pos_ += amount;
+        n -= amount;
+        nwritten += amount;
+        buffer = static_cast<char const*>(buffer) + amount;
+    }
+    if(n > 0)
+    {
+        auto const result = file_.write_at(pos_, buffer, n, ec);
+        pos_ += result;
+        nwritten += result;
+        end_ = (std::max)(end_, pos_);
+        return nwritten;
+    }
+    end_ = (std::max)(end_, pos_);
+    ec.assign(0, ec.category());
+    return nwritten;
+}
+
+} // beast
+} // boost
+
+#endif
@@ -343,6 +343,79 @@ write(void const* buffer, std::size_t n, error_code& ec)
     return nwritten;
 }
 
+inline
+std::size_t
+file_posix::
+read_at(std::uint64_t offset,
+    void* buffer, std::size_t n, error_code& ec) const
+{
+    if(fd_ == -1)
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return 0;
+    }
+    std::size_t nread = 0;
+    while(n > 0)
+    {
+        auto const amount = static_cast<ssize_t>((std::min)(
+            n, static_cast<std::size_t>(SSIZE_MAX)));
+        auto const result = ::pread(fd_, buffer, amount,
+            static_cast<off_t>(offset + nread));
+        if(result == -1)
+        {
+            auto const ev = errno;
+            if(ev == EINTR)
+                continue;
+            ec.assign(ev, generic_category());
+            return nread;
+        }
+        if(result == 0)
+        {
+            // short read
+            break;
+        }
+        n -= result;
+        nread += result;
+        buffer = static_cast<char*>(buffer) + result;
+    }
+    ec.assign(0, ec.category());
+    return nread;
+}
+
+inline
+std::size_t
+file_posix::
+write_at(std::uint64_t offset,
+    void const* buffer, std::size_t n, error_code& ec)
+{
+    if(fd_ == -1)
+    {
+        ec = make_error_code(errc::invalid_argument);
+        return 0;
+    }
+    std::size_t nwritten = 0;
+    while(n > 0)
+    {
+        auto const amount = static_cast<ssize_t>((std::min)(
+            n, static_cast<std::size_t>(SSIZE_MAX)));
+        auto const result = ::pwrite(fd_, buffer, amount,
+            static_cast<off_t>(offset + nwritten));
+        if(result == -1)
+        {
+            auto const ev = errno;
+            if(ev == EINTR)
+                continue;
+            ec.assign(ev, generic_category());
+            return nwritten;
+        }
+        n -= result;
+        nwritten += result;
+        buffer = static_cast<char const*>(buffer) + result;
+    }
+    ec.assign(0, ec.category());
+    return nwritten;
+}
+
 } // beast
 } // boost
 
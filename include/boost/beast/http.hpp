@@ -16,15 +16,22 @@
 #include <boost/beast/http/basic_parser.hpp>
 #include <boost/beast/http/buffer_body.hpp>
 #include <boost/beast/http/chunk_encode.hpp>
+#include <boost/beast/http/date_cache.hpp>
+#include <boost/beast/http/compressed_body.hpp>
 #include <boost/beast/http/dynamic_body.hpp>
 #include <boost/beast/http/empty_body.hpp>
 #include <boost/beast/http/error.hpp>
 #include <boost/beast/http/field.hpp>
 #include <boost/beast/http/fields.hpp>
 #include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/file_range_body.hpp>
+#include <boost/beast/http/flat_fields.hpp>
+#include <boost/beast/http/header_view_parser.hpp>
+#include <boost/beast/http/mmap_file_body.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/parser.hpp>
 #include <boost/beast/http/read.hpp>
+#include <boost/beast/http/response_template.hpp>
 #include <boost/beast/http/rfc7230.hpp>
 #include <boost/beast/http/serializer.hpp>
 #include <boost/beast/http/span_body.hpp>
@@ -15,6 +15,7 @@
 #include <boost/beast/core/file_base.hpp>
 #include <boost/beast/core/type_traits.hpp>
 #include <boost/beast/http/message.hpp>
+#include <boost/beast/http/detail/file_body_buffer.hpp>
 #include <boost/assert.hpp>
 #include <boost/optional.hpp>
 #include <algorithm>
@@ -96,6 +97,9 @@ class basic_file_body<File>::value_type
     // The cached file size
     std::uint64_t file_size_ = 0;
 
+    // How the writer sizes its reads
+    detail::file_body_buffer_size buffer_size_;
+
 public:
     /** Destructor.
 
@@ -126,6 +130,33 @@ public:
         return file_size_;
     }
 
+    /// Returns the largest number of bytes read from the file at once
+    std::size_t
+    buffer_size() const
+    {
+        return buffer_size_.size;
+    }
+
+    /** Set the size of the buffer used to read the file when serializing
+
+        By default the buffer starts out small and doubles after
+        each read which fills it, up to `size`. Short files are
+        sent without allocating, while long files are read with
+        few system calls.
+
+        @param size The largest number of bytes to read at once.
+        The default is 65536.
+
+        @param adaptive If `false`, every read uses a buffer of
+        `size` bytes.
+    */
+    void
+    buffer_size(std::size_t size, bool adaptive = true)
+    {
+        buffer_size_.size = size;
+        buffer_size_.adaptive = adaptive;
+    }
+
     /// Close the file if open
     void
     close();
@@ -229,7 +260,7 @@ class basic_file_body<File>::writer
 {
     value_type& body_;      // The body we are reading from
     std::uint64_t remain_;  // The number of unread bytes
-    char buf_[4096];        // Small buffer for reading
+    detail::file_body_buffer buf_;  // Buffer for reading
 
 public:
     // The type of buffer sequence returned by `get`.
@@ -305,6 +336,9 @@ writer(header<isRequest, Fields>& h, value_type& b)
 
     // Get the size of the file
     remain_ = body_.file_size_;
+
+    // Size the buffer as the body asks
+    buf_.reset(body_.buffer_size_);
 }
 
 // Initializer
@@ -334,10 +368,10 @@ writer::
 get(error_code& ec) ->
     boost::optional<std::pair<const_buffers_type, bool>>
 {
-    // Calculate the smaller of our buffer size,
+    // Get storage for the smaller of our buffer size,
     // or the amount of unread data in the file.
-    auto const amount =  remain_ > sizeof(buf_) ?
-        sizeof(buf_) : static_cast<std::size_t>(remain_);
+    auto const b = buf_.prepare(remain_);
+    auto const amount = b.size();
 
     // Handle the case where the file is zero length
     if(amount == 0)
@@ -354,7 +388,7 @@ get(error_code& ec) ->
     }
 
     // Now read the next buffer
-    auto const nread = body_.file_.read(buf_, amount, ec);
+    auto const nread = body_.file_.read(b.data(), amount, ec);
     if(ec)
         return boost::none;
 
@@ -362,8 +396,10 @@ get(error_code& ec) ->
     BOOST_ASSERT(nread != 0);
     BOOST_ASSERT(nread <= remain_);
 
-    // Update the amount remaining based on what we got
+    // Update the amount remaining based on what we got,
+    // and let the buffer grow if we filled it.
     remain_ -= nread;
+    buf_.commit(nread);
 
     // Return the buffer to the caller.
     //
@@ -375,8 +411,8 @@ get(error_code& ec) ->
     //
     ec.assign(0, ec.category());
     return {{
-        const_buffers_type{buf_, nread},    // buffer to return.
-        remain_ > 0                         // `true` if there are more buffers.
+        const_buffers_type{b.data(), nread},    // buffer to return.
+        remain_ > 0                             // `true` if there are more buffers.
         }};
 }
 
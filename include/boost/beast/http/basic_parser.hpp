@@ -203,6 +203,12 @@ class basic_parser
     static unsigned constexpr flagUpgrade               = 1<< 12;
     static unsigned constexpr flagFinalChunk            = 1<< 13;
 
+    // Wait for the complete header before parsing it
+    static unsigned constexpr flagWholeHeader           = 1<< 14;
+
+    // The input being parsed is a temporary copy
+    static unsigned constexpr flagInputCopied           = 1<< 15;
+
     static constexpr
     std::uint64_t
     default_body_limit(std::true_type)
@@ -250,6 +256,44 @@ protected:
     template<class OtherDerived>
     basic_parser(basic_parser<isRequest, OtherDerived>&&);
 
+    /** Set the whole header parse option.
+
+        Normally the parser delivers the start line and fields as
+        soon as each one is available, and consumes them even if the
+        rest of the header has not arrived yet. When this option is
+        set, no header callbacks are invoked until the entire header
+        is present in the input, so every string passed to them
+        refers to the same buffer.
+
+        @param v `true` to set the whole header option or `false`
+        to disable it.
+
+        @note This function must called before any bytes are processed.
+    */
+    void
+    whole_header(bool v)
+    {
+        BOOST_ASSERT(! got_some());
+        if(v)
+            f_ |= flagWholeHeader;
+        else
+            f_ &= ~flagWholeHeader;
+    }
+
+    /** Returns `true` if the input being parsed is a temporary copy.
+
+        When a buffer sequence with more than one element is passed
+        to @ref put, the parser flattens it into storage which is only
+        valid until @ref put returns. This function may be called
+        from a callback to learn whether the strings it received
+        will outlive the call to @ref put.
+    */
+    bool
+    input_copied() const
+    {
+        return (f_ & flagInputCopied) != 0;
+    }
+
 public:
     /// `true` if this parser parses requests, `false` for responses.
     using is_request =
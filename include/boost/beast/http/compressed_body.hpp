@@ -0,0 +1,523 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_COMPRESSED_BODY_HPP
+#define BOOST_BEAST_HTTP_COMPRESSED_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/type_traits.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A @b Body which applies the Content-Encoding of the message.
+
+    This body adapts another body type, compressing the payload
+    as it is serialized and decompressing it as it is parsed.
+    The container is the same as the adapted body's, and always
+    holds the payload without the content-coding applied.
+
+    The coding is chosen from the Content-Encoding field of the
+    message header when the message is serialized or parsed:
+
+    @li `gzip` or `x-gzip` uses the gzip format
+
+    @li `deflate` uses the zlib format, as specified for HTTP
+
+    Any other value, including a missing field or a list of
+    several codings, passes the payload through unchanged.
+
+    Data moves through a fixed size buffer, one piece at a
+    time, so memory use does not depend on the size of the
+    payload. The compressed size is not known in advance, so
+    this body has no `size` function and @ref message::prepare_payload
+    selects the chunked Transfer-Encoding.
+
+    When the adapted writer indicates that it has no data
+    available yet by returning @ref error::need_buffer (for
+    example, @ref buffer_body), the compressed data produced so
+    far is flushed before the error is returned, so the peer
+    can decode everything sent up to that point.
+
+    When parsing, the body limit of the parser applies to the
+    compressed octets received. A small compressed payload can
+    expand to a very large one, so the reader fails with
+    @ref error::body_limit once more than `Limit` octets have
+    been decompressed. Data following the end of the compressed
+    stream fails with `zlib::error::stream_error`.
+
+    @tparam Body The body type to adapt. It must meet the
+    requirements of @b Body.
+
+    @tparam Limit The largest number of octets the reader will
+    decompress. The default is 8MB.
+*/
+template<class Body,
+    std::uint64_t Limit = 8 * 1024 * 1024>
+struct compressed_body
+{
+    /** The type of container used for the body
+
+        This determines the type of @ref message::body
+        when this body type is used with a message container.
+    */
+    using value_type = typename Body::value_type;
+
+    /** The algorithm for parsing the body
+
+        Meets the requirements of @b BodyReader.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using reader = implementation_defined;
+#else
+    class reader;
+#endif
+
+    /** The algorithm for serializing the body
+
+        Meets the requirements of @b BodyWriter.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = implementation_defined;
+#else
+    class writer;
+#endif
+
+private:
+    using coding_fn =
+        boost::optional<zlib::Format>(*)(void const*);
+
+    // Returns the format for the message's content-coding,
+    // or boost::none if the payload is passed through.
+    //
+    // The parser constructs its reader before the header is
+    // received, so the field is examined in `init`, through
+    // a pointer to the header saved by the constructor.
+    template<bool isRequest, class Fields>
+    static
+    boost::optional<zlib::Format>
+    coding(void const* p)
+    {
+        auto const& h = *static_cast<
+            header<isRequest, Fields> const*>(p);
+        auto const s = h[field::content_encoding];
+        if(iequals(s, "gzip") || iequals(s, "x-gzip"))
+            return zlib::Format::gzip;
+        if(iequals(s, "deflate"))
+            return zlib::Format::zlib;
+        return boost::none;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+#if ! BOOST_BEAST_DOXYGEN
+
+template<class Body, std::uint64_t Limit>
+class compressed_body<Body, Limit>::writer
+{
+    using inner_buffers_type =
+        typename Body::writer::const_buffers_type;
+
+    using iterator = typename beast::detail::
+        buffer_sequence_iterator<inner_buffers_type>::type;
+
+    static bool constexpr is_mutable =
+        is_mutable_body_writer<Body>::value;
+
+    typename Body::writer wr_;
+    void const* h_;
+    coding_fn coding_;
+    boost::optional<zlib::Format> format_;
+    zlib::deflate_stream ds_;
+    boost::optional<inner_buffers_type> in_;
+    iterator it_;                       // current buffer in in_
+    std::size_t skip_ = 0;              // bytes used of *it_
+    bool more_ = true;                  // the inner writer has more
+    bool done_ = false;                 // the stream is finished
+    boost::optional<zlib::Flush> flush_;// flush in progress
+    error_code pause_;                  // returned after a flush
+    bool paused_ = false;               // return pause_ next
+    char buf_[4096];                    // compressed output
+
+public:
+    using const_buffers_type =
+        boost::asio::const_buffer;
+
+    template<bool isRequest, class Fields,
+        bool M = is_mutable, typename
+            std::enable_if<! M, int>::type = 0>
+    writer(header<isRequest, Fields> const& h,
+            value_type const& b)
+        : wr_(h, b)
+        , h_(&h)
+        , coding_(&coding<isRequest, Fields>)
+    {
+    }
+
+    template<bool isRequest, class Fields,
+        bool M = is_mutable, typename
+            std::enable_if<M, int>::type = 0>
+    writer(header<isRequest, Fields>& h, value_type& b)
+        : wr_(h, b)
+        , h_(&h)
+        , coding_(&coding<isRequest, Fields>)
+    {
+    }
+
+    void
+    init(error_code& ec)
+    {
+        format_ = coding_(h_);
+        if(format_)
+            ds_.format(*format_);
+        wr_.init(ec);
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get(error_code& ec)
+    {
+        if(! format_)
+            return get_identity(ec);
+        return get_compressed(ec);
+    }
+
+private:
+    // Returns the remaining buffers of the inner writer's
+    // sequence one at a time, without copying them.
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get_identity(error_code& ec)
+    {
+        for(;;)
+        {
+            if(in_)
+            {
+                auto const end =
+                    boost::asio::buffer_sequence_end(*in_);
+                while(it_ != end)
+                {
+                    boost::asio::const_buffer const b = *it_++;
+                    if(b.size() > 0)
+                        return {{b, it_ != end || more_}};
+                }
+                in_ = boost::none;
+            }
+            if(! more_)
+            {
+                ec.assign(0, ec.category());
+                return boost::none;
+            }
+            if(! next(ec))
+                return boost::none;
+        }
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get_compressed(error_code& ec)
+    {
+        ec.assign(0, ec.category());
+        if(done_)
+            return boost::none;
+        if(paused_)
+        {
+            paused_ = false;
+            ec = pause_;
+            return boost::none;
+        }
+        zlib::z_params zs;
+        zs.next_out = buf_;
+        zs.avail_out = sizeof(buf_);
+        auto const output =
+            [&](bool more) ->
+                boost::optional<std::pair<const_buffers_type, bool>>
+            {
+                ec.assign(0, ec.category());
+                auto const n = sizeof(buf_) - zs.avail_out;
+                if(n == 0)
+                    return boost::none;
+                return {{const_buffers_type{buf_, n}, more}};
+            };
+        for(;;)
+        {
+            // compress the input we have
+            if(in_)
+            {
+                auto const end =
+                    boost::asio::buffer_sequence_end(*in_);
+                while(it_ != end)
+                {
+                    boost::asio::const_buffer const b = *it_;
+                    zs.next_in = static_cast<
+                        char const*>(b.data()) + skip_;
+                    zs.avail_in = b.size() - skip_;
+                    if(zs.avail_in > 0)
+                    {
+                        ds_.write(zs, zlib::Flush::none, ec);
+                        if(ec)
+                            return boost::none;
+                        skip_ = b.size() - zs.avail_in;
+                        if(zs.avail_out == 0)
+                            return output(true);
+                    }
+                    ++it_;
+                    skip_ = 0;
+                }
+                in_ = boost::none;
+            }
+
+            // finish the stream, or flush before pausing
+            if(flush_)
+            {
+                zs.next_in = nullptr;
+                zs.avail_in = 0;
+                ds_.write(zs, *flush_, ec);
+                if(ec == zlib::error::end_of_stream)
+                {
+                    done_ = true;
+                    return output(false);
+                }
+                if(ec == zlib::error::need_buffers)
+                    ec.assign(0, ec.category());
+                if(ec)
+                    return boost::none;
+                if(zs.avail_out == 0)
+                    return output(true);
+                flush_ = boost::none;
+                if(sizeof(buf_) - zs.avail_out > 0)
+                {
+                    paused_ = true;
+                    return output(true);
+                }
+                ec = pause_;
+                return boost::none;
+            }
+
+            if(! more_)
+            {
+                flush_ = zlib::Flush::finish;
+                continue;
+            }
+            if(! next(ec))
+            {
+                if(ec != error::need_buffer)
+                    return boost::none;
+                pause_ = ec;
+                ec.assign(0, ec.category());
+                flush_ = zlib::Flush::sync;
+            }
+        }
+    }
+
+    // Get the next buffers from the inner writer.
+    // Returns false on error.
+    bool
+    next(error_code& ec)
+    {
+        auto result = wr_.get(ec);
+        if(ec)
+            return false;
+        if(! result)
+        {
+            more_ = false;
+            return true;
+        }
+        in_.emplace(std::move(result->first));
+        more_ = result->second;
+        it_ = boost::asio::buffer_sequence_begin(*in_);
+        skip_ = 0;
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Body, std::uint64_t Limit>
+class compressed_body<Body, Limit>::reader
+{
+    typename Body::reader rd_;
+    void const* h_;
+    coding_fn coding_;
+    boost::optional<zlib::Format> format_;
+    zlib::inflate_stream is_;
+    bool done_ = false;                 // end of the compressed stream
+    bool full_ = false;                 // the last write filled buf_
+    std::uint64_t total_ = 0;           // bytes decompressed
+    std::size_t pos_ = 0;               // first byte of buf_ to put
+    std::size_t size_ = 0;              // bytes in buf_
+    char buf_[4096];                    // decompressed output
+
+public:
+    template<bool isRequest, class Fields>
+    explicit
+    reader(header<isRequest, Fields>& h, value_type& b)
+        : rd_(h, b)
+        , h_(&h)
+        , coding_(&coding<isRequest, Fields>)
+    {
+    }
+
+    void
+    init(boost::optional<
+        std::uint64_t> const& length, error_code& ec)
+    {
+        format_ = coding_(h_);
+        if(! format_)
+            return rd_.init(length, ec);
+        is_.format(*format_);
+
+        // The decompressed length is not known
+        rd_.init(boost::none, ec);
+    }
+
+    template<class ConstBufferSequence>
+    std::size_t
+    put(ConstBufferSequence const& buffers,
+        error_code& ec)
+    {
+        if(! format_)
+            return rd_.put(buffers, ec);
+        ec.assign(0, ec.category());
+        std::size_t used = 0;
+        auto it = boost::asio::buffer_sequence_begin(buffers);
+        auto const end = boost::asio::buffer_sequence_end(buffers);
+        for(; it != end; ++it)
+        {
+            boost::asio::const_buffer b = *it;
+            for(;;)
+            {
+                if(! flush(ec))
+                    return used;
+                if(done_)
+                {
+                    if(b.size() == 0)
+                        break;
+                    // data after the end of the stream
+                    ec = zlib::error::stream_error;
+                    return used;
+                }
+                if(b.size() == 0 && ! full_)
+                    break;
+                auto const n = inflate(b.data(), b.size(), ec);
+                if(ec)
+                    return used;
+                used += n;
+                b = b + n;
+            }
+        }
+        flush(ec);
+        return used;
+    }
+
+    void
+    finish(error_code& ec)
+    {
+        if(format_)
+        {
+            ec.assign(0, ec.category());
+            while(! done_)
+            {
+                if(! flush(ec))
+                {
+                    if(! ec)
+                        ec = error::buffer_overflow;
+                    return;
+                }
+                inflate(nullptr, 0, ec);
+                if(ec)
+                    return;
+                if(! done_ && size_ == 0)
+                {
+                    // the compressed stream was truncated
+                    ec = error::partial_message;
+                    return;
+                }
+            }
+            if(! flush(ec))
+            {
+                if(! ec)
+                    ec = error::buffer_overflow;
+                return;
+            }
+        }
+        rd_.finish(ec);
+    }
+
+private:
+    // Decompress into buf_, returning the input bytes used
+    std::size_t
+    inflate(void const* data, std::size_t size, error_code& ec)
+    {
+        BOOST_ASSERT(pos_ == size_);
+        zlib::z_params zs;
+        zs.next_in = data;
+        zs.avail_in = size;
+        zs.next_out = buf_;
+        zs.avail_out = sizeof(buf_);
+        is_.write(zs, zlib::Flush::sync, ec);
+        if(ec == zlib::error::end_of_stream)
+        {
+            ec.assign(0, ec.category());
+            done_ = true;
+        }
+        else if(ec == zlib::error::need_buffers)
+        {
+            ec.assign(0, ec.category());
+        }
+        pos_ = 0;
+        size_ = sizeof(buf_) - zs.avail_out;
+        full_ = zs.avail_out == 0;
+        if(size_ > Limit - total_)
+        {
+            ec = error::body_limit;
+            size_ = 0;
+        }
+        total_ += size_;
+        return size - zs.avail_in;
+    }
+
+    // Give the decompressed bytes to the inner reader.
+    // Returns false if they were not all taken.
+    bool
+    flush(error_code& ec)
+    {
+        while(pos_ < size_)
+        {
+            auto const n = rd_.put(
+                boost::asio::const_buffer{
+                    buf_ + pos_, size_ - pos_}, ec);
+            pos_ += n;
+            if(ec || n == 0)
+                return false;
+        }
+        pos_ = 0;
+        size_ = 0;
+        return true;
+    }
+};
+
+#endif
+
+} // http
+} // beast
+} // boost
+
+#endif
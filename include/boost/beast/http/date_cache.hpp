@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_DATE_CACHE_HPP
+#define BOOST_BEAST_HTTP_DATE_CACHE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/static_string.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A source of the current date for the `Date` field.
+
+    Objects of this type return the current time formatted as an
+    IMF-fixdate, the preferred format of an HTTP-date (rfc7231
+    section 7.1.1.1), for example `Sun, 06 Nov 1994 08:49:37 GMT`.
+    The date is formatted at most once per second, by whichever
+    caller first observes that the second has changed; all other
+    callers copy the published string.
+
+    A single object may be shared by every connection of a server,
+    across an `io_context` or across threads, without a mutex. The
+    date is published with a sequence counter: readers never wait
+    for the thread formatting a new date, and a reader which finds
+    an update in progress formats the date itself.
+
+    The returned string has a fixed capacity and lives on the
+    caller's stack, so passing it to @ref basic_fields::set or to
+    @ref basic_response_template::date does not allocate memory
+    for the string.
+
+    @par Example
+    @code
+    date_cache dates;   // shared by every connection
+    ...
+    res.set(field::date, dates.get());
+    @endcode
+
+    @tparam Clock The clock to use. The epoch of the clock must be
+    the Unix epoch, 00:00:00 UTC on 1 January 1970, which is the case
+    for `std::chrono::system_clock` on all common platforms.
+*/
+template<class Clock = std::chrono::system_clock>
+class basic_date_cache
+{
+    // Sequence counter, odd while an update is in progress
+    std::atomic<std::uint64_t> seq_{0};
+    std::atomic<std::int64_t> second_;
+    std::atomic<std::uint64_t> words_[4];
+
+    static
+    std::int64_t
+    to_seconds(typename Clock::time_point tp);
+
+    void
+    update(std::int64_t now);
+
+public:
+    /// The type of clock used
+    using clock_type = Clock;
+
+    /// The type of string returned by @ref get
+    using value_type = static_string<29>;
+
+    /// Constructor
+    basic_date_cache();
+
+    /// Constructor (disallowed)
+    basic_date_cache(basic_date_cache const&) = delete;
+
+    /// Assignment (disallowed)
+    basic_date_cache& operator=(basic_date_cache const&) = delete;
+
+    /** Return the current date.
+
+        The date is formatted only if the second changed since
+        the previous call from any thread. Otherwise this costs a
+        reading of the clock and a copy of the published string.
+
+        @par Thread Safety
+        May be called concurrently from any number of threads.
+    */
+    value_type
+    get();
+
+    /** Return the IMF-fixdate for a point in time.
+
+        @param tp The time to format, which is rounded down to
+        the second. The year must lie between 0 and 9999.
+    */
+    static
+    value_type
+    format(typename Clock::time_point tp);
+};
+
+/// A date cache using the system clock
+using date_cache = basic_date_cache<>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/date_cache.ipp>
+
+#endif
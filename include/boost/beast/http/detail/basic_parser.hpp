@@ -19,9 +19,14 @@
 #include <boost/version.hpp>
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <utility>
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <nmmintrin.h>
+#endif
+
 namespace boost {
 namespace beast {
 namespace http {
@@ -176,43 +181,75 @@ struct basic_parser_base
         size_t ranges_size)
     {
         bool found = false;
+    #if ! BOOST_BEAST_NO_INTRINSICS
+        // Ported from picohttpparser by Kazuho Oku et al.
+        if(beast::detail::get_cpu_info().sse42)
+        {
+            if(BOOST_LIKELY(buf_end - buf >= 16))
+            {
+                __m128i const ranges16 = _mm_loadu_si128(
+                    reinterpret_cast<__m128i const*>(ranges));
+                std::size_t left = (buf_end - buf) & ~15;
+                do
+                {
+                    __m128i const b16 = _mm_loadu_si128(
+                        reinterpret_cast<__m128i const*>(buf));
+                    int const r = _mm_cmpestri(
+                        ranges16, static_cast<int>(ranges_size), b16, 16,
+                        _SIDD_LEAST_SIGNIFICANT |
+                        _SIDD_CMP_RANGES | _SIDD_UBYTE_OPS);
+                    if(BOOST_UNLIKELY(r != 16))
+                    {
+                        buf += r;
+                        found = true;
+                        break;
+                    }
+                    buf += 16;
+                    left -= 16;
+                }
+                while(BOOST_LIKELY(left != 0));
+            }
+        }
+    #else
         boost::ignore_unused(buf_end, ranges, ranges_size);
+    #endif
         return {buf, found};
     }
 
-    // VFALCO Can SIMD help this?
+    // memchr is vectorized by most C libraries,
+    // so let it find the carriage returns for us.
     static
     char const*
     find_eol(
         char const* it, char const* last,
             error_code& ec)
     {
-        for(;;)
+        if(it == last)
         {
-            if(it == last)
-            {
-                ec.assign(0, ec.category());
-                return nullptr;
-            }
-            if(*it == '\r')
-            {
-                if(++it == last)
-                {
-                    ec.assign(0, ec.category());
-                    return nullptr;
-                }
-                if(*it != '\n')
-                {
-                    ec = error::bad_line_ending;
-                    return nullptr;
-                }
-                ec.assign(0, ec.category());
-                return ++it;
-            }
-            // VFALCO Should we handle the legacy case
-            // for lines terminated with a single '\n'?
-            ++it;
+            ec.assign(0, ec.category());
+            return nullptr;
+        }
+        it = static_cast<char const*>(std::memchr(
+            it, '\r', static_cast<std::size_t>(last - it)));
+        if(! it)
+        {
+            ec.assign(0, ec.category());
+            return nullptr;
+        }
+        if(++it == last)
+        {
+            ec.assign(0, ec.category());
+            return nullptr;
+        }
+        // VFALCO Should we handle the legacy case
+        // for lines terminated with a single '\n'?
+        if(*it != '\n')
+        {
+            ec = error::bad_line_ending;
+            return nullptr;
         }
+        ec.assign(0, ec.category());
+        return ++it;
     }
 
     static
@@ -223,29 +260,14 @@ struct basic_parser_base
         {
             if(p + 4 > last)
                 return nullptr;
-            if(p[3] != '\n')
-            {
-                if(p[3] == '\r')
-                    ++p;
-                else
-                    p += 4;
-            }
-            else if(p[2] != '\r')
-            {
-                p += 4;
-            }
-            else if(p[1] != '\n')
-            {
-                p += 2;
-            }
-            else if(p[0] != '\r')
-            {
-                p += 2;
-            }
-            else
-            {
+            // only look where a full CRLFCRLF can start
+            p = static_cast<char const*>(std::memchr(
+                p, '\r', static_cast<std::size_t>(last - p - 3)));
+            if(! p)
+                return nullptr;
+            if(p[1] == '\n' && p[2] == '\r' && p[3] == '\n')
                 return p + 4;
-            }
+            ++p;
         }
     }
 
@@ -259,6 +281,12 @@ struct basic_parser_base
         char const*& token_last,
         error_code& ec)
     {
+        // control chars except HTAB, and DEL
+        BOOST_ALIGNMENT(16) static const char ranges[16] =
+            "\x00\x08"  /* 0x00-0x08 */
+            "\x0a\x1f"  /* 0x0a-0x1f */
+            "\x7f\x7f"; /* 0x7f */
+        p = find_fast(p, last, ranges, 6).first;
         for(;; ++p)
         {
             if(p >= last)
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_DETAIL_FILE_BODY_BUFFER_HPP
+#define BOOST_BEAST_HTTP_DETAIL_FILE_BODY_BUFFER_HPP
+
+#include <boost/beast/core/detail/clamp.hpp>
+#include <boost/asio/buffer.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace boost {
+namespace beast {
+namespace http {
+namespace detail {
+
+// Read buffer settings stored in a file body
+struct file_body_buffer_size
+{
+    std::size_t size = 65536;
+    bool adaptive = true;
+};
+
+/*  The buffer used by file body writers to read the file.
+
+    An adaptive buffer starts out small, and doubles each time a read
+    fills it until it reaches the maximum size. Short bodies are sent
+    from the inline storage, while long transfers quickly move to
+    large reads that need fewer system calls.
+*/
+class file_body_buffer
+{
+    std::unique_ptr<char[]> p_;
+    std::size_t capacity_ = 0;  // size of the dynamic storage
+    std::size_t size_;          // size of the next read
+    std::size_t max_;           // largest size of a read
+    char buf_[4096];            // inline storage
+
+public:
+    file_body_buffer()
+        : size_(sizeof(buf_))
+        , max_(sizeof(buf_))
+    {
+    }
+
+    void
+    reset(file_body_buffer_size const& opt)
+    {
+        max_ = (std::max<std::size_t>)(opt.size, 1);
+        size_ = opt.adaptive ?
+            (std::min)(sizeof(buf_), max_) : max_;
+    }
+
+    // Returns storage for the next read of at most `remain` bytes
+    boost::asio::mutable_buffer
+    prepare(std::uint64_t remain)
+    {
+        auto const n = (std::min)(size_,
+            beast::detail::clamp(remain));
+        if(n <= sizeof(buf_))
+            return {buf_, n};
+        if(capacity_ < n)
+        {
+            p_.reset(new char[n]);
+            capacity_ = n;
+        }
+        return {p_.get(), n};
+    }
+
+    // Called after reading `n` bytes into the prepared storage
+    void
+    commit(std::size_t n)
+    {
+        if(n >= size_ && size_ < max_)
+            size_ = (std::min)(size_ * 2, max_);
+    }
+};
+
+} // detail
+} // http
+} // beast
+} // boost
+
+#endif
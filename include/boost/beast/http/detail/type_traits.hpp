@@ -27,6 +27,9 @@ struct message;
 template<bool isRequest,class Body, class Fields>
 class parser;
 
+template<bool isRequest, class Allocator>
+class header_view_parser;
+
 namespace detail {
 
 template<class T>
@@ -49,6 +52,9 @@ struct is_parser : std::false_type {};
 template<bool isRequest, class Body, class Fields>
 struct is_parser<parser<isRequest, Body, Fields>> : std::true_type {};
 
+template<bool isRequest, class Allocator>
+struct is_parser<header_view_parser<isRequest, Allocator>> : std::true_type {};
+
 struct fields_model
 {
     struct writer;
@@ -31,5 +31,6 @@ using file_body = basic_file_body<file>;
 } // boost
 
 #include <boost/beast/http/impl/file_body_win32.ipp>
+#include <boost/beast/http/impl/file_body_posix.ipp>
 
 #endif
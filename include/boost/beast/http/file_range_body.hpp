@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_FILE_RANGE_BODY_HPP
+#define BOOST_BEAST_HTTP_FILE_RANGE_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/file_base.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/type_traits.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/detail/file_body_buffer.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A message body which serves byte ranges of a file.
+
+    This body serializes either an entire file, or the byte ranges
+    of it selected by the Range field of a request, as described
+    in rfc7233. A single range is sent as is, while several ranges
+    are sent as a `multipart/byteranges` payload. The bytes before
+    and between the ranges are never read; the file is positioned
+    at the start of each range with `seek`.
+
+    Use @ref prepare_range to select the ranges and set the fields
+    of the response. Messages with this body type may only be
+    serialized.
+
+    @tparam File The implementation to use for accessing files.
+    This type must meet the requirements of @b File.
+*/
+template<class File>
+struct basic_file_range_body
+{
+    // Make sure the type meets the requirements
+    static_assert(is_file<File>::value,
+        "File requirements not met");
+
+    /// The type of File this body uses
+    using file_type = File;
+
+    /// An inclusive range of byte offsets, as in a Content-Range
+    using range_type = std::pair<std::uint64_t, std::uint64_t>;
+
+    class value_type;
+
+    /** The algorithm for serializing the body
+
+        Meets the requirements of @b BodyWriter.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = implementation_defined;
+#else
+    class writer;
+#endif
+
+    /** Returns the size of the body
+
+        @param body The file body to use
+    */
+    static
+    std::uint64_t
+    size(value_type const& body)
+    {
+        return body.size();
+    }
+};
+
+/** The type of the @ref message::body member.
+
+    Messages declared using `basic_file_range_body` will have this
+    type for the body member. The file is opened with the handle
+    maintained directly in the object. Until ranges are selected
+    with @ref prepare_range, the entire file is sent.
+*/
+template<class File>
+class basic_file_range_body<File>::value_type
+{
+    friend class writer;
+
+    template<class File_, class Fields>
+    friend
+    void
+    prepare_range(response<basic_file_range_body<File_>, Fields>& res,
+        string_view range);
+
+    File file_;
+    std::uint64_t file_size_ = 0;       // size of the file
+    std::uint64_t size_ = 0;            // size of the payload
+    std::vector<range_type> ranges_;    // the ranges to send
+    std::string boundary_;              // separates multiple ranges
+    std::string type_;                  // Content-Type of each part
+    bool whole_ = true;                 // `true` to send the whole file
+    detail::file_body_buffer_size buffer_size_;
+
+    void
+    clear();
+
+    void
+    part_header(std::size_t i, std::string& s) const;
+
+public:
+    /** Destructor.
+
+        If the file is open, it is closed first.
+    */
+    ~value_type() = default;
+
+    /// Constructor
+    value_type() = default;
+
+    /// Constructor
+    value_type(value_type&& other) = default;
+
+    /// Move assignment
+    value_type& operator=(value_type&& other) = default;
+
+    /// Returns `true` if the file is open
+    bool
+    is_open() const
+    {
+        return file_.is_open();
+    }
+
+    /// Returns the size of the file if open
+    std::uint64_t
+    file_size() const
+    {
+        return file_size_;
+    }
+
+    /// Returns the number of octets in the payload
+    std::uint64_t
+    size() const
+    {
+        return size_;
+    }
+
+    /** Returns the ranges of the file which are sent.
+
+        If this is empty, either the entire file is sent or,
+        if @ref whole returns `false`, nothing is sent.
+    */
+    std::vector<range_type> const&
+    ranges() const
+    {
+        return ranges_;
+    }
+
+    /// Returns `true` if the entire file is sent
+    bool
+    whole() const
+    {
+        return whole_;
+    }
+
+    /// Returns the multipart boundary, or an empty string if not multipart
+    string_view
+    boundary() const
+    {
+        return boundary_;
+    }
+
+    /** Set the size of the buffer used to read the file
+
+        @see basic_file_body::value_type::buffer_size
+    */
+    void
+    buffer_size(std::size_t size, bool adaptive = true)
+    {
+        buffer_size_.size = size;
+        buffer_size_.adaptive = adaptive;
+    }
+
+    /// Close the file if open
+    void
+    close();
+
+    /** Open a file at the given path with the specified mode
+
+        Any previously selected ranges are cleared.
+
+        @param path The utf-8 encoded path to the file
+
+        @param mode The file mode to use
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    open(char const* path, file_mode mode, error_code& ec);
+
+    /** Set the open file
+
+        This function is used to set the open file. Any previously
+        set file will be closed, and any selected ranges are cleared.
+
+        @param file The file to set. The file must be open or else
+        an error occurs
+
+        @param ec Set to the error, if any occurred. If the size of
+        the file can't be determined, the file is closed.
+    */
+    void
+    reset(File&& file, error_code& ec);
+};
+
+#if ! BOOST_BEAST_DOXYGEN
+template<class File>
+class basic_file_range_body<File>::writer
+{
+    value_type& body_;
+    std::size_t i_ = 0;             // index of the current range
+    std::uint64_t remain_ = 0;      // unread bytes in the current range
+    bool header_ = false;           // `true` if a part header is next
+    std::string hdr_;               // the current part header
+    detail::file_body_buffer buf_;
+
+    std::size_t
+    count() const;
+
+    void
+    start(error_code& ec);
+
+public:
+    using const_buffers_type =
+        boost::asio::const_buffer;
+
+    template<bool isRequest, class Fields>
+    writer(header<isRequest, Fields>&, value_type& b)
+        : body_(b)
+    {
+        buf_.reset(body_.buffer_size_);
+    }
+
+    void
+    init(error_code& ec);
+
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get(error_code& ec);
+};
+#endif
+
+/** Select the byte ranges of a file to send in a response.
+
+    The value of a Range field is applied to the file in the body
+    of the response, as described in rfc7233. The status and
+    fields of the response are changed as follows:
+
+    @li If `range` is empty, is not a valid `bytes` range set, or
+    contains too many ranges, it is ignored and the whole file is
+    sent. The status is not changed.
+
+    @li If the ranges ask for more octets in total than the file
+    holds, as overlapping ranges may, the field is ignored and the
+    whole file is sent, as recommended by rfc7233 section 6.1.
+
+    @li If no range overlaps the file, the status is set to
+    `416 Range Not Satisfiable`, Content-Range is set to the
+    size of the file, and the payload is empty.
+
+    @li If a single range remains, the status is set to
+    `206 Partial Content` and Content-Range is set to the range.
+
+    @li Otherwise the status is set to `206 Partial Content`, and
+    Content-Type is set to `multipart/byteranges` with a random
+    boundary. The previous Content-Type, if any, is sent in each
+    part.
+
+    Overlapping and adjacent ranges are coalesced, and the ranges
+    are sent in ascending order of offset.
+
+    A response may be prepared again, for example with another
+    range. The status, Content-Range and Content-Type set by the
+    previous call are undone first, so the parts keep the type of
+    the file.
+
+    In all cases Accept-Ranges is set to `bytes`. The caller is
+    responsible for honoring any If-Range field in the request
+    before calling this function, and should call
+    @ref message::prepare_payload afterwards.
+
+    @param res The response. The file in the body must be open.
+
+    @param range The value of the Range field in the request.
+*/
+template<class File, class Fields>
+void
+prepare_range(response<basic_file_range_body<File>, Fields>& res,
+    string_view range);
+
+/// A message body which serves byte ranges of a file
+using file_range_body = basic_file_range_body<file>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/file_range_body.ipp>
+
+#endif
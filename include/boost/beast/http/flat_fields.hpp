@@ -0,0 +1,673 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_FLAT_FIELDS_HPP
+#define BOOST_BEAST_HTTP_FLAT_FIELDS_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string_param.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/allocator.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/core/empty_value.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A container for storing HTTP header fields in a single buffer.
+
+    This container holds the same information as @ref basic_fields
+    and behaves the same way, but the representation is flat: the
+    method, target or reason, and every field are kept serialized in
+    one contiguous block of memory, preceded by a small index with one
+    entry per field. Looking up a field by its @ref field enum compares
+    the enum rather than the name, and a bitmask of the fields present
+    answers most lookups for absent fields without a search.
+
+    A header with typical fields fits in the first allocation, so
+    with an allocator which hands out memory from a per-request
+    arena, filling the container costs a single allocation. In
+    exchange, inserting a field ahead of others or erasing one moves
+    the fields which follow, and any change to the container
+    invalidates all iterators and references to elements. The fields
+    are serialized as a single buffer.
+
+    Field names are stored as-is, but comparisons are case-insensitive.
+    When the container is iterated the fields are presented in the
+    order of insertion, with fields having the same name following
+    each other consecutively.
+
+    Meets the requirements of @b Fields
+
+    @tparam Allocator The allocator to use. This must meet the
+    requirements of @b Allocator.
+*/
+template<class Allocator>
+class basic_flat_fields
+#if ! BOOST_BEAST_DOXYGEN
+    : private boost::empty_value<Allocator>
+#endif
+{
+    // Fancy pointers are not supported
+    static_assert(std::is_pointer<typename
+        std::allocator_traits<Allocator>::pointer>::value,
+        "Allocator must use regular pointers");
+
+    static std::size_t constexpr max_static_buffer = 4096;
+
+    // Capacity of the first allocation
+    static std::size_t constexpr initial_fields = 16;
+    static std::size_t constexpr initial_size = 512;
+
+    using offset_type = std::uint16_t;
+
+public:
+    /// The type of allocator used.
+    using allocator_type = Allocator;
+
+    /// The type of element used to represent a field
+    class value_type
+    {
+        friend class basic_flat_fields;
+
+        char const* p_;
+        offset_type off_;
+        offset_type len_;
+        field f_;
+
+        boost::asio::const_buffer
+        buffer() const
+        {
+            return {p_, static_cast<std::size_t>(off_) + len_ + 2};
+        }
+
+    public:
+        /// Returns the field enum, which can be @ref field::unknown
+        field
+        name() const
+        {
+            return f_;
+        }
+
+        /// Returns the field name as a string
+        string_view const
+        name_string() const
+        {
+            return {p_, static_cast<std::size_t>(off_ - 2)};
+        }
+
+        /// Returns the value of the field
+        string_view const
+        value() const
+        {
+            return {p_ + off_, static_cast<std::size_t>(len_)};
+        }
+    };
+
+    /// The algorithm used to serialize the header
+#if BOOST_BEAST_DOXYGEN
+    using writer = implementation_defined;
+#else
+    class writer;
+#endif
+
+private:
+    using rebind_type = typename
+        beast::detail::allocator_traits<Allocator>::
+            template rebind_alloc<value_type>;
+
+    using alloc_traits =
+        beast::detail::allocator_traits<rebind_type>;
+
+public:
+    /// Destructor
+    ~basic_flat_fields();
+
+    /// Constructor.
+    basic_flat_fields() = default;
+
+    /** Constructor.
+
+        @param alloc The allocator to use.
+    */
+    explicit
+    basic_flat_fields(Allocator const& alloc) noexcept;
+
+    /** Move constructor.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+    */
+    basic_flat_fields(basic_flat_fields&&) noexcept;
+
+    /** Move constructor.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+
+        @param alloc The allocator to use.
+    */
+    basic_flat_fields(basic_flat_fields&&, Allocator const& alloc);
+
+    /// Copy constructor.
+    basic_flat_fields(basic_flat_fields const&);
+
+    /** Copy constructor.
+
+        @param alloc The allocator to use.
+    */
+    basic_flat_fields(basic_flat_fields const&, Allocator const& alloc);
+
+    /** Move assignment.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+    */
+    basic_flat_fields& operator=(basic_flat_fields&&) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value);
+
+    /// Copy assignment.
+    basic_flat_fields& operator=(basic_flat_fields const&);
+
+public:
+    /// A constant iterator to the field sequence.
+#if BOOST_BEAST_DOXYGEN
+    using const_iterator = implementation_defined;
+#else
+    using const_iterator = value_type const*;
+#endif
+
+    /// A constant iterator to the field sequence.
+    using iterator = const_iterator;
+
+    /// Return a copy of the allocator associated with the container.
+    allocator_type
+    get_allocator() const
+    {
+        return this->get();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Element access
+    //
+    //--------------------------------------------------------------------------
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    string_view const
+    at(field name) const;
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    string_view const
+    at(string_view name) const;
+
+    /** Returns the value for a field, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view const
+    operator[](field name) const;
+
+    /** Returns the value for a case-insensitive matching header, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view const
+    operator[](string_view name) const;
+
+    //--------------------------------------------------------------------------
+    //
+    // Iterators
+    //
+    //--------------------------------------------------------------------------
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    begin() const
+    {
+        return table_;
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    end() const
+    {
+        return table_ + n_;
+    }
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Capacity
+    //
+    //--------------------------------------------------------------------------
+
+private:
+    bool
+    empty() const
+    {
+        return n_ == 0;
+    }
+public:
+
+    //--------------------------------------------------------------------------
+    //
+    // Modifiers
+    //
+    //--------------------------------------------------------------------------
+
+    /** Remove all fields from the container
+
+        All references, pointers, or iterators referring to contained
+        elements are invalidated. All past-the-end iterators are also
+        invalidated. The memory is kept for reuse.
+
+        @par Postconditions:
+        @code
+            std::distance(this->begin(), this->end()) == 0
+        @endcode
+    */
+    void
+    clear();
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(field name, string_param const& value);
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(string_view name, string_param const& value);
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param name_string The literal text corresponding to the
+        field name. If `name != field::unknown`, then this value
+        must be equal to `to_string(name)` using a case-insensitive
+        comparison, otherwise the behavior is undefined.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(field name, string_view name_string,
+        string_param const& value);
+
+    /** Set a field value, removing any other instances of that field.
+
+        First removes any values with matching field names, then
+        inserts the new field value.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    set(field name, string_param const& value);
+
+    /** Set a field value, removing any other instances of that field.
+
+        First removes any values with matching field names, then
+        inserts the new field value.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    set(string_view name, string_param const& value);
+
+    /** Remove a field.
+
+        All references and iterators are invalidated.
+
+        @param pos An iterator to the element to remove.
+
+        @return An iterator following the removed element.
+        If the iterator refers to the last element, the end()
+        iterator is returned.
+    */
+    const_iterator
+    erase(const_iterator pos);
+
+    /** Remove all fields with the specified name.
+
+        All fields with the same field name are erased from the
+        container. All references and iterators are invalidated.
+
+        @param name The field name.
+
+        @return The number of fields removed.
+    */
+    std::size_t
+    erase(field name);
+
+    /** Remove all fields with the specified name.
+
+        All fields with the same field name are erased from the
+        container. All references and iterators are invalidated.
+
+        @param name The field name.
+
+        @return The number of fields removed.
+    */
+    std::size_t
+    erase(string_view name);
+
+    /// Swap this container with another
+    void
+    swap(basic_flat_fields& other);
+
+    /// Swap two field containers
+    template<class Alloc>
+    friend
+    void
+    swap(basic_flat_fields<Alloc>& lhs, basic_flat_fields<Alloc>& rhs);
+
+    //--------------------------------------------------------------------------
+    //
+    // Lookup
+    //
+    //--------------------------------------------------------------------------
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    std::size_t
+    count(field name) const;
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    std::size_t
+    count(string_view name) const;
+
+    /** Returns an iterator to the case-insensitive matching field.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(field name) const;
+
+    /** Returns an iterator to the case-insensitive matching field name.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(string_view name) const;
+
+    /** Returns a range of iterators to the fields with the specified name.
+
+        @param name The field name.
+
+        @return A range of iterators to fields with the same name,
+        otherwise an empty range.
+    */
+    std::pair<const_iterator, const_iterator>
+    equal_range(field name) const;
+
+    /** Returns a range of iterators to the fields with the specified name.
+
+        @param name The field name.
+
+        @return A range of iterators to fields with the same name,
+        otherwise an empty range.
+    */
+    std::pair<const_iterator, const_iterator>
+    equal_range(string_view name) const;
+
+protected:
+    /** Returns the request-method string.
+
+        @note Only called for requests.
+    */
+    string_view
+    get_method_impl() const;
+
+    /** Returns the request-target string.
+
+        @note Only called for requests.
+    */
+    string_view
+    get_target_impl() const;
+
+    /** Returns the response reason-phrase string.
+
+        @note Only called for responses.
+    */
+    string_view
+    get_reason_impl() const;
+
+    /** Returns the chunked Transfer-Encoding setting
+    */
+    bool
+    get_chunked_impl() const;
+
+    /** Returns the keep-alive setting
+    */
+    bool
+    get_keep_alive_impl(unsigned version) const;
+
+    /** Returns `true` if the Content-Length field is present.
+    */
+    bool
+    has_content_length_impl() const;
+
+    /** Set or clear the method string.
+
+        @note Only called for requests.
+    */
+    void
+    set_method_impl(string_view s);
+
+    /** Set or clear the target string.
+
+        @note Only called for requests.
+    */
+    void
+    set_target_impl(string_view s);
+
+    /** Set or clear the reason string.
+
+        @note Only called for responses.
+    */
+    void
+    set_reason_impl(string_view s);
+
+    /** Adjusts the chunked Transfer-Encoding value
+    */
+    void
+    set_chunked_impl(bool value);
+
+    /** Sets or clears the Content-Length field
+    */
+    void
+    set_content_length_impl(
+        boost::optional<std::uint64_t> const& value);
+
+    /** Adjusts the Connection field
+    */
+    void
+    set_keep_alive_impl(
+        unsigned version, bool keep_alive);
+
+private:
+    static
+    std::uint64_t
+    mask(field name)
+    {
+        return std::uint64_t{1} <<
+            (static_cast<unsigned>(name) % 64);
+    }
+
+    bool
+    aliases(string_view s) const;
+
+    static
+    bool
+    matches(value_type const& e,
+        field name, string_view sname);
+
+    const_iterator
+    find(field name, string_view sname) const;
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(field name, string_view sname) const;
+
+    void
+    erase(const_iterator first, const_iterator last);
+
+    void
+    insert_element(field name,
+        string_view sname, string_view value);
+
+    void
+    set_element(field name,
+        string_view sname, string_view value);
+
+    char*
+    splice(std::size_t pos, std::size_t n,
+        std::size_t size, std::size_t fields);
+
+    void
+    set_string(std::size_t pos, std::size_t& len,
+        string_view prefix, string_view s);
+
+    void
+    copy_all(basic_flat_fields const&);
+
+    void
+    clear_all();
+
+    void
+    swap_all(basic_flat_fields& other) noexcept;
+
+    void
+    move_assign(basic_flat_fields&, std::true_type);
+
+    void
+    move_assign(basic_flat_fields&, std::false_type);
+
+    void
+    copy_assign(basic_flat_fields const&, std::true_type);
+
+    void
+    copy_assign(basic_flat_fields const&, std::false_type);
+
+    void
+    swap(basic_flat_fields& other, std::true_type);
+
+    void
+    swap(basic_flat_fields& other, std::false_type);
+
+    // The index, followed in the same
+    // allocation by the text of the header
+    value_type* table_ = nullptr;
+    char* text_ = nullptr;
+    std::size_t n_ = 0;         // number of fields
+    std::size_t capacity_ = 0;  // capacity of the index
+    std::size_t size_ = 0;      // size of the text
+    std::size_t reserved_ = 0;  // capacity of the text
+    std::size_t method_ = 0;    // size of the method, at the front
+    std::size_t target_or_reason_ = 0; // size of what follows the method
+    std::uint64_t mask_ = 0;    // mask() of each field present
+};
+
+/// A fields container which keeps the header in a single buffer
+using flat_fields = basic_flat_fields<std::allocator<char>>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/flat_fields.ipp>
+
+#endif
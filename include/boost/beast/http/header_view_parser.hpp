@@ -0,0 +1,451 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_HEADER_VIEW_PARSER_HPP
+#define BOOST_BEAST_HTTP_HEADER_VIEW_PARSER_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/allocator.hpp>
+#include <boost/beast/http/basic_parser.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** An HTTP/1 parser which refers to the header in the input buffer.
+
+    This class uses the basic HTTP/1 wire format parser to parse a
+    header without copying it. Instead of inserting each field into
+    a @ref basic_fields container, the parser records where the start
+    line and each field lie in the caller's input, and presents them
+    as read-only views, in the order received. A @ref basic_fields
+    header is only built if the caller asks for one to modify, by
+    calling @ref get or @ref release.
+
+    The views refer to the buffer passed to @ref put, which must be
+    a single contiguous buffer such as the one provided by
+    @ref beast::flat_buffer. They remain valid for as long as the
+    caller leaves the header octets in that buffer untouched, even
+    after they are consumed. Before writing new data over the header,
+    for example by reading the body or the next message into the same
+    buffer, call @ref pin to copy the header into storage owned by
+    the parser. The parser pins the header by itself when the views
+    could not otherwise outlive the call to @ref put: when the input
+    is a buffer sequence of more than one element, or when a field
+    value uses the obsolete line folding and has to be unfolded.
+
+    This parser does not store a body. If the message has one, the
+    parser fails with @ref error::unexpected_body upon receiving body
+    octets. To read the body, construct a @ref parser from this one
+    after the header is done; only then is the header materialized.
+
+    @par Example
+    @code
+    flat_buffer buffer;
+    request_header_view_parser<> p;
+    read_header(sock, buffer, p);
+    if(p[field::upgrade] == "websocket")
+        ...
+    request_parser<string_body> p2{std::move(p)};
+    read(sock, buffer, p2);
+    @endcode
+
+    @tparam isRequest Indicates whether a request or response
+    will be parsed.
+
+    @tparam Allocator The type of allocator used for the parser's
+    own storage, and with the @ref basic_fields container of the
+    materialized header.
+
+    @note A new instance of the parser is required for each message.
+*/
+template<
+    bool isRequest,
+    class Allocator = std::allocator<char>>
+class header_view_parser
+    : public basic_parser<isRequest,
+        header_view_parser<isRequest, Allocator>>
+{
+public:
+    /// The type of header produced when the header is materialized
+    using header_type = header<isRequest, basic_fields<Allocator>>;
+
+    /// The type of element presented when iterating the fields
+    class value_type
+    {
+        friend class header_view_parser;
+
+        string_view name_;
+        string_view value_;
+        field f_;
+
+    public:
+        /// Returns the field enum, which can be @ref field::unknown
+        field
+        name() const
+        {
+            return f_;
+        }
+
+        /// Returns the field name as a string
+        string_view
+        name_string() const
+        {
+            return name_;
+        }
+
+        /// Returns the value of the field
+        string_view
+        value() const
+        {
+            return value_;
+        }
+    };
+
+    /// A constant iterator to the fields
+    using const_iterator = value_type const*;
+
+private:
+    using rebind_type = typename
+        beast::detail::allocator_traits<Allocator>::
+            template rebind_alloc<value_type>;
+
+    Allocator alloc_;
+    std::vector<value_type, rebind_type> list_;
+    std::vector<char, Allocator> fold_;
+    std::vector<char, Allocator> pin_;
+    boost::optional<header_type> h_;
+    char const* base_ = nullptr;
+    char const* end_ = nullptr;
+    string_view method_or_reason_;
+    string_view target_;
+    verb method_ = verb::unknown;
+    int status_ = 0;
+    int version_ = 0;
+    bool pinned_ = false;
+    bool folded_ = false;
+
+public:
+    /// Destructor
+    ~header_view_parser() = default;
+
+    /// Constructor (disallowed)
+    header_view_parser(header_view_parser const&) = delete;
+
+    /// Assignment (disallowed)
+    header_view_parser& operator=(header_view_parser const&) = delete;
+
+    /// Constructor (disallowed)
+    header_view_parser(header_view_parser&&) = delete;
+
+    /// Constructor
+    header_view_parser();
+
+    /** Constructor
+
+        @param alloc The allocator to use.
+    */
+    explicit
+    header_view_parser(Allocator const& alloc);
+
+    /** Returns `true` if the views refer to storage owned by the parser.
+
+        @see pin
+    */
+    bool
+    is_pinned() const
+    {
+        return pinned_;
+    }
+
+    /** Copy the header into storage owned by the parser.
+
+        After this call the views returned by the parser no longer
+        refer to the caller's input buffer, which may then be
+        modified or destroyed. The header is copied as a single
+        block, with one allocation. Calling this function when the
+        header is already pinned has no effect.
+
+        @note The header must be done.
+    */
+    void
+    pin();
+
+    /** Return the request-method verb.
+
+        If the request-method is not one of the recognized verbs,
+        @ref verb::unknown is returned.
+
+        @note This function is only available for requests.
+    */
+    verb
+    method() const;
+
+    /** Return the request-method as a string.
+
+        @note This function is only available for requests.
+    */
+    string_view
+    method_string() const;
+
+    /** Return the request-target string.
+
+        @note This function is only available for requests.
+    */
+    string_view
+    target() const;
+
+    /** The response status-code result.
+
+        If the actual status code is not a known code, this
+        function returns @ref status::unknown. Use @ref result_int
+        to return the raw status code as a number.
+
+        @note This function is only available for responses.
+    */
+    status
+    result() const;
+
+    /** Return the response status-code expressed as an integer.
+
+        @note This function is only available for responses.
+    */
+    unsigned
+    result_int() const;
+
+    /** Return the response reason-phrase.
+
+        The reason-phrase is returned as received, which may
+        be empty.
+
+        @note This function is only available for responses.
+    */
+    string_view
+    reason() const;
+
+    /// Return the HTTP-version, encoded as `major * 10 + minor`.
+    unsigned
+    version() const
+    {
+        return static_cast<unsigned>(version_);
+    }
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    begin() const
+    {
+        return list_.data();
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    end() const
+    {
+        return list_.data() + list_.size();
+    }
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    /** Returns the value for a field, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view
+    operator[](field name) const;
+
+    /** Returns the value for a case-insensitive matching header, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view
+    operator[](string_view name) const;
+
+    /// Return the number of fields with the specified name.
+    std::size_t
+    count(field name) const;
+
+    /// Return the number of fields with the specified name.
+    std::size_t
+    count(string_view name) const;
+
+    /** Returns an iterator to the case-insensitive matching field.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(field name) const;
+
+    /** Returns an iterator to the case-insensitive matching field name.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(string_view name) const;
+
+    /** Returns the materialized header.
+
+        The first call builds a @ref basic_fields header from the
+        views; this is the only time the fields are copied. Changes
+        made to the returned header are not reflected in the views,
+        which always present the header as it was received.
+
+        @note The header must be done.
+    */
+    header_type&
+    get();
+
+    /** Returns ownership of the materialized header.
+
+        The header is materialized first if @ref get was not called.
+        After this call, subsequent calls to @ref get produce a new
+        copy of the received header.
+
+        @note The header must be done.
+    */
+    header_type
+    release();
+
+private:
+    friend class basic_parser<isRequest, header_view_parser>;
+
+    void
+    init();
+
+    void
+    materialize(header<true, basic_fields<Allocator>>& h) const;
+
+    void
+    materialize(header<false, basic_fields<Allocator>>& h) const;
+
+    template<class Pred>
+    const_iterator
+    find_if(Pred const& pred) const;
+
+    void
+    on_request_impl(
+        verb method,
+        string_view method_str,
+        string_view target,
+        int version,
+        error_code& ec);
+
+    void
+    on_response_impl(
+        int code,
+        string_view reason,
+        int version,
+        error_code& ec);
+
+    void
+    on_field_impl(
+        field name,
+        string_view name_string,
+        string_view value,
+        error_code& ec);
+
+    void
+    on_header_impl(error_code& ec);
+
+    void
+    on_body_init_impl(
+        boost::optional<std::uint64_t> const&,
+        error_code& ec)
+    {
+        ec.assign(0, ec.category());
+    }
+
+    std::size_t
+    on_body_impl(string_view, error_code& ec)
+    {
+        ec = error::unexpected_body;
+        return 0;
+    }
+
+    void
+    on_chunk_header_impl(
+        std::uint64_t,
+        string_view,
+        error_code& ec)
+    {
+        ec.assign(0, ec.category());
+    }
+
+    std::size_t
+    on_chunk_body_impl(
+        std::uint64_t,
+        string_view,
+        error_code& ec)
+    {
+        ec = error::unexpected_body;
+        return 0;
+    }
+
+    void
+    on_finish_impl(error_code& ec)
+    {
+        ec.assign(0, ec.category());
+    }
+};
+
+/// A parser for viewing a request header
+template<class Allocator = std::allocator<char>>
+using request_header_view_parser =
+    header_view_parser<true, Allocator>;
+
+/// A parser for viewing a response header
+template<class Allocator = std::allocator<char>>
+using response_header_view_parser =
+    header_view_parser<false, Allocator>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/header_view_parser.ipp>
+
+#endif
@@ -120,8 +120,11 @@ put(ConstBufferSequence const& buffers,
     // flatten
     buffer_copy(boost::asio::buffer(
         buf_.get(), buf_len_), buffers);
-    return put(boost::asio::const_buffer{
+    f_ |= flagInputCopied;
+    auto const used = put(boost::asio::const_buffer{
         buf_.get(), buf_len_}, ec);
+    f_ &= ~flagInputCopied;
+    return used;
 }
 
 template<bool isRequest, class Derived>
@@ -307,8 +310,11 @@ put_from_stack(std::size_t size,
     using boost::asio::buffer;
     using boost::asio::buffer_copy;
     buffer_copy(buffer(buf, sizeof(buf)), buffers);
-    return put(boost::asio::const_buffer{
+    f_ |= flagInputCopied;
+    auto const used = put(boost::asio::const_buffer{
         buf, size}, ec);
+    f_ &= ~flagInputCopied;
+    return used;
 }
 
 template<bool isRequest, class Derived>
@@ -319,7 +325,9 @@ maybe_need_more(
     char const* p, std::size_t n,
         error_code& ec)
 {
-    if(skip_ == 0)
+    if(skip_ == 0 && (
+        state_ != state::start_line ||
+        ! (f_ & flagWholeHeader)))
         return;
     if( n > header_limit_)
         n = header_limit_;
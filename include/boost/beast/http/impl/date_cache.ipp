@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_DATE_CACHE_IPP
+#define BOOST_BEAST_HTTP_IMPL_DATE_CACHE_IPP
+
+#include <boost/beast/core/string.hpp>
+#include <boost/assert.hpp>
+#include <cstring>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Writes the 29 characters of the IMF-fixdate
+// for a number of seconds since the Unix epoch.
+inline
+void
+format_date(char* p, std::int64_t t)
+{
+    auto days = t / 86400;
+    auto secs = t % 86400;
+    if(secs < 0)
+    {
+        secs += 86400;
+        --days;
+    }
+
+    // 1970-01-01 was a Thursday
+    auto const wday = static_cast<int>(
+        ((days + 4) % 7 + 7) % 7);
+
+    // Civil date from days since the epoch, from
+    // http://howardhinnant.github.io/date_algorithms.html
+    auto const z = days + 719468;
+    auto const era = (z >= 0 ? z : z - 146096) / 146097;
+    auto const doe = z - era * 146097;
+    auto const yoe = (doe - doe / 1460 +
+        doe / 36524 - doe / 146096) / 365;
+    auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto const mp = (5 * doy + 2) / 153;
+    auto const mday = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    auto const mon = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    auto const year = static_cast<int>(
+        yoe + era * 400 + (mon <= 2 ? 1 : 0));
+    BOOST_ASSERT(year >= 0 && year <= 9999);
+
+    auto const hour = static_cast<int>(secs / 3600);
+    auto const min = static_cast<int>((secs / 60) % 60);
+    auto const sec = static_cast<int>(secs % 60);
+
+    static char const wdays[] = "SunMonTueWedThuFriSat";
+    static char const months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    std::memcpy(p, wdays + 3 * wday, 3);
+    p[3] = ',';
+    p[4] = ' ';
+    p[5] = '0' + static_cast<char>(mday / 10);
+    p[6] = '0' + static_cast<char>(mday % 10);
+    p[7] = ' ';
+    std::memcpy(p + 8, months + 3 * (mon - 1), 3);
+    p[11]= ' ';
+    p[12]= '0' + static_cast<char>(year / 1000);
+    p[13]= '0' + static_cast<char>((year / 100) % 10);
+    p[14]= '0' + static_cast<char>((year / 10) % 10);
+    p[15]= '0' + static_cast<char>(year % 10);
+    p[16]= ' ';
+    p[17]= '0' + static_cast<char>(hour / 10);
+    p[18]= '0' + static_cast<char>(hour % 10);
+    p[19]= ':';
+    p[20]= '0' + static_cast<char>(min / 10);
+    p[21]= '0' + static_cast<char>(min % 10);
+    p[22]= ':';
+    p[23]= '0' + static_cast<char>(sec / 10);
+    p[24]= '0' + static_cast<char>(sec % 10);
+    p[25]= ' ';
+    p[26]= 'G';
+    p[27]= 'M';
+    p[28]= 'T';
+}
+
+} // detail
+
+template<class Clock>
+basic_date_cache<Clock>::
+basic_date_cache()
+{
+    auto const now = to_seconds(Clock::now());
+    char buf[sizeof(words_)] = {};
+    detail::format_date(buf, now);
+    for(std::size_t i = 0; i < 4; ++i)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, buf + 8 * i, sizeof(w));
+        words_[i].store(w, std::memory_order_relaxed);
+    }
+    second_.store(now, std::memory_order_release);
+}
+
+template<class Clock>
+std::int64_t
+basic_date_cache<Clock>::
+to_seconds(typename Clock::time_point tp)
+{
+    // round towards negative infinity
+    auto const d = tp.time_since_epoch();
+    auto s = std::chrono::duration_cast<std::chrono::seconds>(d);
+    if(s > d)
+        s -= std::chrono::seconds{1};
+    return static_cast<std::int64_t>(s.count());
+}
+
+template<class Clock>
+void
+basic_date_cache<Clock>::
+update(std::int64_t now)
+{
+    // Only one thread formats, the others keep
+    // reading the previous date in the meantime.
+    auto seq = seq_.load(std::memory_order_relaxed);
+    if((seq & 1) || ! seq_.compare_exchange_strong(
+            seq, seq + 1, std::memory_order_relaxed))
+        return;
+    std::atomic_thread_fence(std::memory_order_release);
+    // The clock may have been read by a thread which
+    // was then delayed, never go back to an older date.
+    if(now > second_.load(std::memory_order_relaxed))
+    {
+        char buf[sizeof(words_)] = {};
+        detail::format_date(buf, now);
+        for(std::size_t i = 0; i < 4; ++i)
+        {
+            std::uint64_t w;
+            std::memcpy(&w, buf + 8 * i, sizeof(w));
+            words_[i].store(w, std::memory_order_relaxed);
+        }
+        second_.store(now, std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+template<class Clock>
+auto
+basic_date_cache<Clock>::
+get() ->
+    value_type
+{
+    auto const now = to_seconds(Clock::now());
+    if(now > second_.load(std::memory_order_relaxed))
+        update(now);
+    char buf[sizeof(words_)];
+    for(;;)
+    {
+        auto const seq = seq_.load(std::memory_order_acquire);
+        if(seq & 1)
+            break;
+        std::uint64_t w[4];
+        for(std::size_t i = 0; i < 4; ++i)
+            w[i] = words_[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(seq_.load(std::memory_order_relaxed) == seq)
+        {
+            std::memcpy(buf, w, sizeof(w));
+            return value_type{string_view{buf, 29}};
+        }
+    }
+    // Another thread is publishing a new date
+    detail::format_date(buf, now);
+    return value_type{string_view{buf, 29}};
+}
+
+template<class Clock>
+auto
+basic_date_cache<Clock>::
+format(typename Clock::time_point tp) ->
+    value_type
+{
+    char buf[29];
+    detail::format_date(buf, to_seconds(tp));
+    return value_type{string_view{buf, 29}};
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -13,7 +13,8 @@
 #include <boost/beast/core/string.hpp>
 #include <algorithm>
 #include <array>
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <boost/assert.hpp>
 
@@ -28,58 +29,131 @@ struct field_table
     using array_type =
         std::array<string_view, 353>;
 
-    struct hash
+    // Slots in the hash table, a power of two
+    static std::size_t constexpr table_size = 1024;
+
+    // First level buckets, selected by the top bits of the hash
+    static unsigned constexpr bucket_bits = 8;
+    static std::size_t constexpr bucket_count =
+        std::size_t{1} << bucket_bits;
+
+    static
+    std::uint64_t
+    load(char const* p)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    // Returns a word holding every character of a string
+    // shorter than eight, some possibly more than once.
+    static
+    std::uint64_t
+    load(char const* p, std::size_t n)
     {
-        std::size_t
-        operator()(string_view s) const
+        if(n >= 4)
         {
-            auto const n = s.size();
-            return
-                beast::detail::ascii_tolower(s[0]) *
-                beast::detail::ascii_tolower(s[n/2]) ^
-                beast::detail::ascii_tolower(s[n-1]);   // hist[] = 331, 10, max_load_factor = 0.15f
+            std::uint32_t lo;
+            std::uint32_t hi;
+            std::memcpy(&lo, p, sizeof(lo));
+            std::memcpy(&hi, p + n - 4, sizeof(hi));
+            return (std::uint64_t{hi} << 32) | lo;
         }
-    };
+        if(n > 0)
+            return
+                static_cast<unsigned char>(p[0]) |
+                static_cast<unsigned char>(p[n / 2]) << 8 |
+                static_cast<unsigned char>(p[n - 1]) << 16;
+        return 0;
+    }
 
-    struct iequal
+    // Hashes the name with ASCII letters folded to lower case,
+    // eight characters at a time. The last word overlaps the
+    // one before it, rather than being assembled a character
+    // at a time. Other characters may fold together, which
+    // only costs a failed comparison.
+    static
+    std::uint64_t
+    hash(string_view s, std::uint64_t seed)
     {
-        // assumes inputs have equal length
-        bool
-        operator()(
-            string_view lhs,
-            string_view rhs) const
+        std::uint64_t const fold = 0x2020202020202020;
+        std::uint64_t const prime = 0x100000001b3;
+        auto p = s.data();
+        auto const n = s.size();
+        std::uint64_t h = (seed ^ n) * prime;
+        if(n < 8)
         {
-            auto p1 = lhs.data();
-            auto p2 = rhs.data();
-            auto pend = p1 + lhs.size();
-            char a, b;
-            while(p1 < pend)
-            {
-                a = *p1++;
-                b = *p2++;
-                if(a != b)
-                    goto slow;
-            }
-            return true;
+            h = (h ^ (load(p, n) | fold)) * prime;
+        }
+        else
+        {
+            auto const last = p + n - 8;
+            for(; p < last; p += 8)
+                h = (h ^ (load(p) | fold)) * prime;
+            h = (h ^ (load(last) | fold)) * prime;
+        }
+        // MurmurHash3 finalizer
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
 
-            while(p1 < pend)
-            {
-            slow:
-                if( beast::detail::ascii_tolower(a) !=
-                    beast::detail::ascii_tolower(b))
-                    return false;
-                a = *p1++;
-                b = *p2++;
-            }
+    static
+    std::size_t
+    slot(std::uint64_t h, std::size_t d)
+    {
+        auto const lo = static_cast<std::uint32_t>(h);
+        auto const hi = static_cast<std::uint32_t>(h >> 32) | 1;
+        return (lo + d * hi) & (table_size - 1);
+    }
+
+    // Compares eight characters of input with eight
+    // characters of a field name, ignoring case.
+    static
+    bool
+    iequal(std::uint64_t w, std::uint64_t name)
+    {
+        auto const x = w ^ name;
+        if(x == 0)
             return true;
-        }
-    };
+        // Only the case bit of letters in the name may differ.
+        // Names are ASCII, so the sums below never carry.
+        auto const t = name | 0x2020202020202020;
+        auto const letters =
+            ((t + 0x1f1f1f1f1f1f1f1f) &     // t >= 'a'
+            ~(t + 0x0505050505050505) &     // t <= 'z'
+                0x8080808080808080) >> 2;
+        return (x & ~letters) == 0;
+    }
 
-    using map_type = std::unordered_map<
-        string_view, field, hash, iequal>;
+    // Case-insensitive comparison of input with a
+    // field name, eight characters at a time.
+    static
+    bool
+    iequal(string_view s, string_view name)
+    {
+        auto const n = s.size();
+        if(n != name.size())
+            return false;
+        auto p1 = s.data();
+        auto p2 = name.data();
+        if(n < 8)
+            return iequal(load(p1, n), load(p2, n));
+        auto const last = p1 + n - 8;
+        for(; p1 < last; p1 += 8, p2 += 8)
+            if(! iequal(load(p1), load(p2)))
+                return false;
+        return iequal(load(last), load(name.data() + n - 8));
+    }
 
     array_type by_name_;
-    std::vector<map_type> by_size_;
+    std::uint64_t seed_ = 0;
+    std::array<std::uint16_t, table_size> slots_;
+    std::array<std::uint16_t, bucket_count> disp_;
 /*
     From:
     
@@ -442,58 +516,75 @@ struct field_table
             "Xref"
         }})
     {
-        // find the longest field length
-        std::size_t high = 0;
-        for(auto const& s : by_name_)
-            if(high < s.size())
-                high = s.size();
-        // build by_size map
-        // skip field::unknown
-        by_size_.resize(high + 1);
-        for(auto& map : by_size_)
-            map.max_load_factor(.15f);
-        for(std::size_t i = 1;
-            i < by_name_.size(); ++i)
-        {
-            auto const& s = by_name_[i];
-            by_size_[s.size()].emplace(
-                s, static_cast<field>(i));
-        }
+        // A new seed is only needed if some bucket
+        // can't be placed, which does not happen
+        // with the current table.
+        while(! build())
+            ++seed_;
+    }
 
-#if 0
-        // This snippet calculates the performance
-        // of the hash function and map settings
+    // Builds a collision free table using hash and
+    // displace: names are grouped into buckets by the top bits
+    // of their hash, then starting with the largest bucket, each
+    // is given the first displacement which moves all of its
+    // names into free slots. A lookup is then one hash, two table
+    // reads, and one comparison.
+    bool
+    build()
+    {
+        slots_.fill(0);
+        disp_.fill(0);
+        std::vector<std::vector<std::uint16_t>> buckets(bucket_count);
+        for(std::size_t i = 1; i < by_name_.size(); ++i)
+            buckets[hash(by_name_[i], seed_) >> (64 - bucket_bits)]
+                .push_back(static_cast<std::uint16_t>(i));
+        std::vector<std::size_t> order;
+        for(std::size_t b = 0; b < bucket_count; ++b)
+            if(! buckets[b].empty())
+                order.push_back(b);
+        std::stable_sort(order.begin(), order.end(),
+            [&](std::size_t lhs, std::size_t rhs)
+            {
+                return buckets[lhs].size() > buckets[rhs].size();
+            });
+        std::vector<std::size_t> placed;
+        for(auto const b : order)
         {
-            std::vector<std::size_t> hist;
-            for(auto const& map : by_size_)
+            auto const& v = buckets[b];
+            std::size_t d = 0;
+            for(; d < table_size; ++d)
             {
-                for(std::size_t i = 0; i < map.bucket_count(); ++i)
+                placed.clear();
+                for(auto const i : v)
                 {
-                    auto const n = map.bucket_size(i);
-                    if(n > 0)
-                    {
-                        if(hist.size() < n)
-                            hist.resize(n);
-                        ++hist[n-1];
-                    }
+                    auto const k = slot(hash(by_name_[i], seed_), d);
+                    if(slots_[k] != 0)
+                        break;
+                    slots_[k] = i;
+                    placed.push_back(k);
                 }
+                if(placed.size() == v.size())
+                    break;
+                for(auto const k : placed)
+                    slots_[k] = 0;
             }
+            if(d == table_size)
+                return false;
+            disp_[b] = static_cast<std::uint16_t>(d);
         }
-#endif
+        return true;
     }
 
     field
     string_to_field(string_view s) const
     {
-        if(s.size() >= by_size_.size())
-            return field::unknown;
-        auto const& map = by_size_[s.size()];
-        if(map.empty())
-            return field::unknown;
-        auto it = map.find(s);
-        if(it == map.end())
+        auto const h = hash(s, seed_);
+        auto const i = slots_[
+            slot(h, disp_[h >> (64 - bucket_bits)])];
+        // Empty slots hold zero, which yields field::unknown
+        if(! iequal(s, by_name_[i]))
             return field::unknown;
-        return it->second;
+        return static_cast<field>(i);
     }
 
     //
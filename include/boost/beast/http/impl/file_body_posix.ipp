@@ -0,0 +1,761 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_FILE_BODY_POSIX_IPP
+#define BOOST_BEAST_HTTP_IMPL_FILE_BODY_POSIX_IPP
+
+#if ! defined(BOOST_BEAST_USE_SENDFILE)
+# if BOOST_BEAST_USE_POSIX_FILE && defined(__linux__)
+#  define BOOST_BEAST_USE_SENDFILE 1
+# else
+#  define BOOST_BEAST_USE_SENDFILE 0
+# endif
+#endif
+
+#if BOOST_BEAST_USE_SENDFILE
+
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/type_traits.hpp>
+#include <boost/beast/core/detail/clamp.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/http/detail/file_body_buffer.hpp>
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/basic_stream_socket.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/handler_continuation_hook.hpp>
+#include <boost/asio/handler_invoke_hook.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/types.h>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+struct sendfile_impl;
+} // detail
+
+template<>
+struct basic_file_body<file_posix>
+{
+    using file_type = file_posix;
+
+    class writer;
+    class reader;
+
+    //--------------------------------------------------------------------------
+
+    class value_type
+    {
+        friend class writer;
+        friend class reader;
+        friend struct basic_file_body<file_posix>;
+        friend struct detail::sendfile_impl;
+
+        file_posix file_;
+        std::uint64_t size_ = 0;    // cached file size
+        std::uint64_t first_;       // starting offset of the range
+        std::uint64_t last_;        // ending offset of the range
+        detail::file_body_buffer_size buffer_size_;
+        boost::asio::executor read_ex_;
+
+    public:
+        ~value_type() = default;
+        value_type() = default;
+        value_type(value_type&& other) = default;
+        value_type& operator=(value_type&& other) = default;
+
+        bool
+        is_open() const
+        {
+            return file_.is_open();
+        }
+
+        std::uint64_t
+        size() const
+        {
+            return size_;
+        }
+
+        std::size_t
+        buffer_size() const
+        {
+            return buffer_size_.size;
+        }
+
+        void
+        buffer_size(std::size_t size, bool adaptive = true)
+        {
+            buffer_size_.size = size;
+            buffer_size_.adaptive = adaptive;
+        }
+
+        /// Returns the executor used to read the file, if any
+        boost::asio::executor const&
+        read_executor() const
+        {
+            return read_ex_;
+        }
+
+        /** Set the executor used to read the file
+
+            When writing to a TCP socket asynchronously, the part of
+            the file sent next is read into the page cache with
+            `readahead`, by a function submitted to this executor,
+            and then sent from the socket's executor. The data is
+            not copied out of the page cache on either thread. Reads
+            from a slow disk block one of its threads and not the
+            thread running the socket's `io_context`, which may close
+            the socket at any time. This is usually a
+            `boost::asio::thread_pool`. By default the file is read
+            on the calling thread.
+        */
+        void
+        read_executor(boost::asio::executor ex)
+        {
+            read_ex_ = std::move(ex);
+        }
+
+        void
+        close();
+
+        void
+        open(char const* path, file_mode mode, error_code& ec);
+
+        void
+        reset(file_posix&& file, error_code& ec);
+    };
+
+    //--------------------------------------------------------------------------
+
+    class writer
+    {
+        friend struct detail::sendfile_impl;
+
+        value_type& body_;  // The body we are reading from
+        std::uint64_t pos_; // The current position in the file
+        detail::file_body_buffer buf_;  // Buffer for reading
+
+    public:
+        using const_buffers_type =
+            boost::asio::const_buffer;
+
+        template<bool isRequest, class Fields>
+        writer(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(error_code& ec)
+        {
+            BOOST_ASSERT(body_.file_.is_open());
+            pos_ = body_.first_;
+            buf_.reset(body_.buffer_size_);
+        #if BOOST_BEAST_USE_POSIX_FADVISE
+            // The body is read front to back, so ask for
+            // aggressive read-ahead over just that range.
+            // This is only advice, and failure is harmless.
+            ::posix_fadvise(body_.file_.native_handle(),
+                static_cast<::off_t>(pos_),
+                static_cast<::off_t>(body_.last_ - pos_),
+                POSIX_FADV_SEQUENTIAL);
+        #endif
+            ec.assign(0, ec.category());
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>>
+        get(error_code& ec)
+        {
+            auto const b = buf_.prepare(body_.last_ - pos_);
+            if(b.size() == 0)
+            {
+                ec.assign(0, ec.category());
+                return boost::none;
+            }
+            auto const nread = body_.file_.read_at(
+                pos_, b.data(), b.size(), ec);
+            if(ec)
+                return boost::none;
+            if(nread == 0)
+            {
+                // The file was truncated after it was opened
+                ec = boost::asio::error::eof;
+                return boost::none;
+            }
+            pos_ += nread;
+            buf_.commit(nread);
+            ec.assign(0, ec.category());
+            return {{
+                {b.data(), nread},      // buffer to return.
+                pos_ < body_.last_}};   // `true` if there are more buffers.
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    class reader
+    {
+        value_type& body_;
+
+    public:
+        template<bool isRequest, class Fields>
+        explicit
+        reader(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(boost::optional<
+            std::uint64_t> const& content_length,
+                error_code& ec)
+        {
+            boost::ignore_unused(content_length);
+            BOOST_ASSERT(body_.file_.is_open());
+            ec.assign(0, ec.category());
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        put(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            std::size_t nwritten = 0;
+            for(auto buffer : beast::detail::buffers_range(buffers))
+            {
+                nwritten += body_.file_.write(
+                    buffer.data(), buffer.size(), ec);
+                if(ec)
+                    return nwritten;
+            }
+            ec.assign(0, ec.category());
+            return nwritten;
+        }
+
+        void
+        finish(error_code& ec)
+        {
+            ec.assign(0, ec.category());
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    static
+    std::uint64_t
+    size(value_type const& body)
+    {
+        return body.size();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+close()
+{
+    error_code ignored;
+    file_.close(ignored);
+}
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        return;
+    }
+    first_ = 0;
+    last_ = size_;
+}
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+reset(file_posix&& file, error_code& ec)
+{
+    if(file_.is_open())
+    {
+        error_code ignored;
+        file_.close(ignored);
+    }
+    file_ = std::move(file);
+    if(file_.is_open())
+    {
+        size_ = file_.size(ec);
+        if(ec)
+        {
+            close();
+            return;
+        }
+        first_ = 0;
+        last_ = size_;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+class null_lambda
+{
+public:
+    template<class ConstBufferSequence>
+    void
+    operator()(error_code&,
+        ConstBufferSequence const&) const
+    {
+        BOOST_ASSERT(false);
+    }
+};
+
+struct sendfile_impl
+{
+    // Returns the number of bytes to send from the
+    // file at the writer's position in one call.
+    template<bool isRequest, class Fields>
+    static
+    std::size_t
+    next_size(
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr)
+    {
+        auto& w = sr.writer_impl();
+        // Linux transfers at most 0x7ffff000 bytes per call
+        return static_cast<std::size_t>(
+            (std::min<std::uint64_t>)(
+                (std::min<std::uint64_t>)(w.body_.last_ - w.pos_, sr.limit()),
+                0x7ffff000));
+    }
+
+    // Bring the part of the file which is sent next into the
+    // page cache, without copying it out. readahead blocks
+    // until the data is read, so the following sendfile does
+    // not wait for the disk. This does not touch the socket,
+    // so it may be called from any thread.
+    template<bool isRequest, class Fields>
+    static
+    void
+    prefetch(
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr,
+        error_code& ec)
+    {
+        auto& w = sr.writer_impl();
+        auto const fd = w.body_.file_.native_handle();
+        auto const offset = static_cast<::off_t>(w.pos_);
+        auto const n = next_size(sr);
+        if(::readahead(fd, offset, n) == 0)
+        {
+            ec.assign(0, ec.category());
+            return;
+        }
+        auto const ev = errno;
+        if(ev != EINVAL)
+        {
+            ec.assign(ev, system_category());
+            return;
+        }
+        // The file does not support readahead, so only
+        // ask for it to be read in the background.
+    #if BOOST_BEAST_USE_POSIX_FADVISE
+        ::posix_fadvise(fd, offset,
+            static_cast<::off_t>(n), POSIX_FADV_WILLNEED);
+    #endif
+        ec.assign(0, ec.category());
+    }
+
+    // Send up to `n` bytes from the file at the writer's
+    // position. Returns the number of bytes sent, and sets
+    // `ec` to `would_block` if the socket buffer is full.
+    template<class Protocol, bool isRequest, class Fields>
+    static
+    std::size_t
+    send_some(
+        boost::asio::basic_stream_socket<Protocol>& sock,
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr,
+        std::size_t n,
+        error_code& ec)
+    {
+        auto& w = sr.writer_impl();
+        auto offset = static_cast<::off_t>(w.pos_);
+        for(;;)
+        {
+            auto const result = ::sendfile(
+                sock.native_handle(),
+                w.body_.file_.native_handle(),
+                &offset,
+                n);
+            if(result >= 0)
+            {
+                ec.assign(0, ec.category());
+                return static_cast<std::size_t>(result);
+            }
+            auto const ev = errno;
+            if(ev == EINTR)
+                continue;
+            if(ev == EAGAIN || ev == EWOULDBLOCK)
+                ec = boost::asio::error::would_block;
+            else
+                ec.assign(ev, system_category());
+            return 0;
+        }
+    }
+
+    // Advance the writer after sending from the file
+    template<bool isRequest, class Fields>
+    static
+    void
+    consume(
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr,
+        std::size_t bytes_transferred,
+        error_code& ec)
+    {
+        auto& w = sr.writer_impl();
+        w.pos_ += bytes_transferred;
+        BOOST_ASSERT(w.pos_ <= w.body_.last_);
+        if(w.pos_ < w.body_.last_)
+        {
+            if(bytes_transferred == 0)
+            {
+                // The file was truncated after it was opened
+                ec = boost::asio::error::eof;
+                return;
+            }
+            ec.assign(0, ec.category());
+            return;
+        }
+        sr.next(ec, null_lambda{});
+        BOOST_ASSERT(! ec);
+        BOOST_ASSERT(sr.is_done());
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<
+    class Protocol, class Handler,
+    bool isRequest, class Fields>
+class write_some_posix_op
+{
+    boost::asio::basic_stream_socket<Protocol>& sock_;
+    boost::asio::executor_work_guard<decltype(std::declval<
+        boost::asio::basic_stream_socket<Protocol>&>().get_executor())> wg_;
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr_;
+    std::size_t bytes_transferred_ = 0;
+    Handler h_;
+    bool header_ = false;
+    bool wait_ = false;
+    bool offload_ = false;
+
+    // Reads the file on the body's read executor. The socket
+    // may be closed by its own thread meanwhile, so only the
+    // work guard is used to get back to the socket's executor.
+    struct prefetch_op
+    {
+        write_some_posix_op op;
+
+        void
+        operator()()
+        {
+            error_code ec;
+            sendfile_impl::prefetch(op.sr_, ec);
+            auto ex = op.wg_.get_executor();
+            boost::asio::post(ex,
+                bind_handler(std::move(op), ec, 0));
+        }
+    };
+
+public:
+    write_some_posix_op(write_some_posix_op&&) = default;
+    write_some_posix_op(write_some_posix_op const&) = delete;
+
+    template<class DeducedHandler>
+    write_some_posix_op(
+        DeducedHandler&& h,
+        boost::asio::basic_stream_socket<Protocol>& s,
+        serializer<isRequest,
+            basic_file_body<file_posix>,Fields>& sr)
+        : sock_(s)
+        , wg_(sock_.get_executor())
+        , sr_(sr)
+        , h_(std::forward<DeducedHandler>(h))
+    {
+    }
+
+    using allocator_type =
+        boost::asio::associated_allocator_t<Handler>;
+
+    allocator_type
+    get_allocator() const noexcept
+    {
+        return (boost::asio::get_associated_allocator)(h_);
+    }
+
+    using executor_type =
+        boost::asio::associated_executor_t<Handler, decltype(std::declval<
+            boost::asio::basic_stream_socket<Protocol>&>().get_executor())>;
+
+    executor_type
+    get_executor() const noexcept
+    {
+        return (boost::asio::get_associated_executor)(
+            h_, sock_.get_executor());
+    }
+
+    void
+    operator()();
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred = 0);
+
+    friend
+    bool asio_handler_is_continuation(write_some_posix_op* op)
+    {
+        using boost::asio::asio_handler_is_continuation;
+        return asio_handler_is_continuation(
+            std::addressof(op->h_));
+    }
+
+    template<class Function>
+    friend
+    void asio_handler_invoke(Function&& f, write_some_posix_op* op)
+    {
+        using boost::asio::asio_handler_invoke;
+        asio_handler_invoke(f, std::addressof(op->h_));
+    }
+
+private:
+    void
+    send(bool cont);
+
+    void
+    sent(error_code ec, std::size_t bytes_transferred, bool cont);
+};
+
+template<
+    class Protocol, class Handler,
+    bool isRequest, class Fields>
+void
+write_some_posix_op<
+    Protocol, Handler, isRequest, Fields>::
+operator()()
+{
+    if(! sr_.is_header_done())
+    {
+        header_ = true;
+        sr_.split(true);
+        return detail::async_write_some_impl(
+            sock_, sr_, std::move(*this));
+    }
+    if(sr_.get().chunked())
+    {
+        return detail::async_write_some_impl(
+            sock_, sr_, std::move(*this));
+    }
+    send(false);
+}
+
+template<
+    class Protocol, class Handler,
+    bool isRequest, class Fields>
+void
+write_some_posix_op<
+    Protocol, Handler, isRequest, Fields>::
+send(bool cont)
+{
+    error_code ec;
+    if(! sock_.native_non_blocking())
+    {
+        sock_.native_non_blocking(true, ec);
+        if(ec)
+            return boost::asio::post(
+                sock_.get_executor(),
+                bind_handler(std::move(*this), ec, 0));
+    }
+    auto ex = sr_.get().body().read_executor();
+    if(ex)
+    {
+        // A read from the file may block, so read it
+        // on a thread which may wait and send it here.
+        offload_ = true;
+        return boost::asio::post(ex,
+            prefetch_op{std::move(*this)});
+    }
+    auto const bytes_transferred = sendfile_impl::send_some(
+        sock_, sr_, sendfile_impl::next_size(sr_), ec);
+    sent(ec, bytes_transferred, cont);
+}
+
+template<
+    class Protocol, class Handler,
+    bool isRequest, class Fields>
+void
+write_some_posix_op<
+    Protocol, Handler, isRequest, Fields>::
+sent(error_code ec, std::size_t bytes_transferred, bool cont)
+{
+    if(ec == boost::asio::error::would_block)
+    {
+        wait_ = true;
+        return sock_.async_wait(
+            boost::asio::socket_base::wait_write,
+            std::move(*this));
+    }
+    if(! ec)
+        sendfile_impl::consume(sr_, bytes_transferred, ec);
+    bytes_transferred_ += bytes_transferred;
+    if(cont)
+        return h_(ec, bytes_transferred_);
+    boost::asio::post(
+        sock_.get_executor(),
+        bind_handler(std::move(*this), ec, 0));
+}
+
+template<
+    class Protocol, class Handler,
+    bool isRequest, class Fields>
+void
+write_some_posix_op<
+    Protocol, Handler, isRequest, Fields>::
+operator()(
+    error_code ec, std::size_t bytes_transferred)
+{
+    // Called when the header is written, when the socket
+    // becomes writable, or when the file was read into the
+    // page cache on the read executor.
+    if(offload_)
+    {
+        offload_ = false;
+        if(ec)
+            return sent(ec, 0, true);
+        if(! sock_.is_open())
+            return sent(boost::asio::error::operation_aborted, 0, true);
+        auto const n = sendfile_impl::send_some(
+            sock_, sr_, sendfile_impl::next_size(sr_), ec);
+        return sent(ec, n, true);
+    }
+    bytes_transferred_ += bytes_transferred;
+    if(! ec)
+    {
+        if(header_)
+        {
+            header_ = false;
+            if(! sr_.is_header_done() || sr_.get().chunked())
+                return (*this)();
+            return send(true);
+        }
+        if(wait_)
+        {
+            wait_ = false;
+            return send(true);
+        }
+    }
+    h_(ec, bytes_transferred_);
+}
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+template<class Protocol, bool isRequest, class Fields>
+std::size_t
+write_some(
+    boost::asio::basic_stream_socket<Protocol>& sock,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    error_code& ec)
+{
+    if(! sr.is_header_done())
+    {
+        sr.split(true);
+        return detail::write_some_impl(sock, sr, ec);
+    }
+    if(sr.get().chunked())
+        return detail::write_some_impl(sock, sr, ec);
+    for(;;)
+    {
+        auto const bytes_transferred =
+            detail::sendfile_impl::send_some(sock, sr,
+                detail::sendfile_impl::next_size(sr), ec);
+        if(ec == boost::asio::error::would_block &&
+            ! sock.non_blocking())
+        {
+            // The descriptor was made non-blocking by an
+            // asynchronous operation, wait as asio would.
+            sock.wait(boost::asio::socket_base::wait_write, ec);
+            if(ec)
+                return 0;
+            continue;
+        }
+        if(ec)
+            return 0;
+        detail::sendfile_impl::consume(sr, bytes_transferred, ec);
+        return bytes_transferred;
+    }
+}
+
+template<
+    class Protocol,
+    bool isRequest, class Fields,
+    class WriteHandler>
+BOOST_ASIO_INITFN_RESULT_TYPE(
+    WriteHandler, void(error_code, std::size_t))
+async_write_some(
+    boost::asio::basic_stream_socket<Protocol>& sock,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    WriteHandler&& handler)
+{
+    BOOST_BEAST_HANDLER_INIT(
+        WriteHandler, void(error_code, std::size_t));
+    detail::write_some_posix_op<
+        Protocol,
+        BOOST_ASIO_HANDLER_TYPE(WriteHandler,
+            void(error_code, std::size_t)),
+        isRequest, Fields>{
+            std::move(init.completion_handler), sock, sr}();
+    return init.result.get();
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
+
+#endif
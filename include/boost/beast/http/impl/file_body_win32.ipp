@@ -16,6 +16,7 @@
 #include <boost/beast/core/type_traits.hpp>
 #include <boost/beast/core/detail/clamp.hpp>
 #include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/detail/file_body_buffer.hpp>
 #include <boost/asio/associated_allocator.hpp>
 #include <boost/asio/associated_executor.hpp>
 #include <boost/asio/async_result.hpp>
@@ -72,6 +73,7 @@ struct basic_file_body<file_win32>
         std::uint64_t size_ = 0;    // cached file size
         std::uint64_t first_;       // starting offset of the range
         std::uint64_t last_;        // ending offset of the range
+        detail::file_body_buffer_size buffer_size_;
 
     public:
         ~value_type() = default;
@@ -91,6 +93,19 @@ struct basic_file_body<file_win32>
             return size_;
         }
 
+        std::size_t
+        buffer_size() const
+        {
+            return buffer_size_.size;
+        }
+
+        void
+        buffer_size(std::size_t size, bool adaptive = true)
+        {
+            buffer_size_.size = size;
+            buffer_size_.adaptive = adaptive;
+        }
+
         void
         close();
 
@@ -119,7 +134,7 @@ struct basic_file_body<file_win32>
 
         value_type& body_;  // The body we are reading from
         std::uint64_t pos_; // The current position in the file
-        char buf_[4096];    // Small buffer for reading
+        detail::file_body_buffer buf_;  // Buffer for reading
 
     public:
         using const_buffers_type =
@@ -136,26 +151,27 @@ struct basic_file_body<file_win32>
         {
             BOOST_ASSERT(body_.file_.is_open());
             pos_ = body_.first_;
+            buf_.reset(body_.buffer_size_);
         }
 
         boost::optional<std::pair<const_buffers_type, bool>>
         get(error_code& ec)
         {
-            std::size_t const n = (std::min)(sizeof(buf_),
-                beast::detail::clamp(body_.last_ - pos_));
-            if(n == 0)
+            auto const b = buf_.prepare(body_.last_ - pos_);
+            if(b.size() == 0)
             {
                 ec.assign(0, ec.category());
                 return boost::none;
             }
-            auto const nread = body_.file_.read(buf_, n, ec);
+            auto const nread = body_.file_.read(b.data(), b.size(), ec);
             if(ec)
                 return boost::none;
             BOOST_ASSERT(nread != 0);
             pos_ += nread;
+            buf_.commit(nread);
             ec.assign(0, ec.category());
             return {{
-                {buf_, nread},          // buffer to return.
+                {b.data(), nread},      // buffer to return.
                 pos_ < body_.last_}};   // `true` if there are more buffers.
         }
     };
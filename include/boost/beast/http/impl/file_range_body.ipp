@@ -0,0 +1,506 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_FILE_RANGE_BODY_IPP
+#define BOOST_BEAST_HTTP_IMPL_FILE_RANGE_BODY_IPP
+
+#include <boost/beast/core/detail/chacha.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/detail/rfc7230.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <random>
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+#include <mutex>
+#endif
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+
+enum class byte_ranges
+{
+    ignore,         // not a valid byte range set
+    unsatisfiable,  // no range overlaps the file
+    ok
+};
+
+// Ranges beyond this many cause the field to be ignored
+std::size_t constexpr max_byte_ranges = 64;
+
+inline
+bool
+parse_byte_pos(
+    char const*& it, char const* last,
+    std::uint64_t& n)
+{
+    if(it == last || ! is_digit(*it))
+        return false;
+    n = 0;
+    for(; it != last && is_digit(*it); ++it)
+    {
+        auto const d = static_cast<unsigned>(*it - '0');
+        if(n > ((std::numeric_limits<std::uint64_t>::max)() - d) / 10)
+            return false;
+        n = 10 * n + d;
+    }
+    return true;
+}
+
+// Parse a Range field value against a file of `size` bytes
+inline
+byte_ranges
+parse_byte_ranges(string_view s, std::uint64_t size,
+    std::vector<std::pair<std::uint64_t, std::uint64_t>>& v)
+{
+    v.clear();
+    if(s.size() < 6 || ! iequals(s.substr(0, 5), "bytes"))
+        return byte_ranges::ignore;
+    auto it = s.data() + 5;
+    auto const last = s.data() + s.size();
+    skip_ows(it, last);
+    if(it == last || *it != '=')
+        return byte_ranges::ignore;
+    ++it;
+    std::size_t count = 0;
+    for(;;)
+    {
+        skip_ows(it, last);
+        if(it == last)
+            break;
+        if(*it == ',')
+        {
+            // empty list element
+            ++it;
+            continue;
+        }
+        if(++count > max_byte_ranges)
+            return byte_ranges::ignore;
+        std::uint64_t first;
+        std::uint64_t end;
+        if(*it == '-')
+        {
+            // suffix-byte-range-spec
+            ++it;
+            std::uint64_t n;
+            if(! parse_byte_pos(it, last, n))
+                return byte_ranges::ignore;
+            if(n > 0 && size > 0)
+                v.emplace_back(n < size ? size - n : 0, size - 1);
+        }
+        else
+        {
+            // byte-range-spec
+            if(! parse_byte_pos(it, last, first))
+                return byte_ranges::ignore;
+            if(it == last || *it != '-')
+                return byte_ranges::ignore;
+            ++it;
+            if(it != last && is_digit(*it))
+            {
+                if(! parse_byte_pos(it, last, end))
+                    return byte_ranges::ignore;
+                if(end < first)
+                    return byte_ranges::ignore;
+            }
+            else
+            {
+                end = (std::numeric_limits<std::uint64_t>::max)();
+            }
+            if(first < size)
+                v.emplace_back(first, (std::min)(end, size - 1));
+        }
+        skip_ows(it, last);
+        if(it == last)
+            break;
+        if(*it != ',')
+            return byte_ranges::ignore;
+        ++it;
+    }
+    if(count == 0)
+        return byte_ranges::ignore;
+    if(v.empty())
+        return byte_ranges::unsatisfiable;
+
+    // Ranges asking for more than the whole file, such as
+    // "0-,0-,0-", would let a short request make the server
+    // send the file many times over (rfc7233 section 6.1).
+    std::uint64_t total = 0;
+    for(auto const& r : v)
+    {
+        auto const n = r.second - r.first + 1;
+        if(n > size - total)
+            return byte_ranges::ignore;
+        total += n;
+    }
+
+    // Coalesce overlapping and adjacent ranges
+    std::sort(v.begin(), v.end());
+    std::size_t j = 0;
+    for(std::size_t i = 1; i < v.size(); ++i)
+    {
+        if(v[i].first <= v[j].second + 1)
+            v[j].second = (std::max)(v[j].second, v[i].second);
+        else
+            v[++j] = v[i];
+    }
+    v.resize(j + 1);
+    return byte_ranges::ok;
+}
+
+using boundary_prng = beast::detail::chacha<20>;
+
+inline
+std::uint32_t const*
+boundary_seed()
+{
+    struct seed_data
+    {
+        std::uint32_t v[8];
+
+        seed_data()
+        {
+            std::random_device g;
+            std::seed_seq ss{
+                g(), g(), g(), g(), g(), g(), g(), g()};
+            ss.generate(v, v+8);
+        }
+    };
+    static seed_data const d;
+    return d.v;
+}
+
+// Returns a random boundary, which can't be predicted and
+// planted in the file to break the multipart framing.
+inline
+std::string
+make_boundary()
+{
+    static char constexpr alphabet[] =
+        "0123456789"
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz";
+    static std::atomic<std::uint64_t> stream{0};
+#ifndef BOOST_BEAST_NO_THREAD_LOCAL
+    thread_local boundary_prng g{boundary_seed(), stream++};
+#else
+    static std::mutex m;
+    static boundary_prng g{boundary_seed(), stream++};
+    std::lock_guard<std::mutex> lock(m);
+#endif
+    std::string s(24, ' ');
+    for(auto& c : s)
+        c = alphabet[g() % (sizeof(alphabet) - 1)];
+    return s;
+}
+
+// Returns `true` if a Content-Type was set by prepare_range
+inline
+bool
+is_multipart(string_view type)
+{
+    return type.size() >= 20 &&
+        iequals(type.substr(0, 20), "multipart/byteranges");
+}
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+template<class File>
+void
+basic_file_range_body<File>::
+value_type::
+part_header(std::size_t i, std::string& s) const
+{
+    s.clear();
+    if(i > 0)
+        s.append("\r\n");
+    s.append("--");
+    s.append(boundary_);
+    if(i == ranges_.size())
+    {
+        s.append("--\r\n");
+        return;
+    }
+    s.append("\r\n");
+    if(! type_.empty())
+    {
+        s.append("Content-Type: ");
+        s.append(type_);
+        s.append("\r\n");
+    }
+    s.append("Content-Range: bytes ");
+    s.append(std::to_string(ranges_[i].first));
+    s.push_back('-');
+    s.append(std::to_string(ranges_[i].second));
+    s.push_back('/');
+    s.append(std::to_string(file_size_));
+    s.append("\r\n\r\n");
+}
+
+template<class File>
+void
+basic_file_range_body<File>::
+value_type::
+clear()
+{
+    file_size_ = 0;
+    size_ = 0;
+    ranges_.clear();
+    boundary_.clear();
+    type_.clear();
+    whole_ = true;
+}
+
+template<class File>
+void
+basic_file_range_body<File>::
+value_type::
+close()
+{
+    error_code ignored;
+    file_.close(ignored);
+}
+
+template<class File>
+void
+basic_file_range_body<File>::
+value_type::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    close();
+    clear();
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    file_size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        file_size_ = 0;
+        return;
+    }
+    size_ = file_size_;
+}
+
+template<class File>
+void
+basic_file_range_body<File>::
+value_type::
+reset(File&& file, error_code& ec)
+{
+    close();
+    clear();
+    file_ = std::move(file);
+    file_size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        file_size_ = 0;
+        return;
+    }
+    size_ = file_size_;
+}
+
+//------------------------------------------------------------------------------
+
+template<class File>
+std::size_t
+basic_file_range_body<File>::
+writer::
+count() const
+{
+    if(body_.whole_)
+        return body_.file_size_ > 0 ? 1 : 0;
+    return body_.ranges_.size();
+}
+
+// Position the file at the start of the current range
+template<class File>
+void
+basic_file_range_body<File>::
+writer::
+start(error_code& ec)
+{
+    if(body_.whole_)
+    {
+        remain_ = body_.file_size_;
+        body_.file_.seek(0, ec);
+        return;
+    }
+    auto const& r = body_.ranges_[i_];
+    remain_ = r.second - r.first + 1;
+    body_.file_.seek(r.first, ec);
+}
+
+template<class File>
+void
+basic_file_range_body<File>::
+writer::
+init(error_code& ec)
+{
+    BOOST_ASSERT(body_.file_.is_open());
+    i_ = 0;
+    header_ = ! body_.boundary_.empty();
+    if(count() > 0)
+    {
+        start(ec);
+        return;
+    }
+    ec.assign(0, ec.category());
+}
+
+template<class File>
+auto
+basic_file_range_body<File>::
+writer::
+get(error_code& ec) ->
+    boost::optional<std::pair<const_buffers_type, bool>>
+{
+    auto const multipart = ! body_.boundary_.empty();
+    for(;;)
+    {
+        if(header_)
+        {
+            header_ = false;
+            body_.part_header(i_, hdr_);
+            ec.assign(0, ec.category());
+            return {{
+                {hdr_.data(), hdr_.size()},
+                i_ < count()}};
+        }
+        if(i_ >= count())
+        {
+            ec.assign(0, ec.category());
+            return boost::none;
+        }
+        if(remain_ > 0)
+            break;
+        // Move to the next range
+        ++i_;
+        header_ = multipart;
+        if(i_ < count())
+        {
+            start(ec);
+            if(ec)
+                return boost::none;
+        }
+    }
+    auto const b = buf_.prepare(remain_);
+    auto const nread = body_.file_.read(b.data(), b.size(), ec);
+    if(ec)
+        return boost::none;
+    if(nread == 0)
+    {
+        // The file was truncated after it was opened
+        ec = boost::asio::error::eof;
+        return boost::none;
+    }
+    remain_ -= nread;
+    buf_.commit(nread);
+    ec.assign(0, ec.category());
+    return {{
+        {b.data(), nread},
+        remain_ > 0 || multipart || i_ + 1 < count()}};
+}
+
+//------------------------------------------------------------------------------
+
+template<class File, class Fields>
+void
+prepare_range(response<basic_file_range_body<File>, Fields>& res,
+    string_view range)
+{
+    auto& body = res.body();
+    BOOST_ASSERT(body.is_open());
+
+    // Undo a previous call, which replaced the Content-Type
+    // with the multipart type and recorded the original.
+    if(! body.boundary_.empty() && detail::is_multipart(res[field::content_type]))
+    {
+        if(body.type_.empty())
+            res.erase(field::content_type);
+        else
+            res.set(field::content_type, body.type_);
+    }
+    if( res.result() == status::partial_content ||
+        res.result() == status::range_not_satisfiable)
+        res.result(status::ok);
+    res.erase(field::content_range);
+
+    res.set(field::accept_ranges, "bytes");
+    body.ranges_.clear();
+    body.boundary_.clear();
+    body.type_.clear();
+    body.whole_ = true;
+    body.size_ = body.file_size_;
+    if(range.empty())
+        return;
+    switch(detail::parse_byte_ranges(
+        range, body.file_size_, body.ranges_))
+    {
+    case detail::byte_ranges::ignore:
+        body.ranges_.clear();
+        return;
+
+    case detail::byte_ranges::unsatisfiable:
+        body.whole_ = false;
+        body.size_ = 0;
+        res.result(status::range_not_satisfiable);
+        res.set(field::content_range,
+            "bytes */" + std::to_string(body.file_size_));
+        return;
+
+    case detail::byte_ranges::ok:
+        break;
+    }
+    body.whole_ = false;
+    res.result(status::partial_content);
+    if(body.ranges_.size() == 1)
+    {
+        auto const& r = body.ranges_.front();
+        body.size_ = r.second - r.first + 1;
+        res.set(field::content_range,
+            "bytes " + std::to_string(r.first) + "-" +
+            std::to_string(r.second) + "/" +
+            std::to_string(body.file_size_));
+        return;
+    }
+    // The multipart type left by a previous call whose record
+    // was lost, such as by reopening the file, is not the type
+    // of the parts.
+    if(! detail::is_multipart(res[field::content_type]))
+        body.type_ = res[field::content_type].to_string();
+    body.boundary_ = detail::make_boundary();
+    res.set(field::content_type,
+        "multipart/byteranges; boundary=" + body.boundary_);
+    std::string s;
+    body.size_ = 0;
+    for(std::size_t i = 0; i < body.ranges_.size(); ++i)
+    {
+        auto const& r = body.ranges_[i];
+        body.part_header(i, s);
+        body.size_ += s.size() + (r.second - r.first + 1);
+    }
+    body.part_header(body.ranges_.size(), s);
+    body.size_ += s.size();
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
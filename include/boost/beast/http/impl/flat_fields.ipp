@@ -0,0 +1,1091 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_FLAT_FIELDS_IPP
+#define BOOST_BEAST_HTTP_IMPL_FLAT_FIELDS_IPP
+
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/static_string.hpp>
+#include <boost/beast/core/detail/buffers_ref.hpp>
+#include <boost/beast/http/chunk_encode.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/rfc7230.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/http/detail/rfc7230.hpp>
+#include <boost/assert.hpp>
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<class Allocator>
+class basic_flat_fields<Allocator>::writer
+{
+    using view_type = buffers_cat_view<
+        boost::asio::const_buffer,
+        boost::asio::const_buffer,
+        boost::asio::const_buffer,
+        boost::asio::const_buffer,
+        chunk_crlf>;
+
+    boost::optional<view_type> view_;
+    char buf_[13];
+
+    static
+    boost::asio::const_buffer
+    fields(basic_flat_fields const& f)
+    {
+        auto const first =
+            f.method_ + f.target_or_reason_;
+        return {f.text_ + first, f.size_ - first};
+    }
+
+public:
+    using const_buffers_type =
+        beast::detail::buffers_ref<view_type>;
+
+    writer(basic_flat_fields const& f,
+        unsigned version, verb v);
+
+    writer(basic_flat_fields const& f,
+        unsigned version, unsigned code);
+
+    writer(basic_flat_fields const& f);
+
+    const_buffers_type
+    get() const
+    {
+        return const_buffers_type(*view_);
+    }
+};
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f)
+{
+    view_.emplace(
+        boost::asio::const_buffer{nullptr, 0},
+        boost::asio::const_buffer{nullptr, 0},
+        boost::asio::const_buffer{nullptr, 0},
+        fields(f),
+        chunk_crlf());
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f,
+        unsigned version, verb v)
+{
+/*
+    request
+        "<method>"
+        " <target>"
+        " HTTP/X.Y\r\n" (11 chars)
+*/
+    string_view sv;
+    if(v == verb::unknown)
+        sv = f.get_method_impl();
+    else
+        sv = to_string(v);
+
+    // the target is stored with a leading SP
+
+    buf_[0] = ' ';
+    buf_[1] = 'H';
+    buf_[2] = 'T';
+    buf_[3] = 'T';
+    buf_[4] = 'P';
+    buf_[5] = '/';
+    buf_[6] = '0' + static_cast<char>(version / 10);
+    buf_[7] = '.';
+    buf_[8] = '0' + static_cast<char>(version % 10);
+    buf_[9] = '\r';
+    buf_[10]= '\n';
+
+    view_.emplace(
+        boost::asio::const_buffer{sv.data(), sv.size()},
+        boost::asio::const_buffer{
+            f.text_ + f.method_, f.target_or_reason_},
+        boost::asio::const_buffer{buf_, 11},
+        fields(f),
+        chunk_crlf());
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f,
+        unsigned version, unsigned code)
+{
+/*
+    response
+        "HTTP/X.Y ### " (13 chars)
+        "<reason>"
+        "\r\n"
+*/
+    buf_[0] = 'H';
+    buf_[1] = 'T';
+    buf_[2] = 'T';
+    buf_[3] = 'P';
+    buf_[4] = '/';
+    buf_[5] = '0' + static_cast<char>(version / 10);
+    buf_[6] = '.';
+    buf_[7] = '0' + static_cast<char>(version % 10);
+    buf_[8] = ' ';
+    buf_[9] = '0' + static_cast<char>(code / 100);
+    buf_[10]= '0' + static_cast<char>((code / 10) % 10);
+    buf_[11]= '0' + static_cast<char>(code % 10);
+    buf_[12]= ' ';
+
+    string_view sv = f.get_reason_impl();
+    if(sv.empty())
+        sv = obsolete_reason(static_cast<status>(code));
+
+    view_.emplace(
+        boost::asio::const_buffer{buf_, 13},
+        boost::asio::const_buffer{sv.data(), sv.size()},
+        boost::asio::const_buffer{"\r\n", 2},
+        fields(f),
+        chunk_crlf{});
+}
+
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+~basic_flat_fields()
+{
+    clear_all();
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(Allocator const& alloc) noexcept
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields&& other) noexcept
+    : boost::empty_value<Allocator>(boost::empty_init_t(),
+        std::move(other.get()))
+{
+    swap_all(other);
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields&& other, Allocator const& alloc)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    if(this->get() != other.get())
+    {
+        copy_all(other);
+        other.clear_all();
+    }
+    else
+    {
+        swap_all(other);
+    }
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields const& other)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc_traits::
+        select_on_container_copy_construction(other.get()))
+{
+    copy_all(other);
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields const& other,
+        Allocator const& alloc)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    copy_all(other);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+operator=(basic_flat_fields&& other) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value)
+      -> basic_flat_fields&
+{
+    static_assert(is_nothrow_move_assignable<Allocator>::value,
+        "Allocator must be noexcept assignable.");
+    if(this == &other)
+        return *this;
+    move_assign(other, std::integral_constant<bool,
+        alloc_traits:: propagate_on_container_move_assignment::value>{});
+    return *this;
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+operator=(basic_flat_fields const& other) ->
+    basic_flat_fields&
+{
+    if(this == &other)
+        return *this;
+    copy_assign(other, std::integral_constant<bool,
+        alloc_traits::propagate_on_container_copy_assignment::value>{});
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+// Element access
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+at(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+at(string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+operator[](field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+operator[](string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+//------------------------------------------------------------------------------
+//
+// Modifiers
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+clear()
+{
+    n_ = 0;
+    size_ = method_ + target_or_reason_;
+    mask_ = 0;
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+insert(field name, string_param const& value)
+{
+    BOOST_ASSERT(name != field::unknown);
+    insert_element(name, to_string(name),
+        static_cast<string_view>(value));
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert(string_view sname, string_param const& value)
+{
+    insert_element(string_to_field(sname), sname,
+        static_cast<string_view>(value));
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert(field name,
+    string_view sname, string_param const& value)
+{
+    insert_element(name, sname,
+        static_cast<string_view>(value));
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set(field name, string_param const& value)
+{
+    BOOST_ASSERT(name != field::unknown);
+    set_element(name, to_string(name),
+        static_cast<string_view>(value));
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set(string_view sname, string_param const& value)
+{
+    set_element(string_to_field(sname), sname,
+        static_cast<string_view>(value));
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+erase(const_iterator pos) ->
+    const_iterator
+{
+    BOOST_ASSERT(pos != end());
+    auto const i = pos - table_;
+    erase(pos, pos + 1);
+    return table_ + i;
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+erase(field name)
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const result = equal_range(name);
+    erase(result.first, result.second);
+    return result.second - result.first;
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+erase(string_view name)
+{
+    auto const result = equal_range(name);
+    erase(result.first, result.second);
+    return result.second - result.first;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields<Allocator>& other)
+{
+    swap(other, std::integral_constant<bool,
+        alloc_traits::propagate_on_container_swap::value>{});
+}
+
+template<class Allocator>
+void
+swap(
+    basic_flat_fields<Allocator>& lhs,
+    basic_flat_fields<Allocator>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+// Lookup
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+inline
+std::size_t
+basic_flat_fields<Allocator>::
+count(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const result = equal_range(name);
+    return result.second - result.first;
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+count(string_view name) const
+{
+    auto const result = equal_range(name);
+    return result.second - result.first;
+}
+
+template<class Allocator>
+inline
+auto
+basic_flat_fields<Allocator>::
+find(field name) const ->
+    const_iterator
+{
+    BOOST_ASSERT(name != field::unknown);
+    return find(name, {});
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+find(string_view name) const ->
+    const_iterator
+{
+    return find(string_to_field(name), name);
+}
+
+template<class Allocator>
+inline
+auto
+basic_flat_fields<Allocator>::
+equal_range(field name) const ->
+    std::pair<const_iterator, const_iterator>
+{
+    BOOST_ASSERT(name != field::unknown);
+    return equal_range(name, {});
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+equal_range(string_view name) const ->
+    std::pair<const_iterator, const_iterator>
+{
+    return equal_range(string_to_field(name), name);
+}
+
+//------------------------------------------------------------------------------
+
+// Fields
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_method_impl() const
+{
+    return {text_, method_};
+}
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_target_impl() const
+{
+    if(target_or_reason_ == 0)
+        return {};
+    return {
+        text_ + method_ + 1,
+        target_or_reason_ - 1};
+}
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_reason_impl() const
+{
+    return {text_ + method_, target_or_reason_};
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+get_chunked_impl() const
+{
+    auto const te = token_list{
+        (*this)[field::transfer_encoding]};
+    for(auto it = te.begin(); it != te.end();)
+    {
+        auto const next = std::next(it);
+        if(next == te.end())
+            return iequals(*it, "chunked");
+        it = next;
+    }
+    return false;
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+get_keep_alive_impl(unsigned version) const
+{
+    auto const it = find(field::connection);
+    if(version < 11)
+    {
+        if(it == end())
+            return false;
+        return token_list{
+            it->value()}.exists("keep-alive");
+    }
+    if(it == end())
+        return true;
+    return ! token_list{
+        it->value()}.exists("close");
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+has_content_length_impl() const
+{
+    return find(field::content_length) != end();
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_method_impl(string_view s)
+{
+    set_string(0, method_, {}, s);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_target_impl(string_view s)
+{
+    set_string(method_, target_or_reason_, " ", s);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_reason_impl(string_view s)
+{
+    set_string(method_, target_or_reason_, {}, s);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_chunked_impl(bool value)
+{
+    auto it = find(field::transfer_encoding);
+    if(value)
+    {
+        // append "chunked"
+        if(it == end())
+        {
+            set(field::transfer_encoding, "chunked");
+            return;
+        }
+        auto const te = token_list{it->value()};
+        for(auto itt = te.begin();;)
+        {
+            auto const next = std::next(itt);
+            if(next == te.end())
+            {
+                if(iequals(*itt, "chunked"))
+                    return; // already set
+                break;
+            }
+            itt = next;
+        }
+        static_string<max_static_buffer> buf;
+        if(it->value().size() <= buf.size() + 9)
+        {
+            buf.append(it->value().data(), it->value().size());
+            buf.append(", chunked", 9);
+            set(field::transfer_encoding, buf);
+        }
+        else
+        {
+            std::string s;
+            s.reserve(it->value().size() + 9);
+            s.append(it->value().data(), it->value().size());
+            s.append(", chunked", 9);
+            set(field::transfer_encoding, s);
+        }
+        return;
+    }
+    // filter "chunked"
+    if(it == end())
+        return;
+    try
+    {
+        static_string<max_static_buffer> buf;
+        detail::filter_token_list_last(buf, it->value(),
+            [](string_view s)
+            {
+                return iequals(s, "chunked");
+            });
+        if(! buf.empty())
+            set(field::transfer_encoding, buf);
+        else
+            erase(field::transfer_encoding);
+    }
+    catch(std::length_error const&)
+    {
+        std::string s;
+        s.reserve(it->value().size());
+        detail::filter_token_list_last(s, it->value(),
+            [](string_view s)
+            {
+                return iequals(s, "chunked");
+            });
+        if(! s.empty())
+            set(field::transfer_encoding, s);
+        else
+            erase(field::transfer_encoding);
+    }
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_content_length_impl(
+    boost::optional<std::uint64_t> const& value)
+{
+    if(! value)
+        erase(field::content_length);
+    else
+        set(field::content_length, *value);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_keep_alive_impl(
+    unsigned version, bool keep_alive)
+{
+    auto const value = (*this)[field::connection];
+    try
+    {
+        static_string<max_static_buffer> buf;
+        detail::keep_alive_impl(
+            buf, value, version, keep_alive);
+        if(buf.empty())
+            erase(field::connection);
+        else
+            set(field::connection, buf);
+    }
+    catch(std::length_error const&)
+    {
+        std::string s;
+        s.reserve(value.size());
+        detail::keep_alive_impl(
+            s, value, version, keep_alive);
+        if(s.empty())
+            erase(field::connection);
+        else
+            set(field::connection, s);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// Returns `true` if `s` refers to the text of the header, which
+// moves or goes away when the text is changed.
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+aliases(string_view s) const
+{
+    std::less<char const*> const less;
+    return
+        text_ && s.data() &&
+        ! less(s.data(), text_) &&
+        less(s.data(), text_ + size_);
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+matches(value_type const& e,
+    field name, string_view sname)
+{
+    if(name != field::unknown)
+        return e.f_ == name;
+    return e.f_ == field::unknown &&
+        iequals(e.name_string(), sname);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+find(field name, string_view sname) const ->
+    const_iterator
+{
+    if(! (mask_ & mask(name)))
+        return end();
+    for(auto it = begin(); it != end(); ++it)
+        if(matches(*it, name, sname))
+            return it;
+    return end();
+}
+
+// Fields with the same name are always adjacent
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+equal_range(field name, string_view sname) const ->
+    std::pair<const_iterator, const_iterator>
+{
+    auto const first = find(name, sname);
+    auto last = first;
+    while(last != end() && matches(*last, name, sname))
+        ++last;
+    return {first, last};
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+erase(const_iterator first, const_iterator last)
+{
+    if(first == last)
+        return;
+    auto const pos = static_cast<std::size_t>(
+        first->p_ - text_);
+    auto const n = static_cast<std::size_t>((last == end() ?
+        text_ + size_ : last->p_) - first->p_);
+    auto const i = first - table_;
+    auto const j = last - table_;
+    splice(pos, n, 0, 0);
+    std::copy(table_ + j, table_ + n_, table_ + i);
+    n_ -= j - i;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert_element(field name,
+    string_view sname, string_view value)
+{
+    if(sname.size() + 2 >
+            (std::numeric_limits<offset_type>::max)())
+        BOOST_THROW_EXCEPTION(std::length_error{
+            "field name too large"});
+    if(value.size() + 2 >
+            (std::numeric_limits<offset_type>::max)())
+        BOOST_THROW_EXCEPTION(std::length_error{
+            "field value too large"});
+    value = detail::trim(value);
+    if(aliases(sname) || aliases(value))
+    {
+        std::string const s(sname.data(), sname.size());
+        std::string const v(value.data(), value.size());
+        return insert_element(name, s, v);
+    }
+    // keep duplicate fields together
+    auto const result = equal_range(name, sname);
+    std::size_t i;
+    std::size_t pos;
+    if(result.first != result.second)
+    {
+        auto const& e = *(result.second - 1);
+        i = result.second - table_;
+        pos = static_cast<std::size_t>(e.p_ - text_) +
+            e.buffer().size();
+    }
+    else
+    {
+        i = n_;
+        pos = size_;
+    }
+    auto const off = static_cast<offset_type>(sname.size() + 2);
+    auto const len = static_cast<offset_type>(value.size());
+    auto const p = splice(pos, 0, off + len + 2, 1);
+    sname.copy(p, sname.size());
+    p[off - 2] = ':';
+    p[off - 1] = ' ';
+    value.copy(p + off, value.size());
+    p[off + len] = '\r';
+    p[off + len + 1] = '\n';
+    std::copy_backward(table_ + i,
+        table_ + n_, table_ + n_ + 1);
+    auto& e = table_[i];
+    e.p_ = p;
+    e.off_ = off;
+    e.len_ = len;
+    e.f_ = name;
+    ++n_;
+    mask_ |= mask(name);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_element(field name,
+    string_view sname, string_view value)
+{
+    if(aliases(sname) || aliases(value))
+    {
+        std::string const s(sname.data(), sname.size());
+        std::string const v(value.data(), value.size());
+        return set_element(name, s, v);
+    }
+    auto const result = equal_range(name, sname);
+    erase(result.first, result.second);
+    insert_element(name, sname, value);
+}
+
+// Replace `n` characters of the text at `pos` with `size`
+// uninitialized characters, making room in the index for
+// `fields` more elements. Returns a pointer to the new
+// characters. The elements are adjusted, but not moved.
+template<class Allocator>
+char*
+basic_flat_fields<Allocator>::
+splice(std::size_t pos, std::size_t n,
+    std::size_t size, std::size_t fields)
+{
+    BOOST_ASSERT(pos + n <= size_);
+    auto const new_size = size_ - n + size;
+    if(new_size <= reserved_ && n_ + fields <= capacity_)
+    {
+        if(size != n)
+        {
+            auto const p = text_ + pos;
+            std::memmove(p + size, p + n, size_ - pos - n);
+            for(auto it = table_ + n_; it != table_;)
+            {
+                --it;
+                if(it->p_ < p + n)
+                    break;
+                it->p_ = it->p_ - n + size;
+            }
+        }
+        size_ = new_size;
+        return text_ + pos;
+    }
+
+    // Grow geometrically, in a single allocation
+    std::size_t capacity = capacity_;
+    if(n_ + fields > capacity || capacity == 0)
+    {
+        capacity = initial_fields;
+        capacity = (std::max)(capacity, 2 * capacity_);
+        capacity = (std::max)(capacity, n_ + fields);
+    }
+    std::size_t reserved = reserved_;
+    if(new_size > reserved)
+    {
+        reserved = initial_size;
+        reserved = (std::max)(reserved, 2 * reserved_);
+        reserved = (std::max)(reserved, new_size);
+    }
+    auto const units = capacity +
+        (reserved + sizeof(value_type) - 1) / sizeof(value_type);
+    rebind_type a{this->get()};
+    auto const table = alloc_traits::allocate(a, units);
+    auto const text = reinterpret_cast<char*>(table + capacity);
+    if(size_ > 0)
+    {
+        std::memcpy(text, text_, pos);
+        std::memcpy(text + pos + size,
+            text_ + pos + n, size_ - pos - n);
+    }
+    for(std::size_t i = 0; i < n_; ++i)
+    {
+        auto& e = *::new(&table[i]) value_type(table_[i]);
+        auto const off = static_cast<std::size_t>(e.p_ - text_);
+        e.p_ = off < pos + n ? text + off : text + off - n + size;
+    }
+    if(table_)
+        alloc_traits::deallocate(a, table_,
+            capacity_ + reserved_ / sizeof(value_type));
+    table_ = table;
+    text_ = text;
+    capacity_ = capacity;
+    reserved_ = (units - capacity) * sizeof(value_type);
+    size_ = new_size;
+    return text_ + pos;
+}
+
+// Replace the `len` characters at `pos` with
+// `prefix` followed by `s`, or nothing if `s` is empty
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_string(std::size_t pos, std::size_t& len,
+    string_view prefix, string_view s)
+{
+    if(aliases(s))
+    {
+        std::string const t(s.data(), s.size());
+        return set_string(pos, len, prefix, t);
+    }
+    auto const size = s.empty() ?
+        0 : prefix.size() + s.size();
+    auto const p = splice(pos, len, size, 0);
+    if(size > 0)
+    {
+        prefix.copy(p, prefix.size());
+        s.copy(p + prefix.size(), s.size());
+    }
+    len = size;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+copy_all(basic_flat_fields const& other)
+{
+    BOOST_ASSERT(size_ == 0);
+    auto const p = splice(0, 0, other.size_, other.n_);
+    if(other.size_ > 0)
+        std::memcpy(p, other.text_, other.size_);
+    for(std::size_t i = 0; i < other.n_; ++i)
+    {
+        auto& e = *::new(&table_[i]) value_type(other.table_[i]);
+        e.p_ = text_ + (e.p_ - other.text_);
+    }
+    n_ = other.n_;
+    method_ = other.method_;
+    target_or_reason_ = other.target_or_reason_;
+    mask_ = other.mask_;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+clear_all()
+{
+    if(table_)
+    {
+        rebind_type a{this->get()};
+        alloc_traits::deallocate(a, table_,
+            capacity_ + reserved_ / sizeof(value_type));
+    }
+    table_ = nullptr;
+    text_ = nullptr;
+    n_ = 0;
+    capacity_ = 0;
+    size_ = 0;
+    reserved_ = 0;
+    method_ = 0;
+    target_or_reason_ = 0;
+    mask_ = 0;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+swap_all(basic_flat_fields& other) noexcept
+{
+    using std::swap;
+    swap(table_, other.table_);
+    swap(text_, other.text_);
+    swap(n_, other.n_);
+    swap(capacity_, other.capacity_);
+    swap(size_, other.size_);
+    swap(reserved_, other.reserved_);
+    swap(method_, other.method_);
+    swap(target_or_reason_, other.target_or_reason_);
+    swap(mask_, other.mask_);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+move_assign(basic_flat_fields& other, std::true_type)
+{
+    clear_all();
+    this->get() = std::move(other.get());
+    swap_all(other);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+move_assign(basic_flat_fields& other, std::false_type)
+{
+    clear_all();
+    if(this->get() != other.get())
+    {
+        copy_all(other);
+        other.clear_all();
+    }
+    else
+    {
+        swap_all(other);
+    }
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+copy_assign(basic_flat_fields const& other, std::true_type)
+{
+    clear_all();
+    this->get() = other.get();
+    copy_all(other);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+copy_assign(basic_flat_fields const& other, std::false_type)
+{
+    clear_all();
+    copy_all(other);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields& other, std::true_type)
+{
+    using std::swap;
+    swap(this->get(), other.get());
+    swap_all(other);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields& other, std::false_type)
+{
+    BOOST_ASSERT(this->get() == other.get());
+    swap_all(other);
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,437 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_HEADER_VIEW_PARSER_IPP
+#define BOOST_BEAST_HTTP_IMPL_HEADER_VIEW_PARSER_IPP
+
+#include <boost/assert.hpp>
+#include <cstring>
+#include <new>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Returns `true` if `value` refers to the input following
+// `name`, or `false` if the parser passed a copy of the
+// value in which obs-fold line breaks were replaced.
+inline
+bool
+is_value_in_place(string_view name, string_view value)
+{
+    auto p = name.data() + name.size() + 1; // skip ':'
+    for(;;)
+    {
+        while(*p == ' ' || *p == '\t')
+            ++p;
+        if( p[0] != '\r' || p[1] != '\n' ||
+            (p[2] != ' ' && p[2] != '\t'))
+            break;
+        // empty line followed by obs-fold
+        p += 3;
+    }
+    return p == value.data();
+}
+
+} // detail
+
+template<bool isRequest, class Allocator>
+header_view_parser<isRequest, Allocator>::
+header_view_parser()
+    : list_(rebind_type{alloc_})
+    , fold_(alloc_)
+    , pin_(alloc_)
+{
+    init();
+}
+
+template<bool isRequest, class Allocator>
+header_view_parser<isRequest, Allocator>::
+header_view_parser(Allocator const& alloc)
+    : alloc_(alloc)
+    , list_(rebind_type{alloc})
+    , fold_(alloc)
+    , pin_(alloc)
+{
+    init();
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+init()
+{
+    // Every view must refer to the same buffer
+    this->whole_header(true);
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+pin()
+{
+    BOOST_ASSERT(base_);
+    if(pinned_)
+        return;
+    auto const n = static_cast<std::size_t>(end_ - base_);
+    pin_.resize(n + fold_.size());
+    auto const p = pin_.data();
+    std::memcpy(p, base_, n);
+    if(! fold_.empty())
+        std::memcpy(p + n, fold_.data(), fold_.size());
+    auto const rebase =
+        [&](string_view s)
+        {
+            return string_view{p + (s.data() - base_), s.size()};
+        };
+    method_or_reason_ = rebase(method_or_reason_);
+    if(isRequest)
+        target_ = rebase(target_);
+    auto q = p + n;
+    for(auto& e : list_)
+    {
+        e.name_ = rebase(e.name_);
+        if(e.value_.data())
+        {
+            e.value_ = rebase(e.value_);
+            continue;
+        }
+        // unfolded value, stored after the header
+        e.value_ = {q, e.value_.size()};
+        q += e.value_.size();
+    }
+    fold_.clear();
+    base_ = p;
+    end_ = p + n;
+    pinned_ = true;
+}
+
+template<bool isRequest, class Allocator>
+verb
+header_view_parser<isRequest, Allocator>::
+method() const
+{
+    static_assert(isRequest,
+        "method requires a request");
+    return method_;
+}
+
+template<bool isRequest, class Allocator>
+string_view
+header_view_parser<isRequest, Allocator>::
+method_string() const
+{
+    static_assert(isRequest,
+        "method_string requires a request");
+    return method_or_reason_;
+}
+
+template<bool isRequest, class Allocator>
+string_view
+header_view_parser<isRequest, Allocator>::
+target() const
+{
+    static_assert(isRequest,
+        "target requires a request");
+    return target_;
+}
+
+template<bool isRequest, class Allocator>
+status
+header_view_parser<isRequest, Allocator>::
+result() const
+{
+    static_assert(! isRequest,
+        "result requires a response");
+    return int_to_status(static_cast<unsigned>(status_));
+}
+
+template<bool isRequest, class Allocator>
+unsigned
+header_view_parser<isRequest, Allocator>::
+result_int() const
+{
+    static_assert(! isRequest,
+        "result_int requires a response");
+    return static_cast<unsigned>(status_);
+}
+
+template<bool isRequest, class Allocator>
+string_view
+header_view_parser<isRequest, Allocator>::
+reason() const
+{
+    static_assert(! isRequest,
+        "reason requires a response");
+    return method_or_reason_;
+}
+
+template<bool isRequest, class Allocator>
+template<class Pred>
+auto
+header_view_parser<isRequest, Allocator>::
+find_if(Pred const& pred) const ->
+    const_iterator
+{
+    auto it = begin();
+    auto const last = end();
+    for(; it != last; ++it)
+        if(pred(*it))
+            break;
+    return it;
+}
+
+template<bool isRequest, class Allocator>
+string_view
+header_view_parser<isRequest, Allocator>::
+operator[](field name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+template<bool isRequest, class Allocator>
+string_view
+header_view_parser<isRequest, Allocator>::
+operator[](string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+template<bool isRequest, class Allocator>
+std::size_t
+header_view_parser<isRequest, Allocator>::
+count(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    std::size_t n = 0;
+    for(auto const& e : list_)
+        if(e.f_ == name)
+            ++n;
+    return n;
+}
+
+template<bool isRequest, class Allocator>
+std::size_t
+header_view_parser<isRequest, Allocator>::
+count(string_view name) const
+{
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return count(f);
+    std::size_t n = 0;
+    for(auto const& e : list_)
+        if(e.f_ == field::unknown &&
+                iequals(e.name_, name))
+            ++n;
+    return n;
+}
+
+template<bool isRequest, class Allocator>
+auto
+header_view_parser<isRequest, Allocator>::
+find(field name) const ->
+    const_iterator
+{
+    BOOST_ASSERT(name != field::unknown);
+    struct pred
+    {
+        field f;
+
+        bool
+        operator()(value_type const& e) const
+        {
+            return e.f_ == f;
+        }
+    };
+    return find_if(pred{name});
+}
+
+template<bool isRequest, class Allocator>
+auto
+header_view_parser<isRequest, Allocator>::
+find(string_view name) const ->
+    const_iterator
+{
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return find(f);
+    struct pred
+    {
+        string_view s;
+
+        bool
+        operator()(value_type const& e) const
+        {
+            return e.f_ == field::unknown &&
+                iequals(e.name_, s);
+        }
+    };
+    return find_if(pred{name});
+}
+
+template<bool isRequest, class Allocator>
+auto
+header_view_parser<isRequest, Allocator>::
+get() ->
+    header_type&
+{
+    BOOST_ASSERT(this->is_header_done());
+    if(! h_)
+    {
+        h_.emplace(alloc_);
+        materialize(*h_);
+    }
+    return *h_;
+}
+
+template<bool isRequest, class Allocator>
+auto
+header_view_parser<isRequest, Allocator>::
+release() ->
+    header_type
+{
+    header_type h{std::move(get())};
+    h_ = boost::none;
+    return h;
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+materialize(header<true, basic_fields<Allocator>>& h) const
+{
+    if(method_ != verb::unknown)
+        h.method(method_);
+    else
+        h.method_string(method_or_reason_);
+    h.target(target_);
+    h.version(version());
+    for(auto const& e : list_)
+        h.insert(e.f_, e.name_, e.value_);
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+materialize(header<false, basic_fields<Allocator>>& h) const
+{
+    h.result(result_int());
+    h.reason(method_or_reason_);
+    h.version(version());
+    for(auto const& e : list_)
+        h.insert(e.f_, e.name_, e.value_);
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+on_request_impl(
+    verb method,
+    string_view method_str,
+    string_view target,
+    int version,
+    error_code& ec)
+{
+    base_ = method_str.data();
+    end_ = target.data() + target.size();
+    method_ = method;
+    method_or_reason_ = method_str;
+    target_ = target;
+    version_ = version;
+    ec.assign(0, ec.category());
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+on_response_impl(
+    int code,
+    string_view reason,
+    int version,
+    error_code& ec)
+{
+    base_ = reason.data();
+    end_ = reason.data() + reason.size();
+    status_ = code;
+    method_or_reason_ = reason;
+    version_ = version;
+    ec.assign(0, ec.category());
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+on_field_impl(
+    field name,
+    string_view name_string,
+    string_view value,
+    error_code& ec)
+{
+    try
+    {
+        value_type e;
+        e.f_ = name;
+        e.name_ = name_string;
+        if(detail::is_value_in_place(name_string, value))
+        {
+            e.value_ = value;
+            end_ = value.data() + value.size();
+        }
+        else
+        {
+            // The value is only valid during this call,
+            // keep a copy until the header gets pinned.
+            fold_.insert(fold_.end(),
+                value.data(), value.data() + value.size());
+            e.value_ = {nullptr, value.size()};
+            end_ = name_string.data() + name_string.size();
+            folded_ = true;
+        }
+        list_.push_back(e);
+        ec.assign(0, ec.category());
+    }
+    catch(std::bad_alloc const&)
+    {
+        ec = error::bad_alloc;
+    }
+}
+
+template<bool isRequest, class Allocator>
+void
+header_view_parser<isRequest, Allocator>::
+on_header_impl(error_code& ec)
+{
+    if(folded_ || this->input_copied())
+    {
+        try
+        {
+            pin();
+        }
+        catch(std::bad_alloc const&)
+        {
+            ec = error::bad_alloc;
+            return;
+        }
+    }
+    ec.assign(0, ec.category());
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_MMAP_FILE_BODY_IPP
+#define BOOST_BEAST_HTTP_IMPL_MMAP_FILE_BODY_IPP
+
+#if BOOST_BEAST_USE_MMAP_FILE
+
+#include <boost/beast/core/detail/clamp.hpp>
+#include <boost/beast/core/detail/type_traits.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<>
+struct basic_file_body<file_mmap>
+{
+    using file_type = file_mmap;
+
+    class writer;
+    class reader;
+
+    //--------------------------------------------------------------------------
+
+    class value_type
+    {
+        friend class writer;
+        friend class reader;
+        friend struct basic_file_body<file_mmap>;
+
+        file_mmap file_;
+        std::uint64_t size_ = 0;    // cached file size
+
+    public:
+        ~value_type() = default;
+        value_type() = default;
+        value_type(value_type&& other) = default;
+        value_type& operator=(value_type&& other) = default;
+
+        bool
+        is_open() const
+        {
+            return file_.is_open();
+        }
+
+        std::uint64_t
+        size() const
+        {
+            return size_;
+        }
+
+        void
+        close();
+
+        void
+        open(char const* path, file_mode mode, error_code& ec);
+
+        void
+        reset(file_mmap&& file, error_code& ec);
+    };
+
+    //--------------------------------------------------------------------------
+
+    class writer
+    {
+        value_type& body_;  // The body we are reading from
+        std::uint64_t pos_; // The current position in the file
+        char buf_[4096];    // Small buffer for unmapped files
+
+    public:
+        using const_buffers_type =
+            boost::asio::const_buffer;
+
+        template<bool isRequest, class Fields>
+        writer(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(error_code& ec)
+        {
+            BOOST_ASSERT(body_.file_.is_open());
+            pos_ = 0;
+            body_.file_.seek(0, ec);
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>>
+        get(error_code& ec)
+        {
+            auto const mapped = body_.file_.mapped_size();
+            if(pos_ < mapped)
+            {
+                // The whole remaining mapping, without copying
+                auto const n = beast::detail::clamp(
+                    (std::min<std::uint64_t>)(body_.size_, mapped) - pos_);
+                if(n > 0)
+                {
+                    auto const p = body_.file_.data() + pos_;
+                    pos_ += n;
+                    ec.assign(0, ec.category());
+                    return {{
+                        {p, n},
+                        pos_ < body_.size_}};
+                }
+            }
+            std::size_t const n = (std::min)(sizeof(buf_),
+                beast::detail::clamp(body_.size_ - pos_));
+            if(n == 0)
+            {
+                ec.assign(0, ec.category());
+                return boost::none;
+            }
+            body_.file_.seek(pos_, ec);
+            if(ec)
+                return boost::none;
+            auto const nread = body_.file_.read(buf_, n, ec);
+            if(ec)
+                return boost::none;
+            if(nread == 0)
+            {
+                // The file was truncated after it was opened
+                ec = boost::asio::error::eof;
+                return boost::none;
+            }
+            pos_ += nread;
+            return {{
+                {buf_, nread},
+                pos_ < body_.size_}};
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    class reader
+    {
+        value_type& body_;
+
+    public:
+        template<bool isRequest, class Fields>
+        explicit
+        reader(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(boost::optional<
+            std::uint64_t> const& content_length,
+                error_code& ec)
+        {
+            BOOST_ASSERT(body_.file_.is_open());
+            if(! content_length)
+            {
+                ec.assign(0, ec.category());
+                return;
+            }
+            // Size the file up front so the body
+            // is copied directly into the mapping.
+            auto const pos = body_.file_.pos(ec);
+            if(ec)
+                return;
+            body_.file_.reserve(pos + *content_length, ec);
+            if(ec)
+                return;
+            body_.file_.seek(pos, ec);
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        put(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            std::size_t nwritten = 0;
+            for(auto buffer : beast::detail::buffers_range(buffers))
+            {
+                nwritten += body_.file_.write(
+                    buffer.data(), buffer.size(), ec);
+                if(ec)
+                    return nwritten;
+            }
+            ec.assign(0, ec.category());
+            return nwritten;
+        }
+
+        void
+        finish(error_code& ec)
+        {
+            // Drop any of the reserved size which was not written
+            body_.file_.trim(ec);
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    static
+    std::uint64_t
+    size(value_type const& body)
+    {
+        return body.size();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+inline
+void
+basic_file_body<file_mmap>::
+value_type::
+close()
+{
+    error_code ignored;
+    file_.close(ignored);
+}
+
+inline
+void
+basic_file_body<file_mmap>::
+value_type::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        return;
+    }
+}
+
+inline
+void
+basic_file_body<file_mmap>::
+value_type::
+reset(file_mmap&& file, error_code& ec)
+{
+    if(file_.is_open())
+    {
+        error_code ignored;
+        file_.close(ignored);
+    }
+    file_ = std::move(file);
+    if(file_.is_open())
+    {
+        size_ = file_.size(ec);
+        if(ec)
+        {
+            close();
+            return;
+        }
+    }
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
+
+#endif
@@ -51,6 +51,18 @@ parser(
             "moved-from parser has a body"});
 }
 
+template<bool isRequest, class Body, class Allocator>
+template<class... Args>
+parser<isRequest, Body, Allocator>::
+parser(
+    header_view_parser<isRequest, Allocator>&& other,
+    Args&&... args)
+    : base_type(std::move(other))
+    , m_(other.release(), std::forward<Args>(args)...)
+    , rd_(m_.base(), m_.body())
+{
+}
+
 } // http
 } // beast
 } // boost
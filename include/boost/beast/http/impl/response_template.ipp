@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_RESPONSE_TEMPLATE_IPP
+#define BOOST_BEAST_HTTP_IMPL_RESPONSE_TEMPLATE_IPP
+
+#include <boost/beast/core/detail/static_string.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/detail/basic_parser.hpp>
+#include <boost/assert.hpp>
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/*
+    Layout of the buffer:
+
+        [unused]        room for a longer status line
+        [first_]        "HTTP/X.Y ### <reason>\r\n"
+        [fields_]       frozen fields
+        [tail_]         "Date: <date>\r\n" (optional)
+        [date_end_]     "Content-Length: <n>\r\n" (optional)
+                        "\r\n"
+
+    The status line is written so that it ends at fields_,
+    which leaves everything after it in place when it changes.
+*/
+
+template<class Allocator>
+template<class Fields>
+basic_response_template<Allocator>::
+basic_response_template(
+    header<false, Fields> const& h,
+    Allocator const& alloc)
+    : buf_(alloc)
+    , version_(h.version())
+    , status_(h.result_int())
+{
+    auto const reason = h.reason();
+    string_view date;
+    bool has_date = false;
+    std::size_t n = 0;
+    for(auto const& f : h)
+    {
+        if(f.name() == field::content_length)
+        {
+            std::uint64_t v;
+            auto const s = f.value();
+            if(content_length_ || ! detail::basic_parser_base::
+                    parse_dec(s.begin(), s.end(), v))
+                BOOST_THROW_EXCEPTION(std::invalid_argument{
+                    "invalid Content-Length"});
+            content_length_ = v;
+        }
+        else if(f.name() == field::date)
+        {
+            if(has_date)
+                BOOST_THROW_EXCEPTION(std::invalid_argument{
+                    "invalid Date"});
+            date = f.value();
+            has_date = true;
+        }
+        else
+        {
+            n += f.name_string().size() + 2 + f.value().size() + 2;
+        }
+    }
+    // Room for this reason-phrase, or for any of the
+    // ones from obsolete_reason, which are shorter than 40
+    fields_ = 15 + (std::max<std::size_t>)(reason.size(), 40);
+    buf_.reserve(fields_ + n +
+        6 + (std::max<std::size_t>)(date.size(), 29) + 2 +
+        16 + 20 + 2 + 2);
+    buf_.resize(fields_);
+    auto const append =
+        [&](string_view s)
+        {
+            buf_.insert(buf_.end(), s.begin(), s.end());
+        };
+    for(auto const& f : h)
+    {
+        if( f.name() == field::content_length ||
+            f.name() == field::date)
+            continue;
+        append(f.name_string());
+        append(": ");
+        append(f.value());
+        append("\r\n");
+    }
+    tail_ = buf_.size();
+    if(! date.empty())
+    {
+        append("Date: ");
+        append(date);
+        append("\r\n");
+    }
+    date_end_ = buf_.size();
+    write_content_length();
+    write_status(status_, reason);
+}
+
+template<class Allocator>
+void
+basic_response_template<Allocator>::
+result(unsigned v)
+{
+    if(v > 999)
+        BOOST_THROW_EXCEPTION(
+            std::invalid_argument{
+                "invalid status-code"});
+    status_ = v;
+    write_status(v, obsolete_reason(int_to_status(v)));
+}
+
+template<class Allocator>
+void
+basic_response_template<Allocator>::
+content_length(boost::optional<std::uint64_t> const& v)
+{
+    content_length_ = v;
+    write_content_length();
+}
+
+template<class Allocator>
+string_view
+basic_response_template<Allocator>::
+date() const
+{
+    if(date_end_ == tail_)
+        return {};
+    // skip "Date: " and the trailing CRLF
+    return {buf_.data() + tail_ + 6, date_end_ - tail_ - 8};
+}
+
+template<class Allocator>
+void
+basic_response_template<Allocator>::
+date(string_view s)
+{
+    if(s == date())
+        return;
+    std::string tmp;
+    std::less<char const*> const lt;
+    if(! s.empty() && ! buf_.empty() &&
+        ! lt(s.data(), buf_.data()) &&
+        lt(s.data(), buf_.data() + buf_.size()))
+    {
+        // s refers to the buffer, which is about to change
+        tmp.assign(s.data(), s.size());
+        s = tmp;
+    }
+    buf_.resize(tail_);
+    if(! s.empty())
+    {
+        buf_.insert(buf_.end(), {'D', 'a', 't', 'e', ':', ' '});
+        buf_.insert(buf_.end(), s.begin(), s.end());
+        buf_.insert(buf_.end(), {'\r', '\n'});
+    }
+    date_end_ = buf_.size();
+    write_content_length();
+}
+
+template<class Allocator>
+void
+basic_response_template<Allocator>::
+write_status(unsigned code, string_view reason)
+{
+    // "HTTP/X.Y ### " (13 chars) "<reason>" "\r\n"
+    auto const n = 13 + reason.size() + 2;
+    BOOST_ASSERT(n <= fields_);
+    first_ = fields_ - n;
+    auto p = buf_.data() + first_;
+    p[0] = 'H';
+    p[1] = 'T';
+    p[2] = 'T';
+    p[3] = 'P';
+    p[4] = '/';
+    p[5] = '0' + static_cast<char>(version_ / 10);
+    p[6] = '.';
+    p[7] = '0' + static_cast<char>(version_ % 10);
+    p[8] = ' ';
+    p[9] = '0' + static_cast<char>(code / 100);
+    p[10]= '0' + static_cast<char>((code / 10) % 10);
+    p[11]= '0' + static_cast<char>(code % 10);
+    p[12]= ' ';
+    std::copy(reason.begin(), reason.end(), p + 13);
+    p[n - 2] = '\r';
+    p[n - 1] = '\n';
+}
+
+template<class Allocator>
+void
+basic_response_template<Allocator>::
+write_content_length()
+{
+    buf_.resize(date_end_);
+    if(content_length_)
+    {
+        char tmp[beast::detail::max_digits(sizeof(std::uint64_t))];
+        auto const last = tmp + sizeof(tmp);
+        auto const first = beast::detail::raw_to_string(
+            last, sizeof(tmp), *content_length_);
+        static char const s[] = "Content-Length: ";
+        buf_.insert(buf_.end(), s, s + sizeof(s) - 1);
+        buf_.insert(buf_.end(), first, last);
+        buf_.insert(buf_.end(), {'\r', '\n'});
+    }
+    buf_.insert(buf_.end(), {'\r', '\n'});
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
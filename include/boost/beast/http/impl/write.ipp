@@ -298,8 +298,11 @@ operator()(
         }
         for(;;)
         {
+            // Unqualified, so that overloads for particular
+            // streams and bodies are found by argument-dependent
+            // lookup, as for write_some in the synchronous loop.
             BOOST_ASIO_CORO_YIELD
-            beast::http::async_write_some(
+            async_write_some(
                 s_, sr_, std::move(*this));
             bytes_transferred_ += bytes_transferred;
             if(ec)
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_MMAP_FILE_BODY_HPP
+#define BOOST_BEAST_HTTP_MMAP_FILE_BODY_HPP
+
+#include <boost/beast/core/file_mmap.hpp>
+
+#if BOOST_BEAST_USE_MMAP_FILE
+
+#include <boost/beast/http/basic_file_body.hpp>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A message body represented by a memory-mapped file.
+
+    When serializing, the writer presents the remainder of the
+    mapped file as a single buffer, so the body is written
+    without copying it through an intermediate buffer.
+
+    When parsing, if the message has a Content-Length the file
+    is extended to hold the body and mapped, and the incoming
+    octets are copied directly into the mapping. If the body is
+    not received in full, the file is truncated to the octets
+    received when it is closed. As with @ref file_body, data
+    already in the file past the end of the body is kept.
+
+    @note The file must not be truncated while the body is being
+    serialized. Reading a mapping past the end of the file raises
+    `SIGBUS`, which cannot be reported as an error. If the file
+    shrinks while an unmapped part is being read, the writer fails
+    with `boost::asio::error::eof`.
+
+    @see file_mmap
+*/
+using mmap_file_body = basic_file_body<file_mmap>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/mmap_file_body.ipp>
+
+#endif
+
+#endif
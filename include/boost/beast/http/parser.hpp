@@ -12,6 +12,7 @@
 
 #include <boost/beast/core/detail/config.hpp>
 #include <boost/beast/http/basic_parser.hpp>
+#include <boost/beast/http/header_view_parser.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/type_traits.hpp>
 #include <boost/optional.hpp>
@@ -160,6 +161,38 @@ public:
     parser(parser<isRequest, OtherBody,
         Allocator>&& parser, Args&&... args);
 
+    /** Construct a parser from a header view parser.
+
+        This constructs a new parser which continues where a
+        @ref header_view_parser left off, usually to read the body
+        after inspecting the header. The header is materialized into
+        the message, unless it was already by calling
+        @ref header_view_parser::get, in which case any changes made
+        to it are kept. The constructed-from parser must not have any
+        parsed body octets.
+
+        @par Example
+        @code
+        request_header_view_parser<> req0;
+        ...
+        request_parser<string_body> req{std::move(req0)};
+        @endcode
+
+        If an exception is thrown, the state of the constructed-from
+        parser is undefined.
+
+        @param parser The other parser to construct from. After
+        this call returns, the constructed-from parser may only
+        be destroyed.
+
+        @param args Optional arguments forwarded to the message
+        constructor.
+    */
+    template<class... Args>
+    explicit
+    parser(header_view_parser<isRequest, Allocator>&& parser,
+        Args&&... args);
+
     /** Returns the parsed message.
 
         Depending on the parser's progress,
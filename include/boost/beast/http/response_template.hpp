@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_RESPONSE_TEMPLATE_HPP
+#define BOOST_BEAST_HTTP_RESPONSE_TEMPLATE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A response header serialized ahead of time.
+
+    This container freezes a response header into the bytes which
+    the serializer would produce for it, so that many responses
+    sharing the same fields, such as `Server` and `Content-Type`,
+    can be sent without walking and formatting the fields each
+    time. The status line, the `Content-Length` field and the `Date`
+    field are kept in slots which may be changed afterwards; all
+    other fields are frozen. Changing a slot formats only that
+    slot, and the complete header is always available as a single
+    contiguous buffer by calling @ref data.
+
+    The `Content-Length` and `Date` fields, when present in the
+    header used to construct the template, are moved to the end of
+    the serialized header, after the frozen fields.
+
+    @par Example
+    @code
+    response_header<> h;
+    h.set(field::server, "Beast");
+    h.set(field::content_type, "text/plain");
+    response_template t{h};
+    ...
+    t.result(status::ok);
+    t.content_length(body.size());
+    boost::asio::write(sock, buffers_cat(t.data(), boost::asio::buffer(body)));
+    @endcode
+
+    @par Thread Safety
+    Changing a slot modifies the template. Servers handling
+    responses on several threads should give each connection or
+    thread its own copy; copying a template costs one allocation.
+
+    @tparam Allocator The allocator to use for the serialized header.
+*/
+template<class Allocator = std::allocator<char>>
+class basic_response_template
+{
+    std::vector<char, Allocator> buf_;
+    std::size_t first_;     // start of the status line
+    std::size_t fields_;    // end of the status line
+    std::size_t tail_;      // end of the frozen fields
+    std::size_t date_end_;  // end of the Date slot
+    unsigned version_;
+    unsigned status_;
+    boost::optional<std::uint64_t> content_length_;
+
+public:
+    /// The type of buffer returned by @ref data
+    using const_buffers_type = boost::asio::const_buffer;
+
+    /// Constructor
+    basic_response_template(basic_response_template&&) = default;
+
+    /// Constructor
+    basic_response_template(basic_response_template const&) = default;
+
+    /// Assignment
+    basic_response_template& operator=(basic_response_template&&) = default;
+
+    /// Assignment
+    basic_response_template& operator=(basic_response_template const&) = default;
+
+    /** Constructor
+
+        The header is serialized into the template. The status,
+        reason and version are taken from the header, as are the
+        initial values of the `Content-Length` and `Date` slots.
+
+        @param h The header to freeze.
+
+        @param alloc The allocator to use.
+
+        @throws std::invalid_argument if the header contains more
+        than one `Content-Length` or `Date` field, or a
+        `Content-Length` which is not a number.
+    */
+    template<class Fields>
+    explicit
+    basic_response_template(
+        header<false, Fields> const& h,
+        Allocator const& alloc = Allocator{});
+
+    /// Return the HTTP-version, encoded as `major * 10 + minor`.
+    unsigned
+    version() const
+    {
+        return version_;
+    }
+
+    /// Return the status code as an integer.
+    unsigned
+    result_int() const
+    {
+        return status_;
+    }
+
+    /** Return the status code.
+
+        If the status code is not a known code, this function
+        returns @ref status::unknown.
+    */
+    status
+    result() const
+    {
+        return int_to_status(status_);
+    }
+
+    /** Set the status code.
+
+        The reason-phrase is set to the one returned by
+        @ref obsolete_reason for the new status.
+    */
+    void
+    result(status v)
+    {
+        result(static_cast<unsigned>(v));
+    }
+
+    /** Set the status code.
+
+        The reason-phrase is set to the one returned by
+        @ref obsolete_reason for the new status.
+
+        @throws std::invalid_argument if the status code
+        is greater than 999.
+    */
+    void
+    result(unsigned v);
+
+    /// Return the value of the `Content-Length` slot.
+    boost::optional<std::uint64_t>
+    content_length() const
+    {
+        return content_length_;
+    }
+
+    /** Set the value of the `Content-Length` slot.
+
+        @param v The payload size, or `boost::none` to leave
+        the `Content-Length` field out of the header.
+    */
+    void
+    content_length(boost::optional<std::uint64_t> const& v);
+
+    /// Return the value of the `Date` slot, or `""` if it is empty.
+    string_view
+    date() const;
+
+    /** Set the value of the `Date` slot.
+
+        @param s The date, which should be an IMF-fixdate. If the
+        string is empty, the `Date` field is left out of the header.
+    */
+    void
+    date(string_view s);
+
+    /** Return the serialized header.
+
+        The buffer holds the status line, every field, and the
+        empty line which ends the header. It remains valid until
+        the template is modified or destroyed.
+    */
+    const_buffers_type
+    data() const
+    {
+        return {buf_.data() + first_, buf_.size() - first_};
+    }
+
+private:
+    void
+    write_status(unsigned code, string_view reason);
+
+    void
+    write_content_length();
+};
+
+/// A response template using the default allocator
+using response_template =
+    basic_response_template<std::allocator<char>>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/response_template.ipp>
+
+#endif
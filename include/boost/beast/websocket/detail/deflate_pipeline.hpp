@@ -0,0 +1,386 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_DEFLATE_PIPELINE_HPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_DEFLATE_PIPELINE_HPP
+
+#include <boost/beast/websocket/detail/pausation.hpp>
+#include <boost/beast/websocket/detail/stream_base.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/detail/type_traits.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+#include <boost/make_unique.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+/*  Compresses the chunks of a large message on a helper executor
+
+    Each chunk is compressed by its own deflate state and ends
+    with a sync flush, so the compressed chunks concatenate into
+    one valid deflate stream. Chunks do not refer to each other,
+    which is only correct when the connection's compressor does
+    not carry context into the next message.
+
+    Up to `max_chunks` chunks are in flight at once. Chunk `i`
+    uses slot `i % max_chunks`, and a slot may be started again
+    once the chunk in it has been written. The last chunk of a
+    message still ends with the sync flush marker, which the
+    caller removes as required by RFC 7692.
+
+    A waiting operation is parked in a pausation owned by the
+    stream, never by the pipeline, so the operation and the
+    pipeline do not keep each other alive.
+*/
+class deflate_pipeline
+    : public std::enable_shared_from_this<deflate_pipeline>
+{
+public:
+    // Input bytes in each chunk except the last
+    static std::size_t constexpr chunk_size = 65536;
+
+    static std::size_t constexpr max_chunks = 4;
+
+    // Refers to every chunk, when waiting
+    static std::size_t constexpr all =
+        (std::numeric_limits<std::size_t>::max)();
+
+private:
+    struct slot
+    {
+        std::unique_ptr<std::uint8_t[]> buf;
+        std::size_t size = 0;
+        bool done = true;
+    };
+
+    // Resumes the parked operation on its executor
+    struct resumer
+    {
+        virtual ~resumer() = default;
+
+        virtual
+        void
+        resume(std::weak_ptr<deflate_pipeline> self) = 0;
+    };
+
+    template<class Executor>
+    class resumer_impl : public resumer
+    {
+        Executor ex_;
+        pausation& p_;
+
+    public:
+        resumer_impl(Executor const& ex, pausation& p)
+            : ex_(ex)
+            , p_(p)
+        {
+        }
+
+        void
+        resume(std::weak_ptr<deflate_pipeline> self) override
+        {
+            // The pausation is only touched on this executor,
+            // and not at all once the operation is destroyed.
+            auto& p = p_;
+            boost::asio::post(ex_,
+                [self, &p]
+                {
+                    auto sp = self.lock();
+                    if(sp && ! sp->detached())
+                        p.maybe_invoke();
+                });
+        }
+    };
+
+    // Compresses one chunk on the helper executor. A job which
+    // is destroyed without running fails its chunk, so that the
+    // parked operation does not wait for it forever.
+    template<class ConstBufferSequence>
+    class compress_op
+    {
+        std::shared_ptr<deflate_pipeline> self_;
+        std::size_t i_;
+        ConstBufferSequence in_;
+
+    public:
+        compress_op(compress_op&&) = default;
+
+        compress_op(
+            std::shared_ptr<deflate_pipeline> self,
+            std::size_t i,
+            ConstBufferSequence const& in)
+            : self_(std::move(self))
+            , i_(i)
+            , in_(in)
+        {
+        }
+
+        ~compress_op()
+        {
+            if(self_)
+                self_->finish(i_, nullptr, 0,
+                    boost::asio::error::operation_aborted);
+        }
+
+        void
+        operator()()
+        {
+            auto self = std::move(self_);
+            self->compress(i_, in_);
+        }
+    };
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    slot v_[max_chunks];
+    std::size_t running_ = 0;
+    std::size_t waiting_ = 0;   // chunk the parked op waits for
+    bool parked_ = false;
+    bool detached_ = false;     // the operation was destroyed
+    error_code ec_;
+    std::unique_ptr<resumer> resumer_;
+    boost::asio::executor helper_;
+    int level_;
+    int bits_;
+    int mem_level_;
+
+    bool
+    is_ready(std::size_t i) const
+    {
+        if(i == all)
+            return running_ == 0;
+        return ec_ || v_[i % max_chunks].done;
+    }
+
+    template<class ConstBufferSequence>
+    void
+    compress(std::size_t i, ConstBufferSequence const& in)
+    {
+        using boost::asio::buffer_size;
+        auto& pool = state_pool<zlib::deflate_stream>::get();
+        auto zo = pool.acquire();
+        zo->reset(level_, bits_, mem_level_,
+            zlib::Strategy::normal);
+        std::size_t size = 0;
+        std::size_t capacity =
+            zo->upper_bound(buffer_size(in)) + 64;
+        auto buf = boost::make_unique_noinit<
+            std::uint8_t[]>(capacity);
+        auto const grow =
+            [&]
+            {
+                auto p = boost::make_unique_noinit<
+                    std::uint8_t[]>(2 * capacity);
+                std::memcpy(p.get(), buf.get(), size);
+                buf = std::move(p);
+                capacity *= 2;
+            };
+        error_code ec;
+        zlib::z_params zs;
+        zs.avail_in = 0;
+        zs.next_in = nullptr;
+        for(auto b : beast::detail::buffers_range(in))
+        {
+            zs.next_in = b.data();
+            zs.avail_in = b.size();
+            while(zs.avail_in > 0)
+            {
+                if(size == capacity)
+                    grow();
+                zs.next_out = buf.get() + size;
+                zs.avail_out = capacity - size;
+                zo->write(zs, zlib::Flush::none, ec);
+                size = capacity - zs.avail_out;
+                if(ec == zlib::error::need_buffers)
+                    ec.assign(0, ec.category());
+                if(ec)
+                    break;
+            }
+            if(ec)
+                break;
+        }
+        while(! ec)
+        {
+            // Byte-align the end of the chunk
+            if(capacity - size < 16)
+                grow();
+            zs.next_out = buf.get() + size;
+            zs.avail_out = capacity - size;
+            zo->write(zs, zlib::Flush::sync, ec);
+            size = capacity - zs.avail_out;
+            if(ec == zlib::error::need_buffers)
+                ec.assign(0, ec.category());
+            if(zs.avail_out > 0)
+                break;
+        }
+        pool.release(std::move(zo));
+        finish(i, std::move(buf), size, ec);
+    }
+
+    void
+    finish(
+        std::size_t i,
+        std::unique_ptr<std::uint8_t[]> buf,
+        std::size_t size,
+        error_code ec)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            auto& s = v_[i % max_chunks];
+            s.buf = std::move(buf);
+            s.size = size;
+            s.done = true;
+            --running_;
+            if(ec && ! ec_)
+                ec_ = ec;
+            if(parked_ && is_ready(waiting_))
+            {
+                parked_ = false;
+                resumer_->resume(shared_from_this());
+                resumer_.reset();
+            }
+        }
+        cv_.notify_all();
+    }
+
+public:
+    deflate_pipeline(
+        boost::asio::executor helper,
+        int level,
+        int bits,
+        int mem_level)
+        : helper_(std::move(helper))
+        , level_(level)
+        , bits_(bits)
+        , mem_level_(mem_level)
+    {
+    }
+
+    // Start compressing chunk `i` on the helper executor.
+    // The input must remain valid until the chunk is done.
+    template<class ConstBufferSequence>
+    void
+    start(std::size_t i, ConstBufferSequence const& in)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            auto& s = v_[i % max_chunks];
+            BOOST_ASSERT(s.done);
+            s.done = false;
+            ++running_;
+        }
+        boost::asio::post(helper_,
+            compress_op<ConstBufferSequence>{
+                shared_from_this(), i, in});
+    }
+
+    // Returns `true` if chunk `i` is done or any chunk
+    // failed, or if `i` is `all` and no chunk is running.
+    bool
+    ready(std::size_t i)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return is_ready(i);
+    }
+
+    // Returns `true` if the operation was destroyed
+    bool
+    detached()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return detached_;
+    }
+
+    // Called when the operation using the pipeline is destroyed,
+    // after which a parked operation is not resumed.
+    void
+    detach()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        detached_ = true;
+        parked_ = false;
+        resumer_.reset();
+    }
+
+    // Return the first error from any chunk
+    error_code
+    error()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return ec_;
+    }
+
+    // Return the output of a chunk which is done
+    boost::asio::mutable_buffer
+    output(std::size_t i)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto& s = v_[i % max_chunks];
+        BOOST_ASSERT(s.done);
+        return {s.buf.get(), s.size};
+    }
+
+    // Block until `ready(i)` would return `true`
+    void
+    wait(std::size_t i)
+    {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock,
+            [&]
+            {
+                return is_ready(i);
+            });
+    }
+
+    // Post the handler to its associated executor, or else to
+    // `ex`, the stream's executor, once `ready(i)` would be `true`.
+    // Meanwhile the handler is parked in `p`, which belongs to
+    // the stream and is only touched on that executor.
+    template<class Executor, class Handler>
+    void
+    async_wait(std::size_t i, Executor const& ex,
+        pausation& p, Handler&& h)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if(is_ready(i))
+        {
+            boost::asio::post(ex, std::forward<Handler>(h));
+            return;
+        }
+        BOOST_ASSERT(! parked_);
+        using executor_type = boost::asio::associated_executor_t<
+            typename std::decay<Handler>::type, Executor>;
+        resumer_ = boost::make_unique<resumer_impl<executor_type>>(
+            boost::asio::get_associated_executor(h, ex), p);
+        waiting_ = i;
+        parked_ = true;
+        p.emplace(std::forward<Handler>(h));
+    }
+};
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#endif
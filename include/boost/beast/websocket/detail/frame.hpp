@@ -15,11 +15,15 @@
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
 #include <boost/beast/core/buffers_suffix.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/core/span.hpp>
 #include <boost/beast/core/static_string.hpp>
+#include <boost/beast/core/detail/type_traits.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/assert.hpp>
 #include <boost/endian/buffers.hpp>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
 
 namespace boost {
 namespace beast {
@@ -224,6 +228,180 @@ write(DynamicBuffer& db, frame_header const& fh)
         db.prepare(n), buffer(b)));
 }
 
+/*  Frame headers and payloads for several consecutive
+    frames, sent to the next layer with a single gather
+    write instead of one write per frame.
+*/
+class frame_batch
+{
+public:
+    // A frame takes at least two buffers, header and
+    // payload, so up to 32 frames fit in 64 buffers.
+    static std::size_t constexpr max_frames = 32;
+    static std::size_t constexpr max_buffers = 64;
+
+    using buffers_type =
+        span<boost::asio::const_buffer const>;
+
+private:
+    fh_buffer fb_[max_frames];
+    boost::asio::const_buffer v_[max_buffers];
+    std::size_t frames_ = 0;
+    std::size_t nv_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    // Remove all frames
+    void
+    clear()
+    {
+        frames_ = 0;
+        nv_ = 0;
+        size_ = 0;
+    }
+
+    // Returns the number of frames in the batch
+    std::size_t
+    frames() const
+    {
+        return frames_;
+    }
+
+    // Returns the number of payload bytes in the batch
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    // Returns the headers and payloads, in order
+    buffers_type
+    data() const
+    {
+        return {v_, nv_};
+    }
+
+    // Returns `true` if no more frames can be added
+    bool
+    full() const
+    {
+        return frames_ >= max_frames || nv_ + 2 > max_buffers;
+    }
+
+    /*  Determine how much of a payload fits as the next frame
+
+        Returns `false` if nothing more can be added. Otherwise,
+        `n` is reduced if needed so that the first `n` bytes of
+        the payload fit. When the batch is empty at least some
+        of a non-empty payload always fits.
+    */
+    template<class ConstBufferSequence>
+    bool
+    fits(ConstBufferSequence const& bs, std::size_t& n) const
+    {
+        if(full())
+            return false;
+        auto avail = max_buffers - nv_ - 1;
+        std::size_t total = 0;
+        for(auto b : beast::detail::buffers_range(bs))
+        {
+            if(total >= n)
+                break;
+            if(b.size() == 0)
+                continue;
+            if(avail-- == 0)
+            {
+                if(frames_ > 0)
+                    return false;
+                n = total;
+                return true;
+            }
+            total += b.size();
+        }
+        return true;
+    }
+
+    // Append a frame, the payload must fit
+    template<class ConstBufferSequence>
+    void
+    append(frame_header const& fh, ConstBufferSequence const& bs)
+    {
+        BOOST_ASSERT(frames_ < max_frames);
+        auto& fb = fb_[frames_++];
+        fb.reset();
+        write<flat_static_buffer_base>(fb, fh);
+        v_[nv_++] = fb.data();
+        for(auto b : beast::detail::buffers_range(bs))
+        {
+            if(b.size() == 0)
+                continue;
+            BOOST_ASSERT(nv_ < max_buffers);
+            v_[nv_++] = b;
+            size_ += b.size();
+        }
+    }
+};
+
+/*  The position within a sequence of messages
+    which are being written as a batch.
+*/
+template<class MessageSequence>
+class message_cursor
+{
+    using iterator = typename std::decay<decltype(std::begin(
+        std::declval<MessageSequence const&>()))>::type;
+
+public:
+    using buffers_type = typename
+        std::iterator_traits<iterator>::value_type;
+
+private:
+    iterator it_;
+    iterator end_;
+
+    void
+    load()
+    {
+        if(it_ == end_)
+            return;
+        cb = buffers_suffix<buffers_type>(*it_);
+        remain = boost::asio::buffer_size(cb);
+        first = true;
+    }
+
+public:
+    using is_mutable = std::integral_constant<bool,
+        boost::asio::is_mutable_buffer_sequence<
+            buffers_type>::value>;
+
+    buffers_suffix<buffers_type> cb;    // rest of the current message
+    std::size_t remain = 0;             // bytes left in the current message
+    bool first = true;                  // next frame starts the message
+
+    explicit
+    message_cursor(MessageSequence const& messages)
+        : it_(std::begin(messages))
+        , end_(std::end(messages))
+    {
+        load();
+    }
+
+    // Returns `true` if every message has been consumed
+    bool
+    done() const
+    {
+        return it_ == end_;
+    }
+
+    // Move on to the next message
+    void
+    next()
+    {
+        ++it_;
+        load();
+    }
+};
+
 // Read data from buffers
 // This is for ping and pong payloads
 //
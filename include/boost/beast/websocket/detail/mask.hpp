@@ -13,9 +13,11 @@
 #include <boost/beast/core/detail/config.hpp>
 #include <boost/beast/core/detail/type_traits.hpp>
 #include <boost/asio/buffer.hpp>
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <random>
 #include <type_traits>
 
@@ -47,26 +49,67 @@ rol(std::array<unsigned char, N>& v, std::size_t n)
 
 // Apply mask in place
 //
+// Bytes are processed a machine word at a time, four
+// words per iteration, which compilers turn into full
+// width SIMD (SSE2, AVX2, NEON) loads and stores.
+//
 inline
 void
 mask_inplace(boost::asio::mutable_buffer& b, prepared_key& key)
 {
-    auto n = b.size();
-    auto mask = key; // avoid aliasing
+    auto const n = b.size();
+    auto const mask = key; // avoid aliasing
     auto p = static_cast<unsigned char*>(b.data());
-    while(n >= 4)
+    std::size_t i = 0;
+
+    // Leading bytes, until p + i is word aligned
     {
-        for(int i = 0; i < 4; ++i)
-            p[i] ^= mask[i];
-        p += 4;
-        n -= 4;
+        auto const misalign = reinterpret_cast<
+            std::uintptr_t>(p) % sizeof(std::size_t);
+        auto const head = misalign == 0 ? 0 : (std::min)(
+            n, sizeof(std::size_t) - misalign);
+        for(; i < head; ++i)
+            p[i] ^= mask[i % 4];
     }
-    if(n > 0)
+
+    if(n - i >= sizeof(std::size_t))
     {
-        for(std::size_t i = 0; i < n; ++i)
-            p[i] ^= mask[i];
-        rol(key, n);
+        // Replicate the key, rotated to the current
+        // position, across the width of a word.
+        unsigned char pat[sizeof(std::size_t)];
+        for(std::size_t j = 0; j < sizeof(pat); ++j)
+            pat[j] = mask[(i + j) % 4];
+        std::size_t w;
+        std::memcpy(&w, pat, sizeof(w));
+
+        auto const xor_word =
+            [w](unsigned char* q)
+            {
+                std::size_t v;
+                std::memcpy(&v, q, sizeof(v));
+                v ^= w;
+                std::memcpy(q, &v, sizeof(v));
+            };
+        while(n - i >= 4 * sizeof(std::size_t))
+        {
+            xor_word(p + i);
+            xor_word(p + i +     sizeof(std::size_t));
+            xor_word(p + i + 2 * sizeof(std::size_t));
+            xor_word(p + i + 3 * sizeof(std::size_t));
+            i += 4 * sizeof(std::size_t);
+        }
+        while(n - i >= sizeof(std::size_t))
+        {
+            xor_word(p + i);
+            i += sizeof(std::size_t);
+        }
     }
+
+    // Trailing bytes
+    for(; i < n; ++i)
+        p[i] ^= mask[i % 4];
+    if(n % 4 != 0)
+        rol(key, n % 4);
 }
 
 // Apply mask in place
@@ -20,7 +20,9 @@
 #include <boost/beast/core/detail/integer_sequence.hpp>
 #include <boost/align/aligned_alloc.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/executor.hpp>
 #include <boost/core/exchange.hpp>
+#include <boost/make_unique.hpp>
 #include <atomic>
 #include <cstdint>
 #include <memory>
@@ -297,6 +299,147 @@ private:
 
 //------------------------------------------------------------------------------
 
+/*  A cache of write buffers released by idle streams
+
+    Streams with the idle compaction option set give their
+    write buffer back when a message is finished, and take
+    one from here when the next message starts. A bounded
+    number of buffers is kept, the rest are freed.
+*/
+class write_buffer_pool
+{
+    static std::size_t constexpr max_buffers = 16;
+
+    struct entry
+    {
+        std::unique_ptr<std::uint8_t[]> p;
+        std::size_t size = 0;
+    };
+
+    entry v_[max_buffers];
+    std::size_t n_ = 0;
+
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+    std::mutex m_;
+#endif
+
+public:
+    // Return a buffer of the given size
+    std::unique_ptr<std::uint8_t[]>
+    acquire(std::size_t size)
+    {
+        {
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+            std::lock_guard<std::mutex> lock(m_);
+#endif
+            for(auto i = n_; i-- > 0;)
+            {
+                if(v_[i].size != size)
+                    continue;
+                auto p = std::move(v_[i].p);
+                v_[i] = std::move(v_[--n_]);
+                return p;
+            }
+        }
+        return boost::make_unique_noinit<
+            std::uint8_t[]>(size);
+    }
+
+    // Give back a buffer previously acquired
+    void
+    release(std::unique_ptr<std::uint8_t[]> p, std::size_t size)
+    {
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+        std::lock_guard<std::mutex> lock(m_);
+#endif
+        if(n_ >= max_buffers)
+            return;
+        v_[n_].p = std::move(p);
+        v_[n_].size = size;
+        ++n_;
+    }
+
+    static
+    write_buffer_pool&
+    get()
+    {
+#ifndef BOOST_BEAST_NO_THREAD_LOCAL
+        thread_local write_buffer_pool pool;
+#else
+        static write_buffer_pool pool;
+#endif
+        return pool;
+    }
+};
+
+/*  A cache of compression or decompression states
+
+    When permessage-deflate is negotiated without context
+    takeover, the state for that direction is only needed
+    while a message is being transferred. The stream takes
+    a state from here when the message starts and gives it
+    back when the message ends, so the memory used for
+    compression grows with the number of threads instead of
+    the number of connections.
+*/
+template<class T>
+class state_pool
+{
+    static std::size_t constexpr max_states = 4;
+
+    std::unique_ptr<T> v_[max_states];
+    std::size_t n_ = 0;
+
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+    std::mutex m_;
+#endif
+
+public:
+    // Return a state, which must be reset before use
+    std::unique_ptr<T>
+    acquire()
+    {
+        {
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+            std::lock_guard<std::mutex> lock(m_);
+#endif
+            if(n_ > 0)
+                return std::move(v_[--n_]);
+        }
+        return boost::make_unique<T>();
+    }
+
+    // Give back a state previously acquired
+    void
+    release(std::unique_ptr<T> p)
+    {
+        if(! p)
+            return;
+#ifdef BOOST_BEAST_NO_THREAD_LOCAL
+        std::lock_guard<std::mutex> lock(m_);
+#endif
+        if(n_ >= max_states)
+            return;
+        v_[n_++] = std::move(p);
+    }
+
+    static
+    state_pool&
+    get()
+    {
+#ifndef BOOST_BEAST_NO_THREAD_LOCAL
+        thread_local state_pool pool;
+#else
+        static state_pool pool;
+#endif
+        return pool;
+    }
+};
+
+class deflate_pipeline;
+
+//------------------------------------------------------------------------------
+
 template<bool deflateSupported>
 struct stream_base : stream_prng
 {
@@ -306,8 +449,13 @@ struct stream_base : stream_prng
         // `true` if current read message is compressed
         bool rd_set = false;
 
-        zlib::deflate_stream zo;
-        zlib::inflate_stream zi;
+        int zo_bits;    // window bits for compression
+        int zi_bits;    // window bits for decompression
+
+        // These are null between messages when
+        // there is no context takeover
+        std::unique_ptr<zlib::deflate_stream> zo;
+        std::unique_ptr<zlib::inflate_stream> zi;
     };
 
     std::unique_ptr<pmd_type>   pmd_;           // pmd settings or nullptr
@@ -334,6 +482,16 @@ struct stream_base : stream_prng
         return ! rsv1; // pmd not negotiated
     }
 
+    // return the compression state, taking
+    // one from the pool if there is none
+    zlib::deflate_stream&
+    deflate_state();
+
+    // return the decompression state, taking
+    // one from the pool if there is none
+    zlib::inflate_stream&
+    inflate_state();
+
     template<class ConstBufferSequence>
     bool
     deflate(
@@ -346,6 +504,15 @@ struct stream_base : stream_prng
     void
     do_context_takeover_write(role_type role);
 
+    // return a pipeline which compresses a whole message
+    // of `size` bytes on `helper`, or null if the message
+    // should be compressed on the calling thread
+    std::shared_ptr<deflate_pipeline>
+    make_deflate_pipeline(
+        boost::asio::executor const& helper,
+        role_type role,
+        std::size_t size);
+
     void
     inflate(
         zlib::z_params& zs,
@@ -391,6 +558,15 @@ struct stream_base<false> : stream_prng
     {
     }
 
+    std::shared_ptr<deflate_pipeline>
+    make_deflate_pipeline(
+        boost::asio::executor const&,
+        role_type,
+        std::size_t)
+    {
+        return nullptr;
+    }
+
     void
     inflate(
         zlib::z_params&,
@@ -40,6 +40,21 @@ namespace websocket {
 
 namespace detail {
 
+template<>
+inline
+zlib::inflate_stream&
+stream_base<true>::
+inflate_state()
+{
+    if(! pmd_->zi)
+    {
+        pmd_->zi = state_pool<
+            zlib::inflate_stream>::get().acquire();
+        pmd_->zi->reset(pmd_->zi_bits);
+    }
+    return *pmd_->zi;
+}
+
 template<>
 inline
 void
@@ -49,7 +64,7 @@ inflate(
     zlib::Flush flush,
     error_code& ec)
 {
-    this->pmd_->zi.write(zs, flush, ec);
+    this->inflate_state().write(zs, flush, ec);
 }
 
 template<>
@@ -63,7 +78,8 @@ do_context_takeover_read(role_type role)
        (role == role_type::server &&
             pmd_config_.client_no_context_takeover))
     {
-        pmd_->zi.reset();
+        state_pool<zlib::inflate_stream>::get().release(
+            std::move(pmd_->zi));
     }
 }
 
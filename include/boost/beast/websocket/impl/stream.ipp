@@ -152,26 +152,32 @@ open_pmd(std::true_type)
         pmd_normalize(this->pmd_config_);
         this->pmd_.reset(new typename
             detail::stream_base<deflateSupported>::pmd_type);
+        bool zo_keep;
+        bool zi_keep;
         if(role_ == role_type::client)
         {
-            this->pmd_->zi.reset(
-                this->pmd_config_.server_max_window_bits);
-            this->pmd_->zo.reset(
-                this->pmd_opts_.compLevel,
-                this->pmd_config_.client_max_window_bits,
-                this->pmd_opts_.memLevel,
-                zlib::Strategy::normal);
+            this->pmd_->zi_bits =
+                this->pmd_config_.server_max_window_bits;
+            this->pmd_->zo_bits =
+                this->pmd_config_.client_max_window_bits;
+            zi_keep = ! this->pmd_config_.server_no_context_takeover;
+            zo_keep = ! this->pmd_config_.client_no_context_takeover;
         }
         else
         {
-            this->pmd_->zi.reset(
-                this->pmd_config_.client_max_window_bits);
-            this->pmd_->zo.reset(
-                this->pmd_opts_.compLevel,
-                this->pmd_config_.server_max_window_bits,
-                this->pmd_opts_.memLevel,
-                zlib::Strategy::normal);
+            this->pmd_->zi_bits =
+                this->pmd_config_.client_max_window_bits;
+            this->pmd_->zo_bits =
+                this->pmd_config_.server_max_window_bits;
+            zi_keep = ! this->pmd_config_.client_no_context_takeover;
+            zo_keep = ! this->pmd_config_.server_no_context_takeover;
         }
+        // Without context takeover the state is only
+        // taken from the pool while a message is in flight
+        if(zi_keep)
+            this->inflate_state();
+        if(zo_keep)
+            this->deflate_state();
     }
 }
 
@@ -223,8 +229,12 @@ begin_msg(std::true_type)
         if(! wr_buf_ || wr_buf_size_ != wr_buf_opt_)
         {
             wr_buf_size_ = wr_buf_opt_;
-            wr_buf_ = boost::make_unique_noinit<
-                std::uint8_t[]>(wr_buf_size_);
+            if(idle_opt_)
+                wr_buf_ = detail::write_buffer_pool::get(
+                    ).acquire(wr_buf_size_);
+            else
+                wr_buf_ = boost::make_unique_noinit<
+                    std::uint8_t[]>(wr_buf_size_);
         }
     }
     else
@@ -249,8 +259,12 @@ begin_msg(std::false_type)
         if(! wr_buf_ || wr_buf_size_ != wr_buf_opt_)
         {
             wr_buf_size_ = wr_buf_opt_;
-            wr_buf_ = boost::make_unique_noinit<
-                std::uint8_t[]>(wr_buf_size_);
+            if(idle_opt_)
+                wr_buf_ = detail::write_buffer_pool::get(
+                    ).acquire(wr_buf_size_);
+            else
+                wr_buf_ = boost::make_unique_noinit<
+                    std::uint8_t[]>(wr_buf_size_);
         }
     }
     else
@@ -260,6 +274,23 @@ begin_msg(std::false_type)
     }
 }
 
+// Called after each write operation
+template<class NextLayer, bool deflateSupported>
+inline
+void
+stream<NextLayer, deflateSupported>::
+end_msg()
+{
+    // Keep the buffers while a message is unfinished,
+    // or when a paused write is waiting to use them.
+    if(! idle_opt_ || wr_cont_ || paused_wr_)
+        return;
+    if(wr_buf_)
+        detail::write_buffer_pool::get().release(
+            std::move(wr_buf_), wr_buf_size_);
+    wr_batch_.reset();
+}
+
 template<class NextLayer, bool deflateSupported>
 std::size_t
 stream<NextLayer, deflateSupported>::
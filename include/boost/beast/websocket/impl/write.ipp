@@ -18,6 +18,7 @@
 #include <boost/beast/core/type_traits.hpp>
 #include <boost/beast/core/detail/clamp.hpp>
 #include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/websocket/detail/deflate_pipeline.hpp>
 #include <boost/beast/websocket/detail/frame.hpp>
 #include <boost/asio/associated_allocator.hpp>
 #include <boost/asio/associated_executor.hpp>
@@ -27,6 +28,7 @@
 #include <boost/asio/handler_invoke_hook.hpp>
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
+#include <boost/make_unique.hpp>
 #include <boost/throw_exception.hpp>
 #include <algorithm>
 #include <memory>
@@ -53,7 +55,7 @@ deflate(
 {
     using boost::asio::buffer;
     BOOST_ASSERT(out.size() >= 6);
-    auto& zo = this->pmd_->zo;
+    auto& zo = this->deflate_state();
     zlib::z_params zs;
     zs.avail_in = 0;
     zs.next_in = nullptr;
@@ -116,6 +118,25 @@ deflate(
     return true;
 }
 
+template<>
+inline
+zlib::deflate_stream&
+stream_base<true>::
+deflate_state()
+{
+    if(! this->pmd_->zo)
+    {
+        this->pmd_->zo = state_pool<
+            zlib::deflate_stream>::get().acquire();
+        this->pmd_->zo->reset(
+            this->pmd_opts_.compLevel,
+            this->pmd_->zo_bits,
+            this->pmd_opts_.memLevel,
+            zlib::Strategy::normal);
+    }
+    return *this->pmd_->zo;
+}
+
 template<>
 inline
 void
@@ -127,10 +148,56 @@ do_context_takeover_write(role_type role)
        (role == role_type::server &&
         this->pmd_config_.server_no_context_takeover))
     {
-        this->pmd_->zo.reset();
+        state_pool<zlib::deflate_stream>::get().release(
+            std::move(this->pmd_->zo));
     }
 }
 
+template<>
+inline
+std::shared_ptr<deflate_pipeline>
+stream_base<true>::
+make_deflate_pipeline(
+    boost::asio::executor const& helper,
+    role_type role,
+    std::size_t size)
+{
+    if(! helper || size <= deflate_pipeline::chunk_size)
+        return nullptr;
+    // Chunks are compressed without the context of the
+    // previous message, and leave none for the next one.
+    if(! ((role == role_type::client &&
+            this->pmd_config_.client_no_context_takeover) ||
+          (role == role_type::server &&
+            this->pmd_config_.server_no_context_takeover)))
+        return nullptr;
+    return std::make_shared<deflate_pipeline>(
+        helper,
+        this->pmd_opts_.compLevel,
+        this->pmd_->zo_bits,
+        this->pmd_opts_.memLevel);
+}
+
+// Mask the caller's buffers in place, used
+// when the mask in place option is set.
+//
+template<class Buffers>
+void
+mask_inplace_if(Buffers const& bs,
+    prepared_key& key, std::true_type)
+{
+    mask_inplace(bs, key);
+}
+
+template<class Buffers>
+void
+mask_inplace_if(Buffers const&,
+    prepared_key&, std::false_type)
+{
+    // Constant buffers are never masked in place
+    BOOST_ASSERT(false);
+}
+
 } // detail
 
 //------------------------------------------------------------------------------
@@ -147,9 +214,13 @@ class stream<NextLayer, deflateSupported>::write_some_op
     buffers_suffix<Buffers> cb_;
     detail::frame_header fh_;
     detail::prepared_key key_;
+    std::shared_ptr<detail::deflate_pipeline> dp_;
     std::size_t bytes_transferred_ = 0;
     std::size_t remain_;
     std::size_t in_;
+    std::size_t chunk_ = 0;     // next chunk to write
+    std::size_t started_ = 0;   // chunks started
+    std::size_t chunks_ = 0;
     int how_;
     bool fin_;
     bool more_ = false; // for ubsan
@@ -175,6 +246,14 @@ public:
     {
     }
 
+    ~write_some_op()
+    {
+        // A parked operation is destroyed with the stream,
+        // while chunks may still be compressing.
+        if(dp_)
+            dp_->detach();
+    }
+
     using allocator_type =
         boost::asio::associated_allocator_t<Handler>;
 
@@ -238,16 +317,22 @@ operator()(
     using boost::asio::buffer_copy;
     using boost::asio::buffer_size;
     using boost::asio::mutable_buffer;
+    using is_mutable = std::integral_constant<bool,
+        boost::asio::is_mutable_buffer_sequence<Buffers>::value>;
     enum
     {
         do_nomask_nofrag,
         do_nomask_frag,
         do_mask_nofrag,
         do_mask_frag,
-        do_deflate
+        do_inplace_nofrag,
+        do_inplace_frag,
+        do_deflate,
+        do_deflate_pipeline
     };
     std::size_t n;
     boost::asio::mutable_buffer b;
+    detail::deflate_pipeline* dp;
     cont_ = cont;
     BOOST_ASIO_CORO_REENTER(*this)
     {
@@ -272,6 +357,20 @@ operator()(
         if(ws_.wr_compress_)
         {
             how_ = do_deflate;
+            if(fin_ && fh_.op != detail::opcode::cont)
+            {
+                in_ = buffer_size(cb_);
+                dp_ = ws_.make_deflate_pipeline(
+                    ws_.wr_deflate_ex_, ws_.role_, in_);
+                if(dp_)
+                {
+                    how_ = do_deflate_pipeline;
+                    remain_ = in_;
+                    chunks_ = (in_ + detail::deflate_pipeline::
+                        chunk_size - 1) / detail::deflate_pipeline::
+                            chunk_size;
+                }
+            }
         }
         else if(! fh_.mask)
         {
@@ -289,6 +388,22 @@ operator()(
                     how_ = do_nomask_nofrag;
             }
         }
+        else if(ws_.wr_inplace_opt_ && is_mutable::value)
+        {
+            if(! ws_.wr_frag_)
+            {
+                how_ = do_inplace_nofrag;
+            }
+            else
+            {
+                BOOST_ASSERT(ws_.wr_buf_size_ != 0);
+                remain_ = buffer_size(cb_);
+                if(remain_ > ws_.wr_buf_size_)
+                    how_ = do_inplace_frag;
+                else
+                    how_ = do_inplace_nofrag;
+            }
+        }
         else
         {
             if(! ws_.wr_frag_)
@@ -357,50 +472,6 @@ operator()(
 
         //------------------------------------------------------------------
 
-        else if(how_ == do_nomask_frag)
-        {
-            for(;;)
-            {
-                n = clamp(remain_, ws_.wr_buf_size_);
-                fh_.len = n;
-                remain_ -= n;
-                fh_.fin = fin_ ? remain_ == 0 : false;
-                ws_.wr_fb_.reset();
-                detail::write<flat_static_buffer_base>(
-                    ws_.wr_fb_, fh_);
-                ws_.wr_cont_ = ! fin_;
-                // Send frame
-                BOOST_ASIO_CORO_YIELD
-                boost::asio::async_write(
-                    ws_.stream_, buffers_cat(
-                        ws_.wr_fb_.data(), buffers_prefix(
-                            clamp(fh_.len), cb_)),
-                                std::move(*this));
-                if(! ws_.check_ok(ec))
-                    goto upcall;
-                n = clamp(fh_.len); // because yield
-                bytes_transferred_ += n;
-                if(remain_ == 0)
-                    break;
-                cb_.consume(n);
-                fh_.op = detail::opcode::cont;
-                // Allow outgoing control frames to
-                // be sent in between message frames
-                ws_.wr_block_.unlock(this);
-                if( ws_.paused_close_.maybe_invoke() ||
-                    ws_.paused_rd_.maybe_invoke() ||
-                    ws_.paused_ping_.maybe_invoke())
-                {
-                    BOOST_ASSERT(ws_.wr_block_.is_locked());
-                    goto do_suspend;
-                }
-                ws_.wr_block_.lock(this);
-            }
-            goto upcall;
-        }
-
-        //------------------------------------------------------------------
-
         else if(how_ == do_mask_nofrag)
         {
             remain_ = buffer_size(cb_);
@@ -500,6 +571,94 @@ operator()(
 
         //------------------------------------------------------------------
 
+        else if(how_ == do_inplace_nofrag)
+        {
+            fh_.fin = fin_;
+            fh_.len = buffer_size(cb_);
+            fh_.key = ws_.create_mask();
+            detail::prepare_key(key_, fh_.key);
+            detail::mask_inplace_if(cb_, key_, is_mutable{});
+            ws_.wr_fb_.reset();
+            detail::write<flat_static_buffer_base>(
+                ws_.wr_fb_, fh_);
+            ws_.wr_cont_ = ! fin_;
+            // Send frame
+            BOOST_ASIO_CORO_YIELD
+            boost::asio::async_write(ws_.stream_,
+                buffers_cat(ws_.wr_fb_.data(), cb_),
+                    std::move(*this));
+            if(! ws_.check_ok(ec))
+                goto upcall;
+            bytes_transferred_ += clamp(fh_.len);
+            goto upcall;
+        }
+
+        //------------------------------------------------------------------
+
+        else if(how_ == do_nomask_frag || how_ == do_inplace_frag)
+        {
+            if(! ws_.wr_batch_)
+                ws_.wr_batch_ = boost::make_unique<
+                    detail::frame_batch>();
+            for(;;)
+            {
+                // Gather as many frames as fit into one write
+                ws_.wr_batch_->clear();
+                {
+                    auto cb = cb_;
+                    do
+                    {
+                        n = clamp(remain_, ws_.wr_buf_size_);
+                        if(! ws_.wr_batch_->fits(
+                                buffers_prefix(n, cb), n))
+                            break;
+                        remain_ -= n;
+                        fh_.len = n;
+                        fh_.fin = fin_ ? remain_ == 0 : false;
+                        if(fh_.mask)
+                        {
+                            fh_.key = ws_.create_mask();
+                            detail::prepare_key(key_, fh_.key);
+                            detail::mask_inplace_if(
+                                buffers_prefix(n, cb),
+                                    key_, is_mutable{});
+                        }
+                        ws_.wr_batch_->append(
+                            fh_, buffers_prefix(n, cb));
+                        cb.consume(n);
+                        fh_.op = detail::opcode::cont;
+                    }
+                    while(remain_ > 0);
+                }
+                ws_.wr_cont_ = ! fin_;
+                // Send frames
+                BOOST_ASIO_CORO_YIELD
+                boost::asio::async_write(ws_.stream_,
+                    ws_.wr_batch_->data(), std::move(*this));
+                if(! ws_.check_ok(ec))
+                    goto upcall;
+                n = ws_.wr_batch_->size(); // because yield
+                bytes_transferred_ += n;
+                if(remain_ == 0)
+                    break;
+                cb_.consume(n);
+                // Allow outgoing control frames to
+                // be sent in between message frames
+                ws_.wr_block_.unlock(this);
+                if( ws_.paused_close_.maybe_invoke() ||
+                    ws_.paused_rd_.maybe_invoke() ||
+                    ws_.paused_ping_.maybe_invoke())
+                {
+                    BOOST_ASSERT(ws_.wr_block_.is_locked());
+                    goto do_suspend;
+                }
+                ws_.wr_block_.lock(this);
+            }
+            goto upcall;
+        }
+
+        //------------------------------------------------------------------
+
         else if(how_ == do_deflate)
         {
             for(;;)
@@ -565,9 +724,93 @@ operator()(
             }
         }
 
+        //------------------------------------------------------------------
+
+        else if(how_ == do_deflate_pipeline)
+        {
+            for(;;)
+            {
+                // Keep chunks compressing ahead of the writes
+                while(started_ < chunks_ && started_ - chunk_ <
+                    detail::deflate_pipeline::max_chunks)
+                {
+                    n = clamp(remain_,
+                        detail::deflate_pipeline::chunk_size);
+                    dp_->start(started_++, buffers_prefix(n, cb_));
+                    cb_.consume(n);
+                    remain_ -= n;
+                }
+                if(! dp_->ready(chunk_))
+                {
+                    // Wait for the next chunk
+                    BOOST_ASIO_CORO_YIELD
+                    dp_->async_wait(chunk_, ws_.get_executor(),
+                        ws_.paused_deflate_, std::move(*this));
+                }
+                ec = dp_->error();
+                if(! ws_.check_ok(ec))
+                    goto upcall;
+                b = dp_->output(chunk_++);
+                fh_.fin = chunk_ == chunks_;
+                if(fh_.fin)
+                {
+                    // remove flush marker
+                    BOOST_ASSERT(b.size() >= 4);
+                    b = buffer(b.data(), b.size() - 4);
+                }
+                if(fh_.mask)
+                {
+                    fh_.key = ws_.create_mask();
+                    detail::prepare_key(key_, fh_.key);
+                    detail::mask_inplace(b, key_);
+                }
+                fh_.len = buffer_size(b);
+                ws_.wr_fb_.reset();
+                detail::write<
+                    flat_static_buffer_base>(ws_.wr_fb_, fh_);
+                ws_.wr_cont_ = ! fin_;
+                // Send frame
+                BOOST_ASIO_CORO_YIELD
+                boost::asio::async_write(ws_.stream_,
+                    buffers_cat(ws_.wr_fb_.data(), b),
+                        std::move(*this));
+                if(! ws_.check_ok(ec))
+                    goto upcall;
+                bytes_transferred_ += clamp(
+                    in_ - bytes_transferred_,
+                        detail::deflate_pipeline::chunk_size);
+                if(chunk_ == chunks_)
+                    goto upcall;
+                fh_.op = detail::opcode::cont;
+                fh_.rsv1 = false;
+                // Allow outgoing control frames to
+                // be sent in between message frames:
+                ws_.wr_block_.unlock(this);
+                if( ws_.paused_close_.maybe_invoke() ||
+                    ws_.paused_rd_.maybe_invoke() ||
+                    ws_.paused_ping_.maybe_invoke())
+                {
+                    BOOST_ASSERT(ws_.wr_block_.is_locked());
+                    goto do_suspend;
+                }
+                ws_.wr_block_.lock(this);
+            }
+        }
+
     //--------------------------------------------------------------------------
 
     upcall:
+        if(dp_ && ! dp_->ready(detail::deflate_pipeline::all))
+        {
+            // The caller's buffers are used until
+            // every started chunk is finished
+            dp = dp_.get();
+            BOOST_ASIO_CORO_YIELD
+            dp->async_wait(detail::deflate_pipeline::all,
+                ws_.get_executor(), ws_.paused_deflate_,
+                    bind_handler(std::move(*this), ec));
+        }
+        ws_.end_msg();
         ws_.wr_block_.unlock(this);
         ws_.paused_close_.maybe_invoke() ||
             ws_.paused_rd_.maybe_invoke() ||
@@ -620,6 +863,9 @@ write_some(bool fin,
     using boost::asio::buffer;
     using boost::asio::buffer_copy;
     using boost::asio::buffer_size;
+    using is_mutable = std::integral_constant<bool,
+        boost::asio::is_mutable_buffer_sequence<
+            ConstBufferSequence>::value>;
     std::size_t bytes_transferred = 0;
     ec.assign(0, ec.category());
     // Make sure the stream is open
@@ -641,7 +887,68 @@ write_some(bool fin,
         detail::opcode::cont : wr_opcode_;
     fh.mask = role_ == role_type::client;
     auto remain = buffer_size(buffers);
-    if(wr_compress_)
+    std::shared_ptr<detail::deflate_pipeline> dp;
+    if(wr_compress_ && fin && fh.op != detail::opcode::cont)
+        dp = this->make_deflate_pipeline(
+            wr_deflate_ex_, role_, remain);
+    if(dp)
+    {
+        auto const size = remain;
+        auto const chunks = (size + detail::deflate_pipeline::
+            chunk_size - 1) / detail::deflate_pipeline::chunk_size;
+        buffers_suffix<
+            ConstBufferSequence> cb{buffers};
+        std::size_t started = 0;
+        for(std::size_t i = 0; i < chunks; ++i)
+        {
+            // Keep chunks compressing ahead of the writes
+            while(started < chunks && started - i <
+                detail::deflate_pipeline::max_chunks)
+            {
+                auto const n = clamp(remain,
+                    detail::deflate_pipeline::chunk_size);
+                dp->start(started++, buffers_prefix(n, cb));
+                cb.consume(n);
+                remain -= n;
+            }
+            dp->wait(i);
+            ec = dp->error();
+            if(! check_ok(ec))
+                break;
+            auto b = dp->output(i);
+            fh.fin = i + 1 == chunks;
+            if(fh.fin)
+            {
+                // remove flush marker
+                BOOST_ASSERT(b.size() >= 4);
+                b = buffer(b.data(), b.size() - 4);
+            }
+            if(fh.mask)
+            {
+                fh.key = this->create_mask();
+                detail::prepared_key key;
+                detail::prepare_key(key, fh.key);
+                detail::mask_inplace(b, key);
+            }
+            fh.len = buffer_size(b);
+            detail::fh_buffer fh_buf;
+            detail::write<
+                flat_static_buffer_base>(fh_buf, fh);
+            wr_cont_ = false;
+            boost::asio::write(stream_,
+                buffers_cat(fh_buf.data(), b), ec);
+            if(! check_ok(ec))
+                break;
+            bytes_transferred += clamp(size - bytes_transferred,
+                detail::deflate_pipeline::chunk_size);
+            fh.op = detail::opcode::cont;
+            fh.rsv1 = false;
+        }
+        // The caller's buffers are used until
+        // every started chunk is finished
+        dp->wait(detail::deflate_pipeline::all);
+    }
+    else if(wr_compress_)
     {
         buffers_suffix<
             ConstBufferSequence> cb{buffers};
@@ -712,27 +1019,97 @@ write_some(bool fin,
             BOOST_ASSERT(wr_buf_size_ != 0);
             buffers_suffix<
                 ConstBufferSequence> cb{buffers};
+            detail::frame_batch batch;
             for(;;)
             {
-                auto const n = clamp(remain, wr_buf_size_);
-                remain -= n;
-                fh.len = n;
-                fh.fin = fin ? remain == 0 : false;
-                detail::fh_buffer fh_buf;
-                detail::write<
-                    flat_static_buffer_base>(fh_buf, fh);
+                // Gather as many frames as fit into one write
+                batch.clear();
+                {
+                    auto cb1 = cb;
+                    do
+                    {
+                        auto n = clamp(remain, wr_buf_size_);
+                        if(! batch.fits(buffers_prefix(n, cb1), n))
+                            break;
+                        remain -= n;
+                        fh.len = n;
+                        fh.fin = fin ? remain == 0 : false;
+                        batch.append(fh, buffers_prefix(n, cb1));
+                        cb1.consume(n);
+                        fh.op = detail::opcode::cont;
+                    }
+                    while(remain > 0);
+                }
                 wr_cont_ = ! fin;
-                boost::asio::write(stream_,
-                    buffers_cat(fh_buf.data(),
-                        buffers_prefix(n, cb)), ec);
+                boost::asio::write(stream_, batch.data(), ec);
                 if(! check_ok(ec))
                     return bytes_transferred;
-                bytes_transferred += n;
+                bytes_transferred += batch.size();
                 if(remain == 0)
                     break;
-                fh.op = detail::opcode::cont;
-                cb.consume(n);
+                cb.consume(batch.size());
+            }
+        }
+    }
+    else if(wr_inplace_opt_ && is_mutable::value && ! wr_frag_)
+    {
+        // mask in place, no autofrag
+        fh.fin = fin;
+        fh.len = remain;
+        fh.key = this->create_mask();
+        detail::prepared_key key;
+        detail::prepare_key(key, fh.key);
+        detail::mask_inplace_if(buffers, key, is_mutable{});
+        detail::fh_buffer fh_buf;
+        detail::write<
+            flat_static_buffer_base>(fh_buf, fh);
+        wr_cont_ = ! fin;
+        boost::asio::write(stream_,
+            buffers_cat(fh_buf.data(), buffers), ec);
+        if(! check_ok(ec))
+            return bytes_transferred;
+        bytes_transferred += remain;
+    }
+    else if(wr_inplace_opt_ && is_mutable::value)
+    {
+        // mask in place, autofrag
+        BOOST_ASSERT(wr_buf_size_ != 0);
+        buffers_suffix<
+            ConstBufferSequence> cb{buffers};
+        detail::frame_batch batch;
+        for(;;)
+        {
+            // Gather as many frames as fit into one write
+            batch.clear();
+            {
+                auto cb1 = cb;
+                do
+                {
+                    auto n = clamp(remain, wr_buf_size_);
+                    if(! batch.fits(buffers_prefix(n, cb1), n))
+                        break;
+                    remain -= n;
+                    fh.len = n;
+                    fh.fin = fin ? remain == 0 : false;
+                    fh.key = this->create_mask();
+                    detail::prepared_key key;
+                    detail::prepare_key(key, fh.key);
+                    detail::mask_inplace_if(
+                        buffers_prefix(n, cb1), key, is_mutable{});
+                    batch.append(fh, buffers_prefix(n, cb1));
+                    cb1.consume(n);
+                    fh.op = detail::opcode::cont;
+                }
+                while(remain > 0);
             }
+            wr_cont_ = ! fin;
+            boost::asio::write(stream_, batch.data(), ec);
+            if(! check_ok(ec))
+                return bytes_transferred;
+            bytes_transferred += batch.size();
+            if(remain == 0)
+                break;
+            cb.consume(batch.size());
         }
     }
     else if(! wr_frag_)
@@ -809,6 +1186,7 @@ write_some(bool fin,
             cb.consume(n);
         }
     }
+    end_msg();
     return bytes_transferred;
 }
 
@@ -890,6 +1268,383 @@ async_write(
     return init.result.get();
 }
 
+//------------------------------------------------------------------------------
+
+// Encode frames for the messages at the cursor into the
+// batch, until the batch is full or no messages remain.
+//
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence>
+void
+stream<NextLayer, deflateSupported>::
+fill_batch(
+    detail::message_cursor<MessageSequence>& mc,
+    std::size_t& bytes_used,
+    error_code& ec)
+{
+    using beast::detail::clamp;
+    using boost::asio::buffer;
+    using boost::asio::buffer_copy;
+    using boost::asio::buffer_size;
+    using is_mutable = typename
+        detail::message_cursor<MessageSequence>::is_mutable;
+    // Don't start a frame which copies its payload in less
+    // than this much of the write buffer, unless it all fits
+    auto const min_copy =
+        (std::min<std::size_t>)(256, wr_buf_size_);
+    auto& batch = *wr_batch_;
+    batch.clear();
+    bytes_used = 0;
+    std::size_t used = 0; // of the write buffer
+    detail::frame_header fh;
+    fh.rsv2 = false;
+    fh.rsv3 = false;
+    fh.mask = role_ == role_type::client;
+    ec.assign(0, ec.category());
+    while(! mc.done())
+    {
+        fh.op = mc.first ?
+            wr_opcode_ : detail::opcode::cont;
+        fh.rsv1 = mc.first && wr_compress_;
+        if(wr_compress_)
+        {
+            // compress into the write buffer
+            if(batch.full() || wr_buf_size_ - used < min_copy)
+                return;
+            auto b = buffer(
+                wr_buf_.get() + used, wr_buf_size_ - used);
+            std::size_t in;
+            auto const more =
+                this->deflate(b, mc.cb, true, in, ec);
+            if(ec)
+                return;
+            auto const n = buffer_size(b);
+            if(fh.mask)
+            {
+                fh.key = this->create_mask();
+                detail::prepared_key key;
+                detail::prepare_key(key, fh.key);
+                detail::mask_inplace(b, key);
+            }
+            fh.fin = ! more;
+            fh.len = n;
+            batch.append(fh, b);
+            used += n;
+            bytes_used += in;
+            mc.first = false;
+            if(! more)
+            {
+                this->do_context_takeover_write(role_);
+                mc.next();
+            }
+        }
+        else if(fh.mask && ! (
+            wr_inplace_opt_ && is_mutable::value))
+        {
+            // copy and mask into the write buffer
+            auto const avail = wr_buf_size_ - used;
+            if(batch.full() ||
+                (mc.remain > avail && avail < min_copy))
+                return;
+            auto const n = clamp(mc.remain, avail);
+            auto const b = buffer(wr_buf_.get() + used, n);
+            buffer_copy(b, mc.cb);
+            mc.cb.consume(n);
+            mc.remain -= n;
+            fh.key = this->create_mask();
+            detail::prepared_key key;
+            detail::prepare_key(key, fh.key);
+            detail::mask_inplace(b, key);
+            fh.fin = mc.remain == 0;
+            fh.len = n;
+            batch.append(fh, b);
+            used += n;
+            bytes_used += n;
+            mc.first = false;
+            if(fh.fin)
+                mc.next();
+        }
+        else
+        {
+            // send the caller's buffers
+            auto n = wr_frag_ ?
+                clamp(mc.remain, wr_buf_size_) : mc.remain;
+            if(! batch.fits(buffers_prefix(n, mc.cb), n))
+                return;
+            mc.remain -= n;
+            fh.fin = mc.remain == 0;
+            fh.len = n;
+            if(fh.mask)
+            {
+                fh.key = this->create_mask();
+                detail::prepared_key key;
+                detail::prepare_key(key, fh.key);
+                detail::mask_inplace_if(
+                    buffers_prefix(n, mc.cb), key, is_mutable{});
+            }
+            batch.append(fh, buffers_prefix(n, mc.cb));
+            mc.cb.consume(n);
+            bytes_used += n;
+            mc.first = false;
+            if(fh.fin)
+                mc.next();
+        }
+    }
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence, class Handler>
+class stream<NextLayer, deflateSupported>::write_batch_op
+    : public boost::asio::coroutine
+{
+    Handler h_;
+    stream<NextLayer, deflateSupported>& ws_;
+    boost::asio::executor_work_guard<decltype(std::declval<
+        stream<NextLayer, deflateSupported>&>().get_executor())> wg_;
+    detail::message_cursor<MessageSequence> mc_;
+    std::size_t bytes_transferred_ = 0;
+    std::size_t n_ = 0;
+    bool cont_ = false;
+
+public:
+    static constexpr int id = 2; // for soft_mutex
+
+    write_batch_op(write_batch_op&&) = default;
+    write_batch_op(write_batch_op const&) = delete;
+
+    template<class DeducedHandler>
+    write_batch_op(
+        DeducedHandler&& h,
+        stream<NextLayer, deflateSupported>& ws,
+        MessageSequence const& messages)
+        : h_(std::forward<DeducedHandler>(h))
+        , ws_(ws)
+        , wg_(ws_.get_executor())
+        , mc_(messages)
+    {
+    }
+
+    using allocator_type =
+        boost::asio::associated_allocator_t<Handler>;
+
+    allocator_type
+    get_allocator() const noexcept
+    {
+        return (boost::asio::get_associated_allocator)(h_);
+    }
+
+    using executor_type = boost::asio::associated_executor_t<
+        Handler, decltype(std::declval<stream<NextLayer, deflateSupported>&>().get_executor())>;
+
+    executor_type
+    get_executor() const noexcept
+    {
+        return (boost::asio::get_associated_executor)(
+            h_, ws_.get_executor());
+    }
+
+    Handler&
+    handler()
+    {
+        return h_;
+    }
+
+    void operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true);
+
+    friend
+    bool asio_handler_is_continuation(write_batch_op* op)
+    {
+        using boost::asio::asio_handler_is_continuation;
+        return op->cont_ || asio_handler_is_continuation(
+            std::addressof(op->h_));
+    }
+
+    template<class Function>
+    friend
+    void asio_handler_invoke(Function&& f, write_batch_op* op)
+    {
+        using boost::asio::asio_handler_invoke;
+        asio_handler_invoke(
+            f, std::addressof(op->h_));
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence, class Handler>
+void
+stream<NextLayer, deflateSupported>::
+write_batch_op<MessageSequence, Handler>::
+operator()(
+    error_code ec,
+    std::size_t,
+    bool cont)
+{
+    cont_ = cont;
+    BOOST_ASIO_CORO_REENTER(*this)
+    {
+        BOOST_ASSERT(! ws_.wr_cont_);
+        ws_.begin_msg();
+        if(! ws_.wr_batch_)
+            ws_.wr_batch_ = boost::make_unique<
+                detail::frame_batch>();
+
+        // Maybe suspend
+        if(ws_.wr_block_.try_lock(this))
+        {
+            // Make sure the stream is open
+            if(! ws_.check_open(ec))
+                goto upcall;
+        }
+        else
+        {
+        do_suspend:
+            // Suspend
+            BOOST_ASIO_CORO_YIELD
+            ws_.paused_wr_.emplace(std::move(*this));
+
+            // Acquire the write block
+            ws_.wr_block_.lock(this);
+
+            // Resume
+            BOOST_ASIO_CORO_YIELD
+            boost::asio::post(
+                ws_.get_executor(), std::move(*this));
+            BOOST_ASSERT(ws_.wr_block_.is_locked(this));
+
+            // Make sure the stream is open
+            if(! ws_.check_open(ec))
+                goto upcall;
+        }
+
+        while(! mc_.done())
+        {
+            // Gather as many frames as fit into one write
+            ws_.fill_batch(mc_, n_, ec);
+            if(! ws_.check_ok(ec))
+                goto upcall;
+            // Send frames
+            BOOST_ASIO_CORO_YIELD
+            boost::asio::async_write(ws_.stream_,
+                ws_.wr_batch_->data(), std::move(*this));
+            if(! ws_.check_ok(ec))
+                goto upcall;
+            bytes_transferred_ += n_;
+            if(mc_.done())
+                break;
+            // Allow outgoing control frames to
+            // be sent in between batches
+            ws_.wr_block_.unlock(this);
+            if( ws_.paused_close_.maybe_invoke() ||
+                ws_.paused_rd_.maybe_invoke() ||
+                ws_.paused_ping_.maybe_invoke())
+            {
+                BOOST_ASSERT(ws_.wr_block_.is_locked());
+                goto do_suspend;
+            }
+            ws_.wr_block_.lock(this);
+        }
+
+    upcall:
+        ws_.end_msg();
+        ws_.wr_block_.unlock(this);
+        ws_.paused_close_.maybe_invoke() ||
+            ws_.paused_rd_.maybe_invoke() ||
+            ws_.paused_ping_.maybe_invoke();
+        if(! cont_)
+        {
+            BOOST_ASIO_CORO_YIELD
+            boost::asio::post(
+                ws_.get_executor(),
+                bind_handler(std::move(*this), ec, bytes_transferred_));
+        }
+        h_(ec, bytes_transferred_);
+    }
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_batch(MessageSequence const& messages)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream requirements not met");
+    static_assert(boost::asio::is_const_buffer_sequence<
+        typename detail::message_cursor<
+            MessageSequence>::buffers_type>::value,
+                "ConstBufferSequence requirements not met");
+    error_code ec;
+    auto const bytes_transferred = write_batch(messages, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return bytes_transferred;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_batch(MessageSequence const& messages, error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream requirements not met");
+    static_assert(boost::asio::is_const_buffer_sequence<
+        typename detail::message_cursor<
+            MessageSequence>::buffers_type>::value,
+                "ConstBufferSequence requirements not met");
+    std::size_t bytes_transferred = 0;
+    ec.assign(0, ec.category());
+    // Make sure the stream is open
+    if(! check_open(ec))
+        return bytes_transferred;
+    BOOST_ASSERT(! wr_cont_);
+    begin_msg();
+    if(! wr_batch_)
+        wr_batch_ = boost::make_unique<
+            detail::frame_batch>();
+    detail::message_cursor<MessageSequence> mc(messages);
+    while(! mc.done())
+    {
+        // Gather as many frames as fit into one write
+        std::size_t n;
+        fill_batch(mc, n, ec);
+        if(! check_ok(ec))
+            return bytes_transferred;
+        boost::asio::write(stream_, wr_batch_->data(), ec);
+        if(! check_ok(ec))
+            return bytes_transferred;
+        bytes_transferred += n;
+    }
+    end_msg();
+    return bytes_transferred;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageSequence, class WriteHandler>
+BOOST_ASIO_INITFN_RESULT_TYPE(
+    WriteHandler, void(error_code, std::size_t))
+stream<NextLayer, deflateSupported>::
+async_write_batch(
+    MessageSequence const& messages, WriteHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream requirements not met");
+    static_assert(boost::asio::is_const_buffer_sequence<
+        typename detail::message_cursor<
+            MessageSequence>::buffers_type>::value,
+                "ConstBufferSequence requirements not met");
+    BOOST_BEAST_HANDLER_INIT(
+        WriteHandler, void(error_code, std::size_t));
+    write_batch_op<MessageSequence, BOOST_ASIO_HANDLER_TYPE(
+        WriteHandler, void(error_code, std::size_t))>{
+            std::move(init.completion_handler), *this, messages}(
+                {}, 0, false);
+    return init.result.get();
+}
+
 } // websocket
 } // beast
 } // boost
@@ -32,6 +32,7 @@
 #include <boost/beast/http/detail/type_traits.hpp>
 #include <boost/asio/async_result.hpp>
 #include <boost/asio/error.hpp>
+#include <boost/asio/executor.hpp>
 #include <algorithm>
 #include <cstdint>
 #include <functional>
@@ -197,6 +198,10 @@ class stream
                                 = true;
     bool                    wr_compress_    // compress current message
                                 = false;
+    bool                    wr_inplace_opt_ // mask in place option setting
+                                = false;
+    bool                    idle_opt_       // idle compaction option setting
+                                = false;
     detail::opcode          wr_opcode_      // message type
                                 = detail::opcode::text;
     std::unique_ptr<
@@ -206,9 +211,13 @@ class stream
     std::size_t             wr_buf_opt_     // write buffer size option setting
                                 = 4096;
     detail::fh_buffer       wr_fb_;         // header buffer used for writes
+    std::unique_ptr<
+        detail::frame_batch> wr_batch_;     // headers and payloads for gather writes
+    boost::asio::executor   wr_deflate_ex_; // helper executor for compression
 
     detail::pausation       paused_rd_;     // paused read op
     detail::pausation       paused_wr_;     // paused write op
+    detail::pausation       paused_deflate_;// paused write op (compression)
     detail::pausation       paused_ping_;   // paused ping op
     detail::pausation       paused_close_;  // paused close op
     detail::pausation       paused_r_rd_;   // paused read op (async read)
@@ -602,6 +611,136 @@ public:
         ctrl_cb_ = {};
     }
 
+    /** Set the mask in place option.
+
+        This controls whether or not a stream in the client role
+        may apply the WebSocket mask directly to the caller's
+        buffers, instead of copying the payload into the write
+        buffer and masking the copy. Masking in place is only
+        performed when the buffer sequence passed to a write
+        function meets the requirements of @b MutableBufferSequence;
+        constant buffer sequences are always copied.
+
+        When this option is set, the contents of mutable buffers
+        passed to any of the write functions are unspecified after
+        the call returns or the completion handler is invoked. Set
+        this only when the caller no longer needs the payload.
+
+        Masking is only performed by streams operating in the client
+        role, and never on compressed messages, for which the write
+        buffer is always used. In all other cases this setting has
+        no effect.
+
+        The default setting is `false`.
+
+        @par Example
+        Setting the mask in place option.
+        @code
+            ws.mask_in_place(true);
+        @endcode
+
+        @param value `true` if mutable payloads may be masked in place.
+    */
+    void
+    mask_in_place(bool value)
+    {
+        wr_inplace_opt_ = value;
+    }
+
+    /// Returns `true` if the mask in place option is set.
+    bool
+    mask_in_place() const
+    {
+        return wr_inplace_opt_;
+    }
+
+    /** Set the idle compaction option.
+
+        When this option is set, the stream gives back memory which
+        is only needed while a message is being transferred. After
+        each complete message is sent the write buffer is returned
+        to a pool shared by the streams on the calling thread, and
+        is taken from the pool again when the next message starts.
+
+        This reduces the memory used by a large number of mostly
+        idle connections, at the cost of extra work when a message
+        starts. The buffer used for reading frame headers is always
+        kept. When permessage-deflate is negotiated without context
+        takeover in a direction, the compression state for that
+        direction is always taken from a per-thread pool for the
+        duration of each message, regardless of this setting.
+
+        The default setting is `false`.
+
+        @par Example
+        Setting the idle compaction option.
+        @code
+            ws.idle_compaction(true);
+        @endcode
+
+        @param value `true` if memory should be released while idle.
+    */
+    void
+    idle_compaction(bool value)
+    {
+        idle_opt_ = value;
+    }
+
+    /// Returns `true` if the idle compaction option is set.
+    bool
+    idle_compaction() const
+    {
+        return idle_opt_;
+    }
+
+    /** Set the deflate executor option.
+
+        When this option is set and the permessage-deflate extension
+        is negotiated without context takeover for outgoing messages,
+        large messages are compressed on the given executor instead
+        of the stream's executor. The message is split into blocks
+        of 64 kilobytes which are compressed independently, and
+        several blocks are compressed ahead while earlier blocks
+        are being written. The output is one valid compressed message,
+        sent as one frame per block.
+
+        This only applies to a message written in full by a single
+        call to a write function, whose payload is larger than one
+        block. Other messages, and all messages on a connection which
+        keeps compression context between messages, are compressed
+        on the calling thread as usual. Blocks compress slightly
+        worse than a single stream, because no block refers to the
+        data in the block before it.
+
+        The buffers passed to the write function must remain valid
+        until the operation completes, as usual. The executor must
+        remain valid until every write which uses it completes.
+
+        By default no executor is set.
+
+        @par Example
+        Compressing large messages on a thread pool.
+        @code
+            boost::asio::thread_pool pool;
+            ws.deflate_executor(pool.get_executor());
+        @endcode
+
+        @param ex The executor to compress on, or a default
+        constructed executor to compress on the calling thread.
+    */
+    void
+    deflate_executor(boost::asio::executor ex)
+    {
+        wr_deflate_ex_ = std::move(ex);
+    }
+
+    /// Returns the deflate executor, which may be empty.
+    boost::asio::executor
+    deflate_executor() const
+    {
+        return wr_deflate_ex_;
+    }
+
     /** Set the maximum incoming message size option.
 
         Sets the largest permissible incoming message size. Message
@@ -3360,6 +3499,148 @@ public:
     async_write_some(bool fin,
         ConstBufferSequence const& buffers, WriteHandler&& handler);
 
+    /** Write a sequence of messages to the stream.
+
+        This function is used to synchronously write several complete
+        messages to the stream. The call blocks until one of the
+        following conditions is met:
+
+        @li Every message is sent.
+
+        @li An error occurs.
+
+        The frames of many messages are gathered into each call to the
+        next layer's `write_some` function, so that a large number of
+        small messages costs one write instead of one write per message.
+        When masking or compression requires a copy of the payload, the
+        frames of consecutive messages are packed into the write buffer.
+
+        The current setting of the @ref binary option controls
+        whether the message opcode is set to text or binary. A message
+        which does not fit in the remaining space of a batch may be sent
+        as more than one frame, even if the @ref auto_fragment option
+        is not set.
+
+        @param messages A sequence of messages, such as
+        `std::vector<boost::asio::const_buffer>`. Each element must meet
+        the requirements of ConstBufferSequence and holds the entire
+        payload of one message. Ownership of the underlying memory is
+        not transferred.
+
+        @return The number of bytes written from the messages.
+
+        @throws system_error Thrown on failure.
+
+        @note A message started with @ref write_some must be finished
+        before calling this function.
+
+        @par Example
+        @code
+        std::vector<boost::asio::const_buffer> v;
+        for(auto const& s : updates)
+            v.emplace_back(boost::asio::buffer(s));
+        ws.write_batch(v);
+        @endcode
+    */
+    template<class MessageSequence>
+    std::size_t
+    write_batch(MessageSequence const& messages);
+
+    /** Write a sequence of messages to the stream.
+
+        This function is used to synchronously write several complete
+        messages to the stream. The call blocks until one of the
+        following conditions is met:
+
+        @li Every message is sent.
+
+        @li An error occurs.
+
+        The frames of many messages are gathered into each call to the
+        next layer's `write_some` function, so that a large number of
+        small messages costs one write instead of one write per message.
+        When masking or compression requires a copy of the payload, the
+        frames of consecutive messages are packed into the write buffer.
+
+        The current setting of the @ref binary option controls
+        whether the message opcode is set to text or binary. A message
+        which does not fit in the remaining space of a batch may be sent
+        as more than one frame, even if the @ref auto_fragment option
+        is not set.
+
+        @param messages A sequence of messages, such as
+        `std::vector<boost::asio::const_buffer>`. Each element must meet
+        the requirements of ConstBufferSequence and holds the entire
+        payload of one message. Ownership of the underlying memory is
+        not transferred.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The number of bytes written from the messages.
+
+        @note A message started with @ref write_some must be finished
+        before calling this function.
+    */
+    template<class MessageSequence>
+    std::size_t
+    write_batch(MessageSequence const& messages, error_code& ec);
+
+    /** Start an asynchronous operation to write a sequence of messages to the stream.
+
+        This function is used to asynchronously write several complete
+        messages to the stream. The function call always returns
+        immediately. The asynchronous operation will continue until
+        one of the following conditions is true:
+
+        @li Every message is sent.
+
+        @li An error occurs.
+
+        This operation is implemented in terms of one or more calls
+        to the next layer's `async_write_some` functions, and is known
+        as a <em>composed operation</em>. The program must ensure that
+        the stream performs no other write operations (such as
+        @ref async_write, @ref async_write_some, or
+        @ref async_close).
+
+        The frames of many messages are gathered into each write to the
+        next layer, and the write block is held once for the whole
+        sequence, so that a large number of small messages costs one
+        write and one completion instead of one per message. Control
+        frames may still be sent in between batches.
+
+        The current setting of the @ref binary option controls
+        whether the message opcode is set to text or binary. A message
+        which does not fit in the remaining space of a batch may be sent
+        as more than one frame, even if the @ref auto_fragment option
+        is not set.
+
+        @param messages A sequence of messages, such as
+        `std::vector<boost::asio::const_buffer>`. Each element must meet
+        the requirements of ConstBufferSequence and holds the entire
+        payload of one message. The sequence and the memory it refers
+        to must remain valid until the completion handler is called.
+
+        @param handler Invoked when the operation completes.
+        The handler may be moved or copied as needed.
+        The equivalent function signature of the handler must be:
+        @code void handler(
+            error_code const& ec,           // Result of operation
+            std::size_t bytes_transferred   // Number of bytes written from the
+                                            // messages. If an error occurred,
+                                            // this will be less than the sum
+                                            // of the message sizes.
+        ); @endcode
+
+        @note A message started with @ref async_write_some must be
+        finished before calling this function.
+    */
+    template<class MessageSequence, class WriteHandler>
+    BOOST_ASIO_INITFN_RESULT_TYPE(
+        WriteHandler, void(error_code, std::size_t))
+    async_write_batch(MessageSequence const& messages,
+        WriteHandler&& handler);
+
 private:
     template<class, class>  class accept_op;
     template<class>         class close_op;
@@ -3370,6 +3651,7 @@ private:
     template<class>         class response_op;
     template<class, class>  class write_some_op;
     template<class, class>  class write_op;
+    template<class, class>  class write_batch_op;
 
     static void default_decorate_req(request_type&) {}
     static void default_decorate_res(response_type&) {}
@@ -3424,6 +3706,15 @@ private:
 
     void begin_msg(std::false_type);
 
+    void end_msg();
+
+    template<class MessageSequence>
+    void
+    fill_batch(
+        detail::message_cursor<MessageSequence>& mc,
+        std::size_t& bytes_used,
+        error_code& ec);
+
     std::size_t
     read_size_hint(
         std::size_t initial_size,
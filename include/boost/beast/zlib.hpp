@@ -12,6 +12,7 @@
 
 #include <boost/beast/core/detail/config.hpp>
 
+#include <boost/beast/zlib/checksum.hpp>
 #include <boost/beast/zlib/deflate_stream.hpp>
 #include <boost/beast/zlib/error.hpp>
 #include <boost/beast/zlib/inflate_stream.hpp>
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_CHECKSUM_HPP
+#define BOOST_BEAST_ZLIB_CHECKSUM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/zlib/detail/adler32.hpp>
+#include <boost/beast/zlib/detail/crc32.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+/** Update a running CRC-32 checksum.
+
+    This computes the CRC-32 used by the gzip format, and returns
+    the same values as ZLib's `crc32`. The checksum of a buffer
+    sequence is obtained by passing the result for each buffer as
+    the `crc` argument for the next one, starting from zero:
+
+    @code
+    std::uint32_t crc = 0;
+    for(auto const b : buffers)
+        crc = crc32(crc, b.data(), b.size());
+    @endcode
+
+    When the CPU supports the PCLMULQDQ instruction and the
+    compiler targets it, inputs of 64 bytes or more are folded
+    64 bytes at a time using carry-less multiplication.
+
+    @param crc The checksum of the data so far, or zero.
+
+    @param data A pointer to the bytes to add.
+
+    @param size The number of bytes to add.
+
+    @return The updated checksum.
+*/
+inline
+std::uint32_t
+crc32(std::uint32_t crc, void const* data, std::size_t size)
+{
+    return detail::crc32(crc, data, size);
+}
+
+/** Update a running Adler-32 checksum.
+
+    This computes the Adler-32 used by the zlib format, and returns
+    the same values as ZLib's `adler32`. The checksum of a buffer
+    sequence is obtained by passing the result for each buffer as
+    the `adler` argument for the next one, starting from one.
+
+    When the CPU supports SSE4.2, the sums are computed thirty-two
+    bytes at a time with vector instructions.
+
+    @param adler The checksum of the data so far, or one.
+
+    @param data A pointer to the bytes to add.
+
+    @param size The number of bytes to add.
+
+    @return The updated checksum.
+*/
+inline
+std::uint32_t
+adler32(std::uint32_t adler, void const* data, std::size_t size)
+{
+    return detail::adler32(adler, data, size);
+}
+
+} // zlib
+} // beast
+} // boost
+
+#endif
@@ -170,6 +170,51 @@ public:
         doTune(good_length, max_lazy, nice_length, max_chain);
     }
 
+    /** Set the fast hash option.
+
+        When this option is set and the CPU supports SSE4.2, strings
+        are located by hashing four bytes with the CRC32 instruction
+        instead of zlib's rolling hash of three bytes. This spreads
+        the hash chains more evenly and speeds up compression of most
+        inputs, at the cost of finding fewer matches of length three.
+
+        The output is valid deflate data but is not byte for byte
+        identical to the output of zlib. The setting is applied at
+        the start of each compressed stream, which is the first
+        write after construction or after a call to `reset`.
+
+        The default setting is `false`.
+
+        @param value `true` to use the fast hash when available.
+    */
+    void
+    fast_hash(bool value)
+    {
+        doFastHash(value);
+    }
+
+    /** Set the container format.
+
+        This selects the header and trailer written around the
+        compressed data. For `Format::zlib` and `Format::gzip` the
+        checksum is computed while the input is copied into the
+        sliding window, so the input is not read a second time.
+
+        The setting is applied at the start of each compressed
+        stream, which is the first write after construction or
+        after a call to `reset`. The trailer is written by the
+        write which returns `error::end_of_stream`.
+
+        The default setting is `Format::raw`.
+
+        @param value The format to write.
+    */
+    void
+    format(Format value)
+    {
+        doFormat(value);
+    }
+
     /** Compress input and write output.
 
         This function compresses as much data as possible, and stops when
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_DETAIL_ADLER32_HPP
+#define BOOST_BEAST_ZLIB_DETAIL_ADLER32_HPP
+
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <nmmintrin.h>
+#endif
+
+namespace boost {
+namespace beast {
+namespace zlib {
+namespace detail {
+
+/*  Adler-32 as used by the zlib format (RFC 1950).
+
+    The sums are reduced modulo 65521 once every 5552 bytes, the
+    most which can be added without overflowing 32 bits. With
+    SSE4.2 (which implies SSSE3) each 32 byte block is summed with
+    psadbw for the first sum and pmaddubsw with the weights
+    32..1 for the second, as in Chromium's zlib.
+*/
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+
+// size must be a multiple of 32
+template<class = void>
+void
+adler32_sse(
+    std::uint32_t& s1,
+    std::uint32_t& s2,
+    std::uint8_t const* p,
+    std::size_t size)
+{
+    std::size_t constexpr block = 32;
+    std::uint32_t constexpr base = 65521;
+    __m128i const tap1 = _mm_setr_epi8(
+        32, 31, 30, 29, 28, 27, 26, 25,
+        24, 23, 22, 21, 20, 19, 18, 17);
+    __m128i const tap2 = _mm_setr_epi8(
+        16, 15, 14, 13, 12, 11, 10,  9,
+         8,  7,  6,  5,  4,  3,  2,  1);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const ones = _mm_set1_epi16(1);
+
+    auto blocks = size / block;
+    while(blocks)
+    {
+        // 5552 / 32 blocks between reductions
+        std::size_t n = 173;
+        if(n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        // v_ps holds 32 * (s1 at the start of each block)
+        __m128i v_ps = _mm_setr_epi32(
+            static_cast<int>(s1 * n), 0, 0, 0);
+        __m128i v_s2 = _mm_setr_epi32(
+            static_cast<int>(s2), 0, 0, 0);
+        __m128i v_s1 = zero;
+        do
+        {
+            __m128i const b1 = _mm_loadu_si128(
+                reinterpret_cast<__m128i const*>(p));
+            __m128i const b2 = _mm_loadu_si128(
+                reinterpret_cast<__m128i const*>(p + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                _mm_maddubs_epi16(b1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                _mm_maddubs_epi16(b2, tap2), ones));
+            p += block;
+        }
+        while(--n);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        // horizontal sums
+        v_s1 = _mm_add_epi32(v_s1,
+            _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<std::uint32_t>(_mm_cvtsi128_si32(v_s1));
+        v_s2 = _mm_add_epi32(v_s2,
+            _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2,
+            _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<std::uint32_t>(_mm_cvtsi128_si32(v_s2));
+
+        s1 %= base;
+        s2 %= base;
+    }
+}
+
+#endif
+
+/*  Update a running Adler-32 with size bytes. The initial
+    value is 1, the same as zlib's adler32().
+*/
+template<class = void>
+std::uint32_t
+adler32(
+    std::uint32_t adler,
+    void const* data,
+    std::size_t size)
+{
+    std::uint32_t constexpr base = 65521;
+    std::size_t constexpr nmax = 5552;
+
+    auto p = static_cast<std::uint8_t const*>(data);
+    std::uint32_t s1 = adler & 0xffff;
+    std::uint32_t s2 = adler >> 16;
+#if ! BOOST_BEAST_NO_INTRINSICS
+    if(size >= 64 && beast::detail::get_cpu_info().sse42)
+    {
+        auto const n = size & ~std::size_t{31};
+        adler32_sse(s1, s2, p, n);
+        p += n;
+        size -= n;
+    }
+#endif
+    while(size > 0)
+    {
+        auto n = size < nmax ? size : nmax;
+        size -= n;
+        while(n--)
+        {
+            s1 += *p++;
+            s2 += s1;
+        }
+        s1 %= base;
+        s2 %= base;
+    }
+    return (s2 << 16) | s1;
+}
+
+} // detail
+} // zlib
+} // beast
+} // boost
+
+#endif
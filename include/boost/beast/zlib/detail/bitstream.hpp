@@ -38,9 +38,21 @@
 #define BOOST_BEAST_ZLIB_DETAIL_BITSTREAM_HPP
 
 #include <boost/assert.hpp>
+#include <boost/config.hpp>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 
+// Set this to 0 to use a 32-bit bit buffer on 64-bit targets
+#ifndef BOOST_BEAST_ZLIB_WIDE_BITSTREAM
+# if defined(__x86_64__) || defined(_M_X64) || \
+     defined(__aarch64__) || defined(_M_ARM64)
+#  define BOOST_BEAST_ZLIB_WIDE_BITSTREAM 1
+# else
+#  define BOOST_BEAST_ZLIB_WIDE_BITSTREAM 0
+# endif
+#endif
+
 namespace boost {
 namespace beast {
 namespace zlib {
@@ -48,7 +60,11 @@ namespace detail {
 
 class bitstream
 {
+#if BOOST_BEAST_ZLIB_WIDE_BITSTREAM
+    using value_type = std::uint64_t;
+#else
     using value_type = std::uint32_t;
+#endif
 
     value_type v_ = 0;
     unsigned n_ = 0;
@@ -100,6 +116,13 @@ public:
     void
     fill_16(FwdIt& it);
 
+#if BOOST_BEAST_ZLIB_WIDE_BITSTREAM
+    // fill at least 56 bits from the next 8 bytes, unchecked.
+    // Bits above size() may hold input until the next rewind.
+    void
+    fill_56(std::uint8_t const*& it);
+#endif
+
     // return n bits
     template<class Unsigned>
     void
@@ -161,6 +184,31 @@ fill_16(FwdIt& it)
     n_ += 8;
 }
 
+#if BOOST_BEAST_ZLIB_WIDE_BITSTREAM
+inline
+void
+bitstream::
+fill_56(std::uint8_t const*& it)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || \
+    defined(_M_X64) || defined(_M_ARM64)
+    // Whole bytes are counted, and the partial byte
+    // which lands above them is loaded again next time
+    value_type v;
+    std::memcpy(&v, it, sizeof(v));
+    v_ |= v << n_;
+    it += (63 - n_) >> 3;
+    n_ |= 56;
+#else
+    while(n_ < 56)
+    {
+        v_ += static_cast<value_type>(*it++) << n_;
+        n_ += 8;
+    }
+#endif
+}
+#endif
+
 template<class Unsigned>
 inline
 void
@@ -196,7 +244,7 @@ rewind(BidirIt& it)
     auto len = n_ >> 3;
     it = std::prev(it, len);
     n_ &= 7;
-    v_ &= (1U << n_) - 1;
+    v_ &= (1U << n_) - 1; // also clears bits left by fill_56
 }
 
 } // detail
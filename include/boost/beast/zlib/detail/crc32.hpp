@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_DETAIL_CRC32_HPP
+#define BOOST_BEAST_ZLIB_DETAIL_CRC32_HPP
+
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef BOOST_BEAST_ZLIB_NO_PCLMUL
+# if ! BOOST_BEAST_NO_INTRINSICS && (defined(BOOST_MSVC) || defined(__PCLMUL__))
+#  define BOOST_BEAST_ZLIB_NO_PCLMUL 0
+# else
+#  define BOOST_BEAST_ZLIB_NO_PCLMUL 1
+# endif
+#endif
+
+#if ! BOOST_BEAST_ZLIB_NO_PCLMUL
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+namespace boost {
+namespace beast {
+namespace zlib {
+namespace detail {
+
+/*  CRC-32 as used by gzip (ISO 3309, reflected polynomial 0xedb88320).
+
+    The portable version reads four bytes per step using four
+    tables ("slicing by four"). When the CPU has PCLMULQDQ, runs
+    of 64 bytes or more are folded 512 bits at a time with carry-less
+    multiplication and reduced to 32 bits with a Barrett reduction,
+    as described in "Fast CRC Computation for Generic Polynomials
+    Using PCLMULQDQ Instruction" (Intel, 2009).
+*/
+
+template<class = void>
+std::uint32_t const
+(&crc32_table())[4][256]
+{
+    struct init
+    {
+        std::uint32_t table[4][256];
+
+        init()
+        {
+            for(std::uint32_t n = 0; n < 256; ++n)
+            {
+                std::uint32_t c = n;
+                for(int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                table[0][n] = c;
+            }
+            for(std::uint32_t n = 0; n < 256; ++n)
+            {
+                auto c = table[0][n];
+                for(int k = 1; k < 4; ++k)
+                {
+                    c = table[0][c & 0xff] ^ (c >> 8);
+                    table[k][n] = c;
+                }
+            }
+        }
+    };
+    static init const data;
+    return data.table;
+}
+
+#if ! BOOST_BEAST_ZLIB_NO_PCLMUL
+
+// size must be a multiple of 16, at least 64
+template<class = void>
+std::uint32_t
+crc32_pclmul(
+    std::uint32_t crc,
+    std::uint8_t const* p,
+    std::size_t size)
+{
+    // constants for the reflected polynomial
+    __m128i const k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    __m128i const k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    __m128i const k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    __m128i const poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    __m128i const mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    auto const load =
+        [](std::uint8_t const* q)
+        {
+            return _mm_loadu_si128(
+                reinterpret_cast<__m128i const*>(q));
+        };
+    auto const fold =
+        [](__m128i x, __m128i k, __m128i y)
+        {
+            return _mm_xor_si128(_mm_xor_si128(
+                _mm_clmulepi64_si128(x, k, 0x00),
+                _mm_clmulepi64_si128(x, k, 0x11)), y);
+        };
+
+    __m128i x1 = _mm_xor_si128(load(p),
+        _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = load(p + 16);
+    __m128i x3 = load(p + 32);
+    __m128i x4 = load(p + 48);
+    p += 64;
+    size -= 64;
+
+    // fold four lanes 64 bytes at a time
+    while(size >= 64)
+    {
+        x1 = fold(x1, k1k2, load(p));
+        x2 = fold(x2, k1k2, load(p + 16));
+        x3 = fold(x3, k1k2, load(p + 32));
+        x4 = fold(x4, k1k2, load(p + 48));
+        p += 64;
+        size -= 64;
+    }
+
+    // fold the lanes into one
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+
+    // fold remaining blocks of 16
+    while(size >= 16)
+    {
+        x1 = fold(x1, k3k4, load(p));
+        p += 16;
+        size -= 16;
+    }
+
+    // fold 128 bits to 64
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<std::uint32_t>(
+        _mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+/*  Update a running CRC-32 with size bytes. The initial
+    value is 0, the same as zlib's crc32().
+*/
+template<class = void>
+std::uint32_t
+crc32(
+    std::uint32_t crc,
+    void const* data,
+    std::size_t size)
+{
+    auto p = static_cast<std::uint8_t const*>(data);
+    auto const& t = crc32_table();
+    crc = ~crc;
+#if ! BOOST_BEAST_ZLIB_NO_PCLMUL
+    if(size >= 64 && beast::detail::get_cpu_info().pclmul)
+    {
+        auto const n = size & ~std::size_t{15};
+        crc = crc32_pclmul(crc, p, n);
+        p += n;
+        size -= n;
+    }
+#endif
+    while(size >= 4)
+    {
+        crc ^=
+            static_cast<std::uint32_t>(p[0]) |
+            static_cast<std::uint32_t>(p[1]) << 8 |
+            static_cast<std::uint32_t>(p[2]) << 16 |
+            static_cast<std::uint32_t>(p[3]) << 24;
+        crc =
+            t[3][crc & 0xff] ^
+            t[2][(crc >> 8) & 0xff] ^
+            t[1][(crc >> 16) & 0xff] ^
+            t[0][crc >> 24];
+        p += 4;
+        size -= 4;
+    }
+    while(size--)
+        crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+} // detail
+} // zlib
+} // beast
+} // boost
+
+#endif
@@ -38,7 +38,10 @@
 #define BOOST_BEAST_ZLIB_DETAIL_DEFLATE_STREAM_HPP
 
 #include <boost/beast/zlib/zlib.hpp>
+#include <boost/beast/zlib/detail/adler32.hpp>
+#include <boost/beast/zlib/detail/crc32.hpp>
 #include <boost/beast/zlib/detail/ranges.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/beast/core/detail/type_traits.hpp>
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
@@ -52,6 +55,10 @@
 #include <stdexcept>
 #include <type_traits>
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <nmmintrin.h>
+#endif
+
 namespace boost {
 namespace beast {
 namespace zlib {
@@ -352,6 +359,14 @@ protected:
     */
     uInt hash_shift_;
 
+    bool fast_hash_ = false;        // fast hash option setting
+    bool crc_hash_ = false;         // strings are hashed with CRC32
+
+    Format format_ = Format::raw;   // container format setting
+    Format wrap_ = Format::raw;     // header written, trailer still due
+    std::uint32_t check_;           // checksum of the input so far
+    std::uint32_t size_;            // input size modulo 2^32
+
     /*  Window position at the beginning of the current output block.
         Gets negative when the window is moved backwards.
     */
@@ -552,6 +567,48 @@ protected:
         h = ((h << hash_shift_) ^ c) & hash_mask_;
     }
 
+    /*  Update ins_h for the string at window offset str, given
+        the hash of the string before it. The CRC32 hash is made
+        from the four bytes at str, so it needs no previous key.
+    */
+    void
+    update_hash_at(uInt str)
+    {
+#if ! BOOST_BEAST_NO_INTRINSICS
+        if(crc_hash_)
+        {
+            std::uint32_t v;
+            std::memcpy(&v, window_ + str, sizeof(v));
+            ins_h_ = _mm_crc32_u32(0, v) & hash_mask_;
+            return;
+        }
+#endif
+        update_hash(ins_h_, window_[str + (minMatch-1)]);
+    }
+
+    // Return the number of equal leading bytes of two
+    // 8-byte words, given their exclusive or.
+    static
+    unsigned
+    equal_bytes(std::uint64_t x)
+    {
+        BOOST_ASSERT(x != 0);
+#if (defined(BOOST_GCC) || defined(BOOST_CLANG)) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return static_cast<unsigned>(__builtin_ctzll(x)) >> 3;
+#elif (defined(BOOST_GCC) || defined(BOOST_CLANG)) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return static_cast<unsigned>(__builtin_clzll(x)) >> 3;
+#else
+        std::uint8_t b[8];
+        std::memcpy(b, &x, sizeof(b));
+        unsigned n = 0;
+        while(b[n] == 0)
+            ++n;
+        return n;
+#endif
+    }
+
     /*  Initialize the hash table (avoiding 64K overflow for 16
         bit systems). prev[] will be initialized on the fly.
     */
@@ -588,7 +645,7 @@ protected:
     void
     insert_string(IPos& hash_head)
     {
-        update_hash(ins_h_, window_[strstart_ + (minMatch-1)]);
+        update_hash_at(strstart_);
         hash_head = prev_[strstart_ & w_mask_] = head_[ins_h_];
         head_[ins_h_] = (std::uint16_t)strstart_;
     }
@@ -671,6 +728,8 @@ protected:
     template<class = void> void doClear             ();
     template<class = void> std::size_t doUpperBound (std::size_t sourceLen) const;
     template<class = void> void doTune              (int good_length, int max_lazy, int nice_length, int max_chain);
+    template<class = void> void doFastHash          (bool value);
+    template<class = void> void doFormat            (Format value);
     template<class = void> void doParams            (z_params& zs, int level, Strategy strategy, error_code& ec);
     template<class = void> void doWrite             (z_params& zs, boost::optional<Flush> flush, error_code& ec);
     template<class = void> void doDictionary        (Byte const* dict, uInt dictLength, error_code& ec);
@@ -703,7 +762,10 @@ protected:
 
     template<class = void> void tr_flush_block      (z_params& zs, char *buf, std::uint32_t stored_len, int last);
     template<class = void> void fill_window         (z_params& zs);
+    template<class = void> void slide_hash          (uInt wsize);
     template<class = void> void flush_pending       (z_params& zs);
+    template<class = void> void put_header          ();
+    template<class = void> void put_trailer         ();
     template<class = void> void flush_block         (z_params& zs, bool last);
     template<class = void> int  read_buf            (z_params& zs, Byte *buf, unsigned size);
     template<class = void> uInt longest_match       (IPos cur_match);
@@ -958,7 +1020,12 @@ doUpperBound(std::size_t sourceLen) const
               ((sourceLen + 7) >> 3) + ((sourceLen + 63) >> 6) + 5;
 
     /* compute wrapper length */
-    wraplen = 0;
+    switch(format_)
+    {
+    case Format::zlib:  wraplen = 6; break;
+    case Format::gzip:  wraplen = 18; break;
+    default:            wraplen = 0; break;
+    }
 
     /* if not default parameters, return conservative bound */
     if(w_bits_ != 15 || hash_bits_ != 8 + 7)
@@ -984,6 +1051,22 @@ doTune(
     max_chain_length_ = max_chain;
 }
 
+template<class>
+void
+deflate_stream::
+doFastHash(bool value)
+{
+    fast_hash_ = value;
+}
+
+template<class>
+void
+deflate_stream::
+doFormat(Format value)
+{
+    format_ = value;
+}
+
 template<class>
 void
 deflate_stream::
@@ -1158,11 +1241,19 @@ doWrite(z_params& zs, boost::optional<Flush> flush, error_code& ec)
         }
     }
 
-    if(flush == Flush::finish)
+    if(flush != Flush::finish)
+        return;
+    if(wrap_ == Format::raw)
     {
         ec = error::end_of_stream;
         return;
     }
+    // write the trailer only once
+    put_trailer();
+    wrap_ = Format::raw;
+    flush_pending(zs);
+    if(pending_ == 0)
+        ec = error::end_of_stream;
 }
 
 // VFALCO Warning: untested
@@ -1171,7 +1262,8 @@ void
 deflate_stream::
 doDictionary(Byte const* dict, uInt dictLength, error_code& ec)
 {
-    if(lookahead_)
+    // preset dictionaries are only supported for raw deflate
+    if(lookahead_ || format_ != Format::raw)
     {
         ec = error::stream_error;
         return;
@@ -1203,7 +1295,7 @@ doDictionary(Byte const* dict, uInt dictLength, error_code& ec)
         uInt n = lookahead_ - (minMatch-1);
         do
         {
-            update_hash(ins_h_, window_[str + minMatch-1]);
+            update_hash_at(str);
             prev_[str & w_mask_] = head_[ins_h_];
             head_[ins_h_] = (std::uint16_t)str;
             str++;
@@ -1280,6 +1372,9 @@ init()
     hash_size_ = 1 << hash_bits_;
     hash_mask_ = hash_size_ - 1;
     hash_shift_ =  ((hash_bits_+minMatch-1)/minMatch);
+#if ! BOOST_BEAST_NO_INTRINSICS
+    crc_hash_ = fast_hash_ && beast::detail::get_cpu_info().sse42;
+#endif
 
     auto const nwindow  = w_size_ * 2*sizeof(Byte);
     auto const nprev    = w_size_ * sizeof(std::uint16_t);
@@ -1326,6 +1421,9 @@ init()
     tr_init();
     lm_init();
 
+    wrap_ = format_;
+    put_header();
+
     inited_ = true;
 }
 
@@ -2183,9 +2281,8 @@ void
 deflate_stream::
 fill_window(z_params& zs)
 {
-    unsigned n, m;
+    unsigned n;
     unsigned more;    // Amount of free space at the end of the window.
-    std::uint16_t *p;
     uInt wsize = w_size_;
 
     do
@@ -2228,26 +2325,7 @@ fill_window(z_params& zs)
                later. (Using level 0 permanently is not an optimal usage of
                zlib, so we don't care about this pathological case.)
             */
-            n = hash_size_;
-            p = &head_[n];
-            do
-            {
-                m = *--p;
-                *p = (std::uint16_t)(m >= wsize ? m-wsize : 0);
-            }
-            while(--n);
-
-            n = wsize;
-            p = &prev_[n];
-            do
-            {
-                m = *--p;
-                *p = (std::uint16_t)(m >= wsize ? m-wsize : 0);
-                /*  If n is not on any hash chain, prev[n] is garbage but
-                    its value will never be used.
-                */
-            }
-            while(--n);
+            slide_hash(wsize);
             more += wsize;
         }
         if(zs.avail_in == 0)
@@ -2275,7 +2353,7 @@ fill_window(z_params& zs)
             update_hash(ins_h_, window_[str + 1]);
             while(insert_)
             {
-                update_hash(ins_h_, window_[str + minMatch-1]);
+                update_hash_at(str);
                 prev_[str & w_mask_] = head_[ins_h_];
                 head_[ins_h_] = (std::uint16_t)str;
                 str++;
@@ -2394,9 +2472,145 @@ read_buf(z_params& zs, Byte *buf, unsigned size)
     zs.next_in = static_cast<
         std::uint8_t const*>(zs.next_in) + len;
     zs.total_in += len;
+
+    // checksum the copy in the window while it is in cache
+    if(wrap_ == Format::zlib)
+        check_ = adler32(check_, buf, len);
+    else if(wrap_ == Format::gzip)
+    {
+        check_ = crc32(check_, buf, len);
+        size_ += static_cast<std::uint32_t>(len);
+    }
     return (int)len;
 }
 
+/*  Write the zlib or gzip header to the pending buffer
+    and set the initial check value.
+*/
+template<class>
+void
+deflate_stream::
+put_header()
+{
+    if(wrap_ == Format::zlib)
+    {
+        unsigned level_flags;
+        if(strategy_ >= Strategy::huffman || level_ < 2)
+            level_flags = 0;
+        else if(level_ < 6)
+            level_flags = 1;
+        else if(level_ == 6)
+            level_flags = 2;
+        else
+            level_flags = 3;
+        unsigned header = (8 + ((w_bits_ - 8) << 4)) << 8;
+        header |= level_flags << 6;
+        header += 31 - (header % 31);
+        put_byte(static_cast<Byte>(header >> 8));
+        put_byte(static_cast<Byte>(header & 0xff));
+        check_ = 1;
+    }
+    else if(wrap_ == Format::gzip)
+    {
+        // no optional fields, no modification time
+        put_byte(0x1f);
+        put_byte(0x8b);
+        put_byte(8);
+        put_byte(0);
+        put_short(0);
+        put_short(0);
+        if(level_ == 9)
+            put_byte(2);
+        else if(strategy_ >= Strategy::huffman || level_ < 2)
+            put_byte(4);
+        else
+            put_byte(0);
+        put_byte(255); // unknown OS
+        check_ = 0;
+        size_ = 0;
+    }
+}
+
+/*  Write the zlib or gzip trailer to the pending buffer.
+*/
+template<class>
+void
+deflate_stream::
+put_trailer()
+{
+    if(wrap_ == Format::zlib)
+    {
+        put_byte(static_cast<Byte>(check_ >> 24));
+        put_byte(static_cast<Byte>(check_ >> 16));
+        put_byte(static_cast<Byte>(check_ >> 8));
+        put_byte(static_cast<Byte>(check_));
+    }
+    else if(wrap_ == Format::gzip)
+    {
+        put_short(static_cast<std::uint16_t>(check_));
+        put_short(static_cast<std::uint16_t>(check_ >> 16));
+        put_short(static_cast<std::uint16_t>(size_));
+        put_short(static_cast<std::uint16_t>(size_ >> 16));
+    }
+}
+
+/*  Subtract wsize from every position in the hash table and in
+    the chains, clamping at zero. Eight entries at a time with a
+    saturating subtract when SSE4.2 is available, which gives the
+    same result as the loops.
+*/
+template<class>
+void
+deflate_stream::
+slide_hash(uInt wsize)
+{
+    unsigned n, m;
+    std::uint16_t *p;
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+    if(beast::detail::get_cpu_info().sse42)
+    {
+        __m128i const w = _mm_set1_epi16(
+            static_cast<short>(wsize));
+        auto const slide =
+            [&w](std::uint16_t* t, unsigned size)
+            {
+                // size is a power of two, at least 256
+                for(auto const end = t + size; t != end; t += 8)
+                {
+                    auto const v = reinterpret_cast<__m128i*>(t);
+                    _mm_storeu_si128(v, _mm_subs_epu16(
+                        _mm_loadu_si128(v), w));
+                }
+            };
+        slide(head_, hash_size_);
+        slide(prev_, wsize);
+        return;
+    }
+#endif
+
+    n = hash_size_;
+    p = &head_[n];
+    do
+    {
+        m = *--p;
+        *p = (std::uint16_t)(m >= wsize ? m-wsize : 0);
+    }
+    while(--n);
+
+    n = wsize;
+    p = &prev_[n];
+    do
+    {
+        m = *--p;
+        *p = (std::uint16_t)(m >= wsize ? m-wsize : 0);
+        /*  If n is not on any hash chain, prev[n] is garbage but
+            its value will never be used.
+        */
+    }
+    while(--n);
+}
+
 /*  Set match_start to the longest match starting at the given string and
     return its length. Matches shorter or equal to prev_length are discarded,
     in which case the result is equal to prev_length and match_start is
@@ -2468,24 +2682,29 @@ longest_match(IPos cur_match)
 
         /* The check at best_len-1 can be removed because it will be made
          * again later. (This heuristic is not always a win.)
-         * It is not necessary to compare scan[2] and match[2] since they
-         * are always equal when the other bytes match, given that
-         * the hash keys are equal and that HASH_BITS >= 8.
          */
         scan += 2, match++;
-        BOOST_ASSERT(*scan == *match);
 
-        /* We check for insufficient lookahead only every 8th comparison;
-         * the 256th check will be made at strstart+258.
+        /* Compare eight bytes at a time. The third byte is compared
+         * too, because the CRC32 hash does not guarantee that it is
+         * equal. The 32nd compare ends exactly at strstart+258.
          */
-        do
+        for(;;)
         {
+            std::uint64_t a;
+            std::uint64_t b;
+            std::memcpy(&a, scan, sizeof(a));
+            std::memcpy(&b, match, sizeof(b));
+            if(a != b)
+            {
+                scan += equal_bytes(a ^ b);
+                break;
+            }
+            scan += 8;
+            match += 8;
+            if(scan >= strend)
+                break;
         }
-        while(  *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                scan < strend);
 
         BOOST_ASSERT(scan <= window_+(unsigned)(window_size_-1));
 
@@ -39,7 +39,9 @@
 
 #include <boost/beast/zlib/error.hpp>
 #include <boost/beast/zlib/zlib.hpp>
+#include <boost/beast/zlib/detail/adler32.hpp>
 #include <boost/beast/zlib/detail/bitstream.hpp>
+#include <boost/beast/zlib/detail/crc32.hpp>
 #include <boost/beast/zlib/detail/ranges.hpp>
 #include <boost/beast/zlib/detail/window.hpp>
 #include <boost/beast/core/detail/type_traits.hpp>
@@ -67,6 +69,12 @@ protected:
     template<class = void> void doReset(int windowBits);
     template<class = void> void doWrite(z_params& zs, Flush flush, error_code& ec);
 
+    void
+    doFormat(Format value)
+    {
+        format_ = value;
+    }
+
     void
     doReset()
     {
@@ -194,12 +202,31 @@ private:
     void
     inflate_fast(ranges& r, error_code& ec);
 
+    static
+    void
+    copy_match(
+        unsigned char*& out,
+        std::size_t dist,
+        std::size_t n);
+
+    // input needed by inflate_fast
+    static std::size_t constexpr fast_input =
+        BOOST_BEAST_ZLIB_WIDE_BITSTREAM ? 8 : 6;
+
     bitstream bi_;
 
     Mode mode_ = HEAD;              // current inflate mode
     int last_ = 0;                  // true if processing last block
     unsigned dmax_ = 32768U;        // zlib header max distance (INFLATE_STRICT)
 
+    // container format
+    Format format_ = Format::raw;   // container format setting
+    Format wrap_ = Format::raw;     // format of the current stream
+    unsigned flags_;                // gzip header flags
+    std::uint32_t hcheck_;          // CRC-32 of the gzip header
+    std::uint32_t check_;           // checksum of the output so far
+    std::uint32_t size_;            // output size modulo 2^32
+
     // sliding window
     window w_;
 
@@ -256,6 +283,8 @@ void
 inflate_stream::
 doClear()
 {
+    doReset();
+    w_.clear();
 }
 
 template<class>
@@ -273,6 +302,54 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
     r.out.last = r.out.first + zs.avail_out;
     r.out.next = r.out.first;
 
+    // checksum the output produced so far by this call
+    auto checked = r.out.first;
+    auto const update =
+        [&]
+        {
+            auto const n = static_cast<
+                std::size_t>(r.out.next - checked);
+            if(n == 0)
+                return;
+            if(wrap_ == Format::zlib)
+            {
+                check_ = adler32(check_, checked, n);
+            }
+            else if(wrap_ == Format::gzip)
+            {
+                check_ = crc32(check_, checked, n);
+                size_ += static_cast<std::uint32_t>(n);
+            }
+            checked = r.out.next;
+        };
+
+    // read n whole bytes of the gzip header
+    auto const header =
+        [&](std::uint8_t* p, std::size_t n)
+        {
+            if(! bi_.fill(8 * n, r.in.next, r.in.last))
+                return false;
+            for(std::size_t i = 0; i < n; ++i)
+                bi_.read(p[i], 8);
+            hcheck_ = crc32(hcheck_, p, n);
+            return true;
+        };
+
+    // skip gzip header bytes up to and including a zero
+    auto const skip_string =
+        [&]
+        {
+            BOOST_ASSERT(bi_.size() == 0);
+            auto const n = r.in.avail();
+            auto const p = static_cast<std::uint8_t const*>(
+                std::memchr(r.in.next, 0, n));
+            auto const used = p ?
+                static_cast<std::size_t>(p - r.in.next) + 1 : n;
+            hcheck_ = crc32(hcheck_, r.in.next, used);
+            r.in.next += used;
+            return p != nullptr;
+        };
+
     auto const done =
         [&]
         {
@@ -284,6 +361,8 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
              */
 
 
+            update();
+
             // VFALCO TODO Don't allocate update the window unless necessary
             if(/*wsize_ ||*/ (r.out.used() && mode_ < BAD &&
                     (mode_ < CHECK || flush != Flush::finish)))
@@ -318,8 +397,126 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
         switch(mode_)
         {
         case HEAD:
+        {
+            wrap_ = format_;
+            if(wrap_ == Format::raw)
+            {
+                mode_ = TYPEDO;
+                break;
+            }
+            if(! bi_.fill(16, r.in.next, r.in.last))
+                return done();
+            std::uint8_t b[2];
+            bi_.read(b[0], 8);
+            bi_.read(b[1], 8);
+            if(wrap_ == Format::gzip)
+            {
+                if(b[0] != 0x1f || b[1] != 0x8b)
+                    return err(error::incorrect_header_check);
+                hcheck_ = crc32(0, b, 2);
+                mode_ = FLAGS;
+                break;
+            }
+            if(((b[0] << 8) + b[1]) % 31 != 0)
+                return err(error::incorrect_header_check);
+            if((b[0] & 0x0f) != 8)
+                return err(error::unknown_compression_method);
+            if((b[0] >> 4) + 8 > w_.bits())
+                return err(error::invalid_window_size);
+            if(b[1] & 0x20)
+                return err(error::need_dictionary);
+            check_ = 1;
             mode_ = TYPEDO;
             break;
+        }
+
+        case FLAGS:
+        {
+            std::uint8_t b[2];
+            if(! header(b, 2))
+                return done();
+            if(b[0] != 8)
+                return err(error::unknown_compression_method);
+            if(b[1] & 0xe0)
+                return err(error::incorrect_header_check);
+            flags_ = b[1];
+            mode_ = TIME;
+            BOOST_FALLTHROUGH;
+        }
+
+        case TIME:
+        {
+            std::uint8_t b[4];
+            if(! header(b, 4))
+                return done();
+            mode_ = OS;
+            BOOST_FALLTHROUGH;
+        }
+
+        case OS:
+        {
+            std::uint8_t b[2];
+            if(! header(b, 2))
+                return done();
+            mode_ = EXLEN;
+            BOOST_FALLTHROUGH;
+        }
+
+        case EXLEN:
+        {
+            length_ = 0;
+            if(flags_ & 0x04)
+            {
+                std::uint8_t b[2];
+                if(! header(b, 2))
+                    return done();
+                length_ = b[0] + (b[1] << 8u);
+            }
+            mode_ = EXTRA;
+            BOOST_FALLTHROUGH;
+        }
+
+        case EXTRA:
+        {
+            BOOST_ASSERT(bi_.size() == 0);
+            auto const n = clamp(length_, r.in.avail());
+            hcheck_ = crc32(hcheck_, r.in.next, n);
+            r.in.next += n;
+            length_ -= n;
+            if(length_ != 0)
+                return done();
+            mode_ = NAME;
+            BOOST_FALLTHROUGH;
+        }
+
+        case NAME:
+            if((flags_ & 0x08) && ! skip_string())
+                return done();
+            mode_ = COMMENT;
+            BOOST_FALLTHROUGH;
+
+        case COMMENT:
+            if((flags_ & 0x10) && ! skip_string())
+                return done();
+            mode_ = HCRC;
+            BOOST_FALLTHROUGH;
+
+        case HCRC:
+        {
+            if(flags_ & 0x02)
+            {
+                if(! bi_.fill(16, r.in.next, r.in.last))
+                    return done();
+                std::uint16_t v;
+                bi_.read(v, 16);
+                if(v != (hcheck_ & 0xffff))
+                    return err(error::incorrect_header_check);
+            }
+            check_ = 0;
+            size_ = 0;
+            mode_ = TYPEDO;
+            break;
+        }
 
         case TYPE:
             if(flush == Flush::block || flush == Flush::trees)
@@ -545,7 +742,7 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
 
         case LEN:
         {
-            if(r.in.avail() >= 6 && r.out.avail() >= 258)
+            if(r.in.avail() >= fast_input && r.out.avail() >= 258)
             {
                 inflate_fast(r, ec);
                 if(ec)
@@ -678,11 +875,9 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
             else
             {
                 // copy from output
-                auto in = r.out.next - offset_;
                 auto n = clamp(length_, r.out.avail());
                 length_ -= n;
-                while(n--)
-                    *r.out.next++ = *in++;
+                copy_match(r.out.next, offset_, n);
             }
             if(length_ == 0)
                 mode_ = LEN;
@@ -700,8 +895,55 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
         }
 
         case CHECK:
+        {
+            if(wrap_ == Format::raw)
+            {
+                mode_ = DONE;
+                break;
+            }
+            update();
+            if(! bi_.fill(32, r.in.next, r.in.last))
+                return done();
+            std::uint8_t b[4];
+            for(auto& c : b)
+                bi_.read(c, 8);
+            if(wrap_ == Format::zlib)
+            {
+                if(check_ != (
+                    (static_cast<std::uint32_t>(b[0]) << 24) |
+                    (static_cast<std::uint32_t>(b[1]) << 16) |
+                    (static_cast<std::uint32_t>(b[2]) << 8) |
+                     static_cast<std::uint32_t>(b[3])))
+                    return err(error::incorrect_data_check);
+                mode_ = DONE;
+                break;
+            }
+            if(check_ != (
+                 static_cast<std::uint32_t>(b[0]) |
+                (static_cast<std::uint32_t>(b[1]) << 8) |
+                (static_cast<std::uint32_t>(b[2]) << 16) |
+                (static_cast<std::uint32_t>(b[3]) << 24)))
+                return err(error::incorrect_data_check);
+            mode_ = LENGTH;
+            BOOST_FALLTHROUGH;
+        }
+
+        case LENGTH:
+        {
+            if(! bi_.fill(32, r.in.next, r.in.last))
+                return done();
+            std::uint8_t b[4];
+            for(auto& c : b)
+                bi_.read(c, 8);
+            if(size_ != (
+                 static_cast<std::uint32_t>(b[0]) |
+                (static_cast<std::uint32_t>(b[1]) << 8) |
+                (static_cast<std::uint32_t>(b[2]) << 16) |
+                (static_cast<std::uint32_t>(b[3]) << 24)))
+                return err(error::incorrect_length_check);
             mode_ = DONE;
             BOOST_FALLTHROUGH;
+        }
 
         case DONE:
             ec = error::end_of_stream;
@@ -1146,7 +1388,9 @@ fixedTables()
       length code, 5 bits for the length extra, 15 bits for the distance code,
       and 13 bits for the distance extra.  This totals 48 bits, or six bytes.
       Therefore if zs.avail_in >= 6, then there is enough input to avoid
-      checking for available input while decoding.
+      checking for available input while decoding. With the 64-bit bit
+      buffer, eight bytes are loaded at once and one fill per loop covers
+      a whole length/distance pair, so zs.avail_in >= 8 is needed instead.
 
     - The maximum bytes that a single length/distance pair can output is 258
       bytes, which is the maximum length that can be coded.  inflate_fast()
@@ -1180,15 +1424,19 @@ inflate_fast(ranges& r, error_code& ec)
     unsigned const dmask =
         (1U << distbits_) - 1;  // mask for first level of distance codes
 
-    last = r.in.next + (r.in.avail() - 5);
+    last = r.in.next + (r.in.avail() - (fast_input - 1));
     end = r.out.next + (r.out.avail() - 257);
 
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do
     {
+#if BOOST_BEAST_ZLIB_WIDE_BITSTREAM
+        bi_.fill_56(r.in.next);
+#else
         if(bi_.size() < 15)
             bi_.fill_16(r.in.next);
+#endif
         auto cp = &lencode_[bi_.peek_fast() & lmask];
     dolen:
         bi_.drop(cp->bits);
@@ -1205,13 +1453,17 @@ inflate_fast(ranges& r, error_code& ec)
             op &= 15; // number of extra bits
             if(op)
             {
+#if ! BOOST_BEAST_ZLIB_WIDE_BITSTREAM
                 if(bi_.size() < op)
                     bi_.fill_8(r.in.next);
+#endif
                 len += (unsigned)bi_.peek_fast() & ((1U << op) - 1);
                 bi_.drop(op);
             }
+#if ! BOOST_BEAST_ZLIB_WIDE_BITSTREAM
             if(bi_.size() < 15)
                 bi_.fill_16(r.in.next);
+#endif
             cp = &distcode_[bi_.peek_fast() & dmask];
         dodist:
             bi_.drop(cp->bits);
@@ -1221,12 +1473,15 @@ inflate_fast(ranges& r, error_code& ec)
                 // distance base
                 dist = (unsigned)(cp->val);
                 op &= 15; // number of extra bits
+#if ! BOOST_BEAST_ZLIB_WIDE_BITSTREAM
                 if(bi_.size() < op)
                 {
                     bi_.fill_8(r.in.next);
                     if(bi_.size() < op)
                         bi_.fill_8(r.in.next);
                 }
+#endif
+                BOOST_ASSERT(bi_.size() >= op);
                 dist += (unsigned)bi_.peek_fast() & ((1U << op) - 1);
 #ifdef INFLATE_STRICT
                 if(dist > dmax_)
@@ -1257,11 +1512,9 @@ inflate_fast(ranges& r, error_code& ec)
                 if(len > 0)
                 {
                     // copy from output
-                    auto in = r.out.next - dist;
                     auto n = clamp(len, r.out.avail());
                     len -= n;
-                    while(n--)
-                        *r.out.next++ = *in++;
+                    copy_match(r.out.next, dist, n);
                 }
             }
             else if((op & 64) == 0)
@@ -1302,6 +1555,44 @@ inflate_fast(ranges& r, error_code& ec)
     bi_.rewind(r.in.next);
 }
 
+/*  Copy n bytes which start dist bytes back in the output. The
+    source and destination overlap when dist < n, which repeats
+    the last dist bytes. Copies are done eight bytes at a time
+    from a distance of at least eight, so each copy only reads
+    bytes which are already written.
+*/
+inline
+void
+inflate_stream::
+copy_match(
+    unsigned char*& out,
+    std::size_t dist,
+    std::size_t n)
+{
+    auto in = out - dist;
+    if(dist < 8)
+    {
+        // The output repeats every dist bytes, so a multiple
+        // of dist which is eight or more is also a distance
+        // to copy from, once that much has been written.
+        auto const period = ((7 + dist) / dist) * dist;
+        auto m = clamp(n, period);
+        n -= m;
+        while(m--)
+            *out++ = *in++;
+        in = out - period;
+    }
+    while(n >= 8)
+    {
+        std::memcpy(out, in, 8);
+        out += 8;
+        in += 8;
+        n -= 8;
+    }
+    while(n--)
+        *out++ = *in++;
+}
+
 } // detail
 } // zlib
 } // beast
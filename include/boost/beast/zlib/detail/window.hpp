@@ -78,6 +78,9 @@ public:
     void
     reset(int bits);
 
+    void
+    clear();
+
     void
     read(std::uint8_t* out, std::size_t pos, std::size_t n);
 
@@ -101,6 +104,16 @@ reset(int bits)
     size_ = 0;
 }
 
+inline
+void
+window::
+clear()
+{
+    p_.reset();
+    i_ = 0;
+    size_ = 0;
+}
+
 inline
 void
 window::
@@ -123,6 +123,28 @@ enum class error
     /// Incomplete length set
     incomplete_length_set,
 
+    //
+    // Errors generated by the zlib and gzip formats
+    //
+
+    /// Incorrect header check
+    incorrect_header_check,
+
+    /// Unknown compression method
+    unknown_compression_method,
+
+    /// Invalid window size in header
+    invalid_window_size,
+
+    /// A preset dictionary is needed
+    need_dictionary,
+
+    /// Incorrect data check
+    incorrect_data_check,
+
+    /// Incorrect length check
+    incorrect_length_check,
+
 
 
     /// general error
@@ -85,6 +85,13 @@ public:
         case error::over_subscribed_length: return "over-subscribed length";
         case error::incomplete_length_set: return "incomplete length set";
 
+        case error::incorrect_header_check: return "incorrect header check";
+        case error::unknown_compression_method: return "unknown compression method";
+        case error::invalid_window_size: return "invalid window size";
+        case error::need_dictionary: return "need dictionary";
+        case error::incorrect_data_check: return "incorrect data check";
+        case error::incorrect_length_check: return "incorrect length check";
+
         case error::general:
         default:
             return "beast.zlib error";
@@ -95,6 +95,28 @@ public:
         doReset(windowBits);
     }
 
+    /** Set the container format.
+
+        This selects the header and trailer expected around the
+        compressed data. For `Format::zlib` and `Format::gzip` the
+        checksum in the trailer is verified against the output as
+        it is produced, and `write` returns `error::end_of_stream`
+        only when the checksum (and for gzip, the length) matches.
+
+        The setting is applied at the start of each stream, which
+        is the first write after construction or after a call to
+        `reset`.
+
+        The default setting is `Format::raw`.
+
+        @param value The format to expect.
+    */
+    void
+    format(Format value)
+    {
+        doFormat(value);
+    }
+
     /** Put the stream in a newly constructed state.
 
         All dynamically allocated memory is de-allocated.
@@ -176,6 +176,37 @@ enum class Strategy
     fixed
 };
 
+/** Container format of a compressed stream.
+
+    This selects the header and trailer written around the
+    deflate data when compressing, and expected around it when
+    decompressing.
+*/
+enum class Format
+{
+    /** Raw deflate data (RFC 1951) with no header or trailer.
+    */
+    raw,
+
+    /** The zlib format (RFC 1950).
+
+        A two byte header precedes the deflate data, and it is
+        followed by the Adler-32 checksum of the uncompressed data.
+        Streams which require a preset dictionary are not supported.
+    */
+    zlib,
+
+    /** The gzip format (RFC 1952).
+
+        A ten byte header precedes the deflate data, and it is
+        followed by the CRC-32 and length of the uncompressed data.
+        Only a single member is decoded. The optional header fields
+        are skipped when decompressing and are not written when
+        compressing.
+    */
+    gzip
+};
+
 } // zlib
 } // beast
 } // boost
@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/core/file_mmap.hpp>
+
+#if BOOST_BEAST_USE_MMAP_FILE
+
+#include "file_test.hpp"
+
+#include <boost/beast/core/type_traits.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <cstring>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+namespace boost {
+namespace beast {
+
+BOOST_STATIC_ASSERT(! std::is_copy_constructible<file_mmap>::value);
+
+class file_mmap_test
+    : public beast::unit_test::suite
+{
+public:
+    void
+    testMapping()
+    {
+        error_code ec;
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string const s = "Hello, world!";
+
+        // writes within the reservation go to the mapping
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.data() == nullptr);
+            f.reserve(s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.data() != nullptr);
+            BEAST_EXPECT(f.mapped_size() == s.size());
+            f.write(s.data(), 7, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(std::memcmp(f.data(), s.data(), 7) == 0);
+            f.write(s.data() + 7, s.size() - 7, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+
+            // past the end of the mapping
+            f.write("!!", 2, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size() + 2);
+            BEAST_EXPECT(f.pos(ec) == s.size() + 2);
+            f.close(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.data() == nullptr);
+        }
+
+        // files opened for reading are mapped
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::scan, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.mapped_size() == s.size() + 2);
+            BEAST_EXPECT(string_view(f.data(), f.mapped_size()) ==
+                s + "!!");
+
+            file_mmap f2{std::move(f)};
+            BEAST_EXPECT(f.data() == nullptr);
+            BEAST_EXPECT(f2.data() != nullptr);
+            std::string buf(5, 0);
+            f2.seek(s.size() - 3, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            auto const n = f2.read(&buf[0], buf.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(n == 5);
+            BEAST_EXPECT(buf == "ld!!!");
+
+            // short read at the end
+            BEAST_EXPECT(f2.read(&buf[0], buf.size(), ec) == 0);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+
+        // empty files are not mapped
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.close(ec);
+            f.open(path.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.data() == nullptr);
+            BEAST_EXPECT(f.size(ec) == 0);
+
+            // read-only files cannot be reserved
+            f.reserve(10, ec);
+            BEAST_EXPECT(ec == errc::invalid_argument);
+        }
+
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    testTrim()
+    {
+        error_code ec;
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string const s = "Hello, world!";
+
+        auto const file_size =
+            [&]
+            {
+                file_mmap f;
+                error_code ec;
+                f.open(path.c_str(), file_mode::read, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                return f.size(ec);
+            };
+
+        // close truncates to the data written
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(100, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == 100);
+            f.close(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        BEAST_EXPECT(file_size() == s.size());
+
+        // and so does the destructor
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(100, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(s.data(), 5, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        BEAST_EXPECT(file_size() == 5);
+
+        // existing data before the reservation is kept
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::append_existing, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(100, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.trim(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == 5);
+
+            // a second trim does nothing
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.trim(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size());
+        }
+        BEAST_EXPECT(file_size() == s.size());
+
+        // data written before the reservation is kept
+        // when less than it is written afterwards
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write_existing, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(100, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write("Jello", 5, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.trim(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size());
+        }
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(string_view(f.data(), f.mapped_size()) ==
+                "Jello, world!");
+        }
+
+        // a file longer than the reservation is not truncated
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write_existing, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(5, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size());
+            BEAST_EXPECT(f.mapped_size() == s.size());
+            f.write("Hello", 5, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.trim(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size());
+        }
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(string_view(f.data(), f.mapped_size()) == s);
+        }
+
+        // a full reservation is left alone
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.trim(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.data() != nullptr);
+        }
+        BEAST_EXPECT(file_size() == s.size());
+
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    testReserve()
+    {
+        error_code ec;
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string const s = "Hello, world!";
+        std::size_t const size = 1024 * 1024;
+
+        // the reservation is not sparse
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.reserve(size, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.mapped_size() == size);
+            BEAST_EXPECT(string_view(f.data(), s.size()) == s);
+            struct stat st;
+            BEAST_EXPECT(::fstat(f.native_handle(), &st) == 0);
+            BEAST_EXPECT(static_cast<std::uint64_t>(
+                st.st_blocks) * 512 >= size);
+        }
+
+        // running out of space is reported by reserve
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+
+            // exceeding the limit fails with EFBIG instead of SIGXFSZ
+            auto const handler = std::signal(SIGXFSZ, SIG_IGN);
+            rlimit limit;
+            BEAST_EXPECT(::getrlimit(RLIMIT_FSIZE, &limit) == 0);
+            rlimit small = limit;
+            small.rlim_cur = size / 2;
+            BEAST_EXPECT(::setrlimit(RLIMIT_FSIZE, &small) == 0);
+            f.reserve(size, ec);
+            BEAST_EXPECT(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+            std::signal(SIGXFSZ, handler);
+
+            BEAST_EXPECT(ec == errc::file_too_large);
+            BEAST_EXPECT(f.data() == nullptr);
+            f.close(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        {
+            file_mmap f;
+            f.open(path.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.size(ec) == s.size());
+        }
+
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    run()
+    {
+        doTestFile<file_mmap>(*this);
+        testMapping();
+        testTrim();
+        testReserve();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,file_mmap);
+
+} // beast
+} // boost
+
+#endif
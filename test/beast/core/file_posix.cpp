@@ -26,10 +26,59 @@ class file_posix_test
     : public beast::unit_test::suite
 {
 public:
+    void
+    testPositional()
+    {
+        error_code ec;
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        {
+            file_posix f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.write_at(7, "world!", 6, ec) == 6);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.write_at(0, "Hello, ", 7, ec) == 7);
+            BEAST_EXPECTS(! ec, ec.message());
+
+            // the position is not changed
+            BEAST_EXPECT(f.pos(ec) == 0);
+            BEAST_EXPECT(f.size(ec) == 13);
+        }
+        {
+            file_posix f;
+            f.open(path.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            std::string s(5, 0);
+            BEAST_EXPECT(f.read_at(7, &s[0], s.size(), ec) == 5);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(s == "world");
+            BEAST_EXPECT(f.pos(ec) == 0);
+
+            // short read at the end of the file
+            BEAST_EXPECT(f.read_at(10, &s[0], s.size(), ec) == 3);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(s.substr(0, 3) == "ld!");
+            BEAST_EXPECT(f.read_at(13, &s[0], s.size(), ec) == 0);
+            BEAST_EXPECTS(! ec, ec.message());
+
+            f.read(&s[0], s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(s == "Hello");
+
+            f.close(ec);
+            f.read_at(0, &s[0], s.size(), ec);
+            BEAST_EXPECT(ec == errc::invalid_argument);
+        }
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
     void
     run()
     {
         doTestFile<file_posix>(*this);
+        testPositional();
     }
 };
 
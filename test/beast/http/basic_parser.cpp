@@ -1283,6 +1283,129 @@ public:
         bad ("ffffffffffffffffffffff\r\n");
     }
 
+    void
+    testFindFast()
+    {
+        using base = detail::basic_parser_base;
+
+        // token delimiters, same as the field name ranges
+        BOOST_ALIGNMENT(16) static const char ranges[] =
+            "\x00 "
+            "\"\""
+            "()"
+            ",,"
+            "//"
+            ":@"
+            "[]"
+            "{\377";
+        auto const in_ranges =
+            [&](char c)
+            {
+                auto const u = static_cast<unsigned char>(c);
+                for(std::size_t i = 0; i < sizeof(ranges) - 1; i += 2)
+                    if( u >= static_cast<unsigned char>(ranges[i]) &&
+                        u <= static_cast<unsigned char>(ranges[i+1]))
+                        return true;
+                return false;
+            };
+
+        // The result must never skip past a matching
+        // character, and if found it must point at one.
+        auto const check =
+            [&](string_view s)
+            {
+                auto const first = s.data();
+                auto const last = s.data() + s.size();
+                auto const expected = std::find_if(
+                    first, last, in_ranges);
+                char const* p;
+                bool found;
+                std::tie(p, found) = base::find_fast(
+                    first, last, ranges, sizeof(ranges) - 1);
+                BEAST_EXPECTS(p >= first && p <= expected, s);
+                if(found)
+                    BEAST_EXPECTS(p == expected, s);
+            };
+
+        std::string const name =
+            "Sec-WebSocket-Extensions-And-Then-Some-More";
+        for(std::size_t n = 0; n <= name.size(); ++n)
+        {
+            check(name.substr(0, n));
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                for(char c : {':', ' ', '\0', '\177', '\200', '\377', '{', '@'})
+                {
+                    std::string s = name.substr(0, n);
+                    s[i] = c;
+                    check(s);
+                }
+            }
+        }
+    }
+
+    void
+    testFindEol()
+    {
+        using base = detail::basic_parser_base;
+        auto const check =
+            [&](string_view s, int pos)
+            {
+                error_code ec;
+                auto const p = base::find_eol(
+                    s.data(), s.data() + s.size(), ec);
+                BEAST_EXPECTS(! ec, s);
+                if(pos < 0)
+                    BEAST_EXPECTS(! p, s);
+                else
+                    BEAST_EXPECTS(p == s.data() + pos, s);
+            };
+        auto const bad =
+            [&](string_view s)
+            {
+                error_code ec;
+                auto const p = base::find_eol(
+                    s.data(), s.data() + s.size(), ec);
+                BEAST_EXPECTS(ec == error::bad_line_ending, s);
+                BEAST_EXPECTS(! p, s);
+            };
+        check("",               -1);
+        check("x",              -1);
+        check("\r",             -1);
+        check("abc\r",          -1);
+        check("\r\n",            2);
+        check("abc\r\n",         5);
+        check("abc\r\nx\r\n",     5);
+        check("abc\n\r\n",        6);
+        bad("abc\rx\r\n");
+        bad("\r\r\n");
+    }
+
+    void
+    testFindEom()
+    {
+        using base = detail::basic_parser_base;
+        auto const check =
+            [&](string_view s, int pos)
+            {
+                auto const p = base::find_eom(
+                    s.data(), s.data() + s.size());
+                if(pos < 0)
+                    BEAST_EXPECTS(! p, s);
+                else
+                    BEAST_EXPECTS(p == s.data() + pos, s);
+            };
+        check("",                   -1);
+        check("\r\n\r",              -1);
+        check("\r\n\r\n",             4);
+        check("\r\r\n\r\n",           5);
+        check("\r\n\r\r\n\r\n",         7);
+        check("a\r\nb\r\n\r\nc",        8);
+        check("a\r\nb\r\n\r",         -1);
+        check("a\n\r\n\r\r\n",        -1);
+        check("\n\n\r\n\r\n",           6);
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -1309,6 +1432,9 @@ public:
         testRegression1();
         testIssue1211();
         testIssue1267();
+        testFindFast();
+        testFindEol();
+        testFindEom();
     }
 };
 
@@ -0,0 +1,401 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/compressed_body.hpp>
+
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/ostream.hpp>
+#include <boost/beast/http/buffer_body.hpp>
+#include <boost/beast/http/dynamic_body.hpp>
+#include <boost/beast/http/parser.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class compressed_body_test : public beast::unit_test::suite
+{
+public:
+    using body = compressed_body<string_body>;
+
+    static
+    std::string
+    make_payload(std::size_t n)
+    {
+        // compressible, but not trivially so
+        std::string s;
+        s.reserve(n);
+        std::mt19937 g;
+        std::uniform_int_distribution<int> d{0, 15};
+        while(s.size() < n)
+            s.push_back(static_cast<char>('a' + d(g)));
+        return s;
+    }
+
+    template<bool isRequest, class Body, class Fields>
+    static
+    std::string
+    to_string(message<isRequest, Body, Fields> const& m)
+    {
+        std::stringstream ss;
+        ss << m;
+        return ss.str();
+    }
+
+    // Parse s in pieces of at most n bytes
+    template<class Body>
+    void
+    parse(parser<false, Body>& p,
+        std::string const& s, std::size_t n, error_code& ec)
+    {
+        p.eager(true);
+        string_view sv = s;
+        std::size_t len = 0;
+        while(! p.is_done())
+        {
+            len = (std::min)(len + n, sv.size());
+            auto const used = p.put(
+                boost::asio::const_buffer{sv.data(), len}, ec);
+            if(ec == error::need_more)
+                ec.assign(0, ec.category());
+            if(ec)
+                return;
+            sv.remove_prefix(used);
+            len -= used;
+            if(used == 0 && len == sv.size())
+                break;
+        }
+        if(! p.is_done())
+            p.put_eof(ec);
+    }
+
+    void
+    doRoundTrip(string_view coding,
+        std::string const& payload, std::size_t chunk)
+    {
+        response<body> res{status::ok, 11};
+        if(! coding.empty())
+            res.set(field::content_encoding, coding);
+        res.body() = payload;
+        res.prepare_payload();
+        BEAST_EXPECT(res.chunked());
+        auto const s = to_string(res);
+
+        parser<false, body> p;
+        error_code ec;
+        parse(p, s, chunk, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p.is_done());
+        BEAST_EXPECT(p.get().body() == payload);
+
+        // The raw payload is the coded form
+        if(! coding.empty() && payload.size() > 1000)
+        {
+            parser<false, string_body> p1;
+            parse(p1, s, chunk, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p1.get().body().size() < payload.size());
+        }
+    }
+
+    void
+    testRoundTrip()
+    {
+        for(auto const coding : {"gzip", "x-gzip", "deflate", "GZip", ""})
+        {
+            doRoundTrip(coding, "", 65536);
+            doRoundTrip(coding, "Hello, world!", 65536);
+            doRoundTrip(coding, "Hello, world!", 1);
+            doRoundTrip(coding, make_payload(100000), 65536);
+            doRoundTrip(coding, make_payload(100000), 1000);
+        }
+        doRoundTrip("gzip", make_payload(1000000), 8192);
+    }
+
+    void
+    testPassthrough()
+    {
+        // unsupported codings are left alone
+        response<body> res{status::ok, 11};
+        res.set(field::content_encoding, "br");
+        res.body() = "Hello, world!";
+        res.prepare_payload();
+        BEAST_EXPECT(to_string(res) ==
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Encoding: br\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "d\r\n"
+            "Hello, world!\r\n"
+            "0\r\n\r\n");
+    }
+
+    void
+    testDynamicBody()
+    {
+        // inner writer with several buffers
+        response<compressed_body<dynamic_body>> res{status::ok, 11};
+        res.set(field::content_encoding, "deflate");
+        auto const payload = make_payload(50000);
+        for(std::size_t i = 0; i < payload.size(); i += 777)
+            ostream(res.body()) << payload.substr(i, 777);
+        res.prepare_payload();
+        auto const s = to_string(res);
+
+        parser<false, compressed_body<dynamic_body>> p;
+        error_code ec;
+        parse(p, s, 4096, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(buffers_to_string(
+            p.get().body().data()) == payload);
+    }
+
+    struct visit
+    {
+        std::string& out;
+        std::size_t n = 0;
+
+        explicit
+        visit(std::string& out_)
+            : out(out_)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            n = boost::asio::buffer_size(buffers);
+            out += buffers_to_string(buffers);
+        }
+    };
+
+    void
+    testBufferBody()
+    {
+        // the compressed data is flushed when the writer pauses
+        response<compressed_body<buffer_body>> res{status::ok, 11};
+        res.set(field::content_encoding, "gzip");
+        res.chunked(true);
+        serializer<false, compressed_body<buffer_body>> sr{res};
+
+        std::string out;
+        auto const write_some =
+            [&]() -> error_code
+            {
+                error_code ec;
+                for(;;)
+                {
+                    visit v{out};
+                    sr.next(ec, v);
+                    if(ec)
+                        return ec;
+                    sr.consume(v.n);
+                    if(sr.is_done())
+                        return ec;
+                }
+            };
+
+        parser<false, compressed_body<string_body>> p;
+        p.eager(true);
+        auto const parse_all =
+            [&]
+            {
+                error_code ec;
+                auto const used = p.put(boost::asio::buffer(out), ec);
+                if(ec == error::need_more)
+                    ec.assign(0, ec.category());
+                BEAST_EXPECTS(! ec, ec.message());
+                out.erase(0, used);
+            };
+
+        std::string const part1 = "Hello, ";
+        std::string const part2 = "world!";
+        res.body().data = const_cast<char*>(part1.data());
+        res.body().size = part1.size();
+        res.body().more = true;
+        auto ec = write_some();
+        BEAST_EXPECT(ec == error::need_buffer);
+        parse_all();
+        BEAST_EXPECT(p.get().body() == part1);
+
+        res.body().data = const_cast<char*>(part2.data());
+        res.body().size = part2.size();
+        res.body().more = false;
+        ec = write_some();
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(sr.is_done());
+        parse_all();
+        BEAST_EXPECT(p.is_done());
+        BEAST_EXPECT(p.get().body() == part1 + part2);
+    }
+
+    static
+    std::string
+    deflate(std::string const& payload, zlib::Format f)
+    {
+        zlib::deflate_stream ds;
+        ds.format(f);
+        std::string coded(ds.upper_bound(payload.size()), '\0');
+        zlib::z_params zs;
+        zs.next_in = payload.data();
+        zs.avail_in = payload.size();
+        zs.next_out = &coded[0];
+        zs.avail_out = coded.size();
+        error_code ec;
+        ds.write(zs, zlib::Flush::finish, ec);
+        coded.resize(zs.total_out);
+        return coded;
+    }
+
+    static
+    std::string
+    make_message(std::string const& coded)
+    {
+        return
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Encoding: gzip\r\n"
+            "Content-Length: " + std::to_string(coded.size()) + "\r\n"
+            "\r\n" + coded;
+    }
+
+    void
+    testLimit()
+    {
+        // a small message which expands to a large payload
+        std::string const payload(1000000, '\0');
+        auto const s = make_message(
+            deflate(payload, zlib::Format::gzip));
+        BEAST_EXPECT(s.size() < 10000);
+        {
+            parser<false, compressed_body<string_body, 100000>> p;
+            error_code ec;
+            parse(p, s, 1000, ec);
+            BEAST_EXPECTS(ec == error::body_limit, ec.message());
+            BEAST_EXPECT(p.get().body().size() <= 100000);
+        }
+        {
+            parser<false, compressed_body<string_body, 1000000>> p;
+            error_code ec;
+            parse(p, s, 1000, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p.get().body() == payload);
+        }
+        {
+            parser<false, compressed_body<string_body, 999999>> p;
+            error_code ec;
+            parse(p, s, 1000, ec);
+            BEAST_EXPECTS(ec == error::body_limit, ec.message());
+        }
+    }
+
+    void
+    testTrailingData()
+    {
+        auto const payload = make_payload(1000);
+        auto const coded = deflate(payload, zlib::Format::gzip);
+        for(auto const n : {1, 100, 65536})
+        {
+            // data after the end of the compressed stream
+            parser<false, body> p;
+            error_code ec;
+            parse(p, make_message(coded + "junk"),
+                static_cast<std::size_t>(n), ec);
+            BEAST_EXPECTS(ec == zlib::error::stream_error, ec.message());
+        }
+        {
+            parser<false, body> p;
+            error_code ec;
+            parse(p, make_message(coded), 100, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p.get().body() == payload);
+        }
+    }
+
+    void
+    testReader()
+    {
+        // decode the output of zlib::deflate_stream
+        auto const payload = make_payload(30000);
+        for(auto const f : {zlib::Format::zlib, zlib::Format::gzip})
+        {
+            zlib::deflate_stream ds;
+            ds.format(f);
+            std::string coded(ds.upper_bound(payload.size()), '\0');
+            zlib::z_params zs;
+            zs.next_in = payload.data();
+            zs.avail_in = payload.size();
+            zs.next_out = &coded[0];
+            zs.avail_out = coded.size();
+            error_code ec;
+            ds.write(zs, zlib::Flush::finish, ec);
+            BEAST_EXPECT(ec == zlib::error::end_of_stream);
+            coded.resize(zs.total_out);
+
+            auto const s =
+                std::string{"HTTP/1.1 200 OK\r\nContent-Encoding: "} +
+                (f == zlib::Format::gzip ? "gzip" : "deflate") +
+                "\r\nContent-Length: " + std::to_string(coded.size()) +
+                "\r\n\r\n" + coded;
+
+            {
+                parser<false, body> p;
+                parse(p, s, 100, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(p.get().body() == payload);
+            }
+
+            // truncated
+            {
+                auto const t = s.substr(0, s.size() - 5);
+                auto const h = t.find("Content-Length: ");
+                auto const u = t.substr(0, h) + t.substr(
+                    t.find("\r\n", h) + 2);
+                parser<false, body> p;
+                parse(p, u, 100, ec);
+                BEAST_EXPECT(ec == error::partial_message);
+            }
+
+            // corrupt
+            {
+                auto t = s;
+                t[t.size() - coded.size() + coded.size() / 2] ^= 0x55;
+                parser<false, body> p;
+                parse(p, t, 100, ec);
+                BEAST_EXPECT(ec);
+            }
+        }
+    }
+
+    void
+    run() override
+    {
+        testRoundTrip();
+        testPassthrough();
+        testDynamicBody();
+        testBufferBody();
+        testReader();
+        testLimit();
+        testTrailingData();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,compressed_body);
+
+} // http
+} // beast
+} // boost
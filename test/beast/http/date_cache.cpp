@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/date_cache.hpp>
+
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/response_template.hpp>
+#include <atomic>
+#include <ctime>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class date_cache_test : public beast::unit_test::suite
+{
+public:
+    // A clock which is set by the test, with a range
+    // covering every year an IMF-fixdate can hold
+    struct test_clock
+    {
+        using duration = std::chrono::microseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<test_clock>;
+
+        static bool constexpr is_steady = false;
+
+        static std::atomic<rep>& value()
+        {
+            static std::atomic<rep> v{0};
+            return v;
+        }
+
+        static
+        time_point
+        now()
+        {
+            return time_point{duration{value().load()}};
+        }
+
+        static
+        void
+        set(std::int64_t seconds)
+        {
+            value().store(std::chrono::duration_cast<duration>(
+                std::chrono::seconds{seconds}).count());
+        }
+
+        static
+        time_point
+        at(std::int64_t seconds)
+        {
+            return time_point{std::chrono::seconds{seconds}};
+        }
+    };
+
+    using cache_type = basic_date_cache<test_clock>;
+
+    static
+    std::string
+    str(cache_type::value_type const& v)
+    {
+        return {v.data(), v.size()};
+    }
+
+    static
+    std::string
+    fmt(std::int64_t t)
+    {
+        return str(cache_type::format(test_clock::at(t)));
+    }
+
+    void
+    testFormat()
+    {
+        BEAST_EXPECT(fmt(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        BEAST_EXPECT(fmt(0)         == "Thu, 01 Jan 1970 00:00:00 GMT");
+        BEAST_EXPECT(fmt(-1)        == "Wed, 31 Dec 1969 23:59:59 GMT");
+        BEAST_EXPECT(fmt(951782400) == "Tue, 29 Feb 2000 00:00:00 GMT");
+        BEAST_EXPECT(fmt(4107542399) == "Sun, 28 Feb 2100 23:59:59 GMT");
+        BEAST_EXPECT(fmt(4107542400) == "Mon, 01 Mar 2100 00:00:00 GMT");
+        BEAST_EXPECT(fmt(253402300799) == "Fri, 31 Dec 9999 23:59:59 GMT");
+        BEAST_EXPECT(fmt(-62167219200) == "Sat, 01 Jan 0000 00:00:00 GMT");
+
+        // fractions of a second are dropped
+        BEAST_EXPECT(cache_type::format(test_clock::at(5) +
+            std::chrono::milliseconds{999}) ==
+                "Thu, 01 Jan 1970 00:00:05 GMT");
+        BEAST_EXPECT(cache_type::format(test_clock::at(0) -
+            std::chrono::milliseconds{1}) ==
+                "Wed, 31 Dec 1969 23:59:59 GMT");
+    }
+
+    // Compare with the C library over a range of dates
+    void
+    testStrftime()
+    {
+        std::int64_t const step = 86400 + 3607;
+        for(std::int64_t t = 0; t < 4102444800; t += step)
+        {
+            auto const tt = static_cast<std::time_t>(t);
+            auto const tm = std::gmtime(&tt);
+            if(! BEAST_EXPECT(tm))
+                return;
+            char buf[64];
+            auto const n = std::strftime(buf, sizeof(buf),
+                "%a, %d %b %Y %H:%M:%S GMT", tm);
+            if(fmt(t) != std::string(buf, n))
+            {
+                BEAST_EXPECTS(false, std::to_string(t));
+                return;
+            }
+        }
+        pass();
+    }
+
+    void
+    testGet()
+    {
+        test_clock::set(784111777);
+        cache_type dates;
+        BEAST_EXPECT(dates.get() == "Sun, 06 Nov 1994 08:49:37 GMT");
+
+        // same second
+        test_clock::value() += std::chrono::duration_cast<
+            test_clock::duration>(std::chrono::milliseconds{500}).count();
+        BEAST_EXPECT(dates.get() == "Sun, 06 Nov 1994 08:49:37 GMT");
+
+        // next second
+        test_clock::set(784111778);
+        BEAST_EXPECT(dates.get() == "Sun, 06 Nov 1994 08:49:38 GMT");
+
+        // the cache does not go back
+        test_clock::set(784111700);
+        BEAST_EXPECT(dates.get() == "Sun, 06 Nov 1994 08:49:38 GMT");
+
+        test_clock::set(784198177);
+        BEAST_EXPECT(dates.get() == "Mon, 07 Nov 1994 08:49:37 GMT");
+
+        // system clock
+        date_cache dates2;
+        BEAST_EXPECT(dates2.get().size() == 29);
+        BEAST_EXPECT(dates2.get().substr(25) == " GMT");
+    }
+
+    void
+    testFields()
+    {
+        test_clock::set(784111777);
+        cache_type dates;
+
+        response<empty_body> res;
+        res.set(field::date, dates.get());
+        BEAST_EXPECT(res[field::date] == "Sun, 06 Nov 1994 08:49:37 GMT");
+
+        response_template t{res.base()};
+        t.date(dates.get());
+        BEAST_EXPECT(t.date() == "Sun, 06 Nov 1994 08:49:37 GMT");
+    }
+
+    // Readers on several threads while the clock advances
+    void
+    testThreads()
+    {
+        std::int64_t const first = 1500000000;
+        std::int64_t const last = first + 200;
+        test_clock::set(first);
+        cache_type dates;
+        std::set<std::string> valid;
+        for(auto t = first; t <= last; ++t)
+            valid.insert(fmt(t));
+
+        std::atomic<bool> done{false};
+        std::atomic<std::size_t> bad{0};
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; ++i)
+            threads.emplace_back(
+                [&]
+                {
+                    while(! done.load())
+                        if(valid.count(str(dates.get())) == 0)
+                            ++bad;
+                });
+        for(auto t = first; t <= last; ++t)
+        {
+            test_clock::set(t);
+            std::this_thread::yield();
+        }
+        done = true;
+        for(auto& t : threads)
+            t.join();
+        BEAST_EXPECT(bad == 0);
+        BEAST_EXPECT(str(dates.get()) == fmt(last));
+    }
+
+    void
+    run() override
+    {
+        testFormat();
+        testStrftime();
+        testGet();
+        testFields();
+        testThreads();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,date_cache);
+
+} // http
+} // beast
+} // boost
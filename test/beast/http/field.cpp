@@ -11,6 +11,8 @@
 #include <boost/beast/http/field.hpp>
 
 #include <boost/beast/unit_test/suite.hpp>
+#include <cctype>
+#include <string>
 
 namespace boost {
 namespace beast {
@@ -394,6 +396,32 @@ public:
             };
         unknown("");
         unknown("x");
+        unknown("Acceptx");
+        unknown("Accept-");
+        unknown("Acept");
+        unknown("Content\rType");
+        unknown("Content_Type");
+        unknown("X-Request-Id");
+        unknown(std::string(100, 'a'));
+
+        // Every name round trips in any case
+        for(unsigned i = 1;
+            i <= static_cast<unsigned>(field::xref); ++i)
+        {
+            auto const f = static_cast<field>(i);
+            auto s = to_string(f).to_string();
+            BEAST_EXPECT(string_to_field(s) == f);
+            for(auto& c : s)
+                c = static_cast<char>(std::tolower(
+                    static_cast<unsigned char>(c)));
+            BEAST_EXPECT(string_to_field(s) == f);
+            for(auto& c : s)
+                c = static_cast<char>(std::toupper(
+                    static_cast<unsigned char>(c)));
+            BEAST_EXPECT(string_to_field(s) == f);
+            s.push_back('x');
+            BEAST_EXPECT(string_to_field(s) != f);
+        }
     }
 
     void run() override
@@ -11,6 +11,7 @@
 #include <boost/beast/http/fields.hpp>
 
 #include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/flat_fields.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/type_traits.hpp>
 #include <boost/beast/test/test_allocator.hpp>
@@ -402,12 +403,13 @@ public:
         BEAST_EXPECT(std::next(f.begin(), 1)->name_string() == "c");
     }
 
+    template<class Fields>
     void
     testContainer()
     {
         {
             // group fields
-            fields f;
+            Fields f;
             f.insert(field::age,   1);
             f.insert(field::body,  2);
             f.insert(field::close, 3);
@@ -430,7 +432,7 @@ public:
         }
         {
             // group fields, case insensitive
-            fields f;
+            Fields f;
             f.insert("a",  1);
             f.insert("ab", 2);
             f.insert("b",  3);
@@ -453,7 +455,7 @@ public:
         }
         {
             // verify insertion orde
-            fields f;
+            Fields f;
             f.insert( "a", 1);
             f.insert("dd", 2);
             f.insert("b",  3);
@@ -474,7 +476,7 @@ public:
 
         // equal_range
         {
-            fields f;
+            Fields f;
             f.insert("E", 1);
             f.insert("B", 2);
             f.insert("D", 3);
@@ -507,12 +509,13 @@ public:
         struct value_type {};
     };
 
+    template<class Fields>
     void
     testPreparePayload()
     {
         // GET, empty
         {
-            request<empty_body> req;
+            request<empty_body, Fields> req;
             req.version(11);
             req.method(verb::get);
 
@@ -540,7 +543,7 @@ public:
 
         // GET, sized
         {
-            request<sized_body> req;
+            request<sized_body, Fields> req;
             req.version(11);
             req.method(verb::get);
             req.body() = 50;
@@ -563,7 +566,7 @@ public:
 
         // PUT, empty
         {
-            request<empty_body> req;
+            request<empty_body, Fields> req;
             req.version(11);
             req.method(verb::put);
 
@@ -580,7 +583,7 @@ public:
 
         // PUT, sized
         {
-            request<sized_body> req;
+            request<sized_body, Fields> req;
             req.version(11);
             req.method(verb::put);
             req.body() = 50;
@@ -598,7 +601,7 @@ public:
 
         // POST, unsized
         {
-            request<unsized_body> req;
+            request<unsized_body, Fields> req;
             req.version(11);
             req.method(verb::post);
 
@@ -614,7 +617,7 @@ public:
 
         // POST, unsized HTTP/1.0
         {
-            request<unsized_body> req;
+            request<unsized_body, Fields> req;
             req.version(10);
             req.method(verb::post);
 
@@ -630,7 +633,7 @@ public:
 
         // OK, empty
         {
-            response<empty_body> res;
+            response<empty_body, Fields> res;
             res.version(11);
 
             res.prepare_payload();
@@ -646,7 +649,7 @@ public:
 
         // OK, sized
         {
-            response<sized_body> res;
+            response<sized_body, Fields> res;
             res.version(11);
             res.body() = 50;
 
@@ -663,7 +666,7 @@ public:
 
         // OK, unsized
         {
-            response<unsized_body> res;
+            response<unsized_body, Fields> res;
             res.version(11);
 
             res.prepare_payload();
@@ -672,10 +675,11 @@ public:
         }
     }
 
+    template<class Fields>
     void
     testKeepAlive()
     {
-        response<empty_body> res;
+        response<empty_body, Fields> res;
         auto const keep_alive =
             [&](bool v)
             {
@@ -837,10 +841,11 @@ public:
         test11(big);
     }
 
+    template<class Fields>
     void
     testContentLength()
     {
-        response<empty_body> res{status::ok, 11};
+        response<empty_body, Fields> res{status::ok, 11};
         BEAST_EXPECT(res.count(field::content_length) == 0);
         BEAST_EXPECT(res.count(field::transfer_encoding) == 0);
 
@@ -924,10 +929,11 @@ public:
         check(big);
     }
 
+    template<class Fields>
     void
     testChunked()
     {
-        response<empty_body> res{status::ok, 11};
+        response<empty_body, Fields> res{status::ok, 11};
         BEAST_EXPECT(res.count(field::content_length) == 0);
         BEAST_EXPECT(res.count(field::transfer_encoding) == 0);
 
@@ -995,12 +1001,18 @@ public:
         testRFC2616();
         testErase();
         testIteratorErase();
-        testContainer();
-        testPreparePayload();
 
-        testKeepAlive();
-        testContentLength();
-        testChunked();
+        testContainer<fields>();
+        testPreparePayload<fields>();
+        testKeepAlive<fields>();
+        testContentLength<fields>();
+        testChunked<fields>();
+
+        testContainer<flat_fields>();
+        testPreparePayload<flat_fields>();
+        testKeepAlive<flat_fields>();
+        testContentLength<flat_fields>();
+        testChunked<flat_fields>();
     }
 };
 
@@ -11,12 +11,21 @@
 #include <boost/beast/http/file_body.hpp>
 
 #include <boost/beast/core/buffers_prefix.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
 #include <boost/beast/core/file_stdio.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/http/parser.hpp>
+#include <boost/beast/http/read.hpp>
 #include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
 #include <boost/beast/unit_test/suite.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -97,15 +106,350 @@ public:
         boost::filesystem::remove(temp, ec);
         BEAST_EXPECTS(! ec, ec.message());
     }
+
+    struct sizes
+    {
+        std::string& out;
+        std::vector<std::size_t>& v;
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            v.push_back(boost::asio::buffer_size(buffers));
+            out += buffers_to_string(buffers);
+        }
+    };
+
+    // Serialize the body, returning the size of each body buffer
+    template<class File>
+    std::vector<std::size_t>
+    doBufferSize(std::string const& path, std::string const& data,
+        std::size_t size, bool adaptive)
+    {
+        error_code ec;
+        response<basic_file_body<File>> res{status::ok, 11};
+        res.body().open(path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        if(size)
+            res.body().buffer_size(size, adaptive);
+        res.prepare_payload();
+        serializer<false, basic_file_body<File>> sr{res};
+        sr.split(true);
+        std::string out;
+        std::vector<std::size_t> v;
+        while(! sr.is_header_done())
+        {
+            sizes visit{out, v};
+            sr.next(ec, visit);
+            BEAST_EXPECTS(! ec, ec.message());
+            sr.consume(v.back());
+        }
+        out.clear();
+        v.clear();
+        while(! sr.is_done())
+        {
+            sizes visit{out, v};
+            sr.next(ec, visit);
+            BEAST_EXPECTS(! ec, ec.message());
+            sr.consume(v.back());
+        }
+        BEAST_EXPECT(out == data);
+        return v;
+    }
+
+    template<class File>
+    void
+    testBufferSize()
+    {
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string data;
+        for(std::size_t i = 0; data.size() < 1000000; ++i)
+            data += std::to_string(i) + " ";
+        {
+            error_code ec;
+            File f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(data.data(), data.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+
+        {
+            response<basic_file_body<File>> res;
+            BEAST_EXPECT(res.body().buffer_size() == 65536);
+        }
+
+        // The default buffer grows from 4KB to 64KB
+        {
+            auto const v = doBufferSize<File>(path, data, 0, true);
+            BEAST_EXPECT(v.size() > 5);
+            BEAST_EXPECT(v[0] == 4096);
+            BEAST_EXPECT(v[1] == 8192);
+            BEAST_EXPECT(v[4] == 65536);
+            BEAST_EXPECT(*std::max_element(v.begin(), v.end()) == 65536);
+        }
+
+        // A fixed size
+        {
+            auto const v = doBufferSize<File>(path, data, 1000, false);
+            BEAST_EXPECT(v.size() == (data.size() + 999) / 1000);
+            BEAST_EXPECT(v[0] == 1000);
+            BEAST_EXPECT(v[v.size() - 2] == 1000);
+        }
+
+        // Larger than the file
+        {
+            auto const v = doBufferSize<File>(path, data, 4000000, false);
+            BEAST_EXPECT(v.size() == 1);
+        }
+
+        // Adaptive up to a larger size
+        {
+            auto const v = doBufferSize<File>(path, data, 1024 * 1024, true);
+            BEAST_EXPECT(v[0] == 4096);
+            BEAST_EXPECT(v.back() < 1024 * 1024);
+        }
+
+        error_code ec;
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+#if BOOST_BEAST_USE_SENDFILE
+    // Send a file over a loopback connection, which uses sendfile
+    void
+    doTestSendfile(std::string const& path,
+        std::string const& data, bool chunked, std::size_t limit)
+    {
+        using boost::asio::ip::tcp;
+        boost::asio::io_context ioc;
+        tcp::acceptor a{ioc, tcp::endpoint{
+            boost::asio::ip::make_address_v4("127.0.0.1"), 0}};
+        tcp::socket s1{ioc};
+        tcp::socket s2{ioc};
+        s1.connect(a.local_endpoint());
+        a.accept(s2);
+
+        auto const make_response =
+            [&]
+            {
+                response<file_body> res{status::ok, 11};
+                error_code ec;
+                res.body().open(path.c_str(), file_mode::scan, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                res.chunked(chunked);
+                res.prepare_payload();
+                return res;
+            };
+
+        // synchronous
+        {
+            auto res = make_response();
+            response<string_body> got;
+            std::thread t(
+                [&]
+                {
+                    flat_buffer b;
+                    error_code ec;
+                    read(s2, b, got, ec);
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            response_serializer<file_body> sr{res};
+            sr.limit(limit);
+            error_code ec;
+            write(s1, sr, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(sr.is_done());
+            t.join();
+            BEAST_EXPECT(got.body() == data);
+        }
+
+        // asynchronous
+        {
+            auto res = make_response();
+            response<string_body> got;
+            flat_buffer b;
+            response_serializer<file_body> sr{res};
+            sr.limit(limit);
+            std::size_t n = 0;
+            async_write(s1, sr,
+                [&](error_code ec, std::size_t bytes_transferred)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = bytes_transferred;
+                });
+            async_read(s2, b, got,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.run();
+            BEAST_EXPECT(sr.is_done());
+            BEAST_EXPECT(n >= data.size());
+            BEAST_EXPECT(got.body() == data);
+        }
+
+        // asynchronous, reading on a thread pool
+        {
+            boost::asio::thread_pool pool{2};
+            auto res = make_response();
+            res.body().read_executor(pool.get_executor());
+            response<string_body> got;
+            flat_buffer b;
+            response_serializer<file_body> sr{res};
+            sr.limit(limit);
+            std::size_t n = 0;
+            auto const id = std::this_thread::get_id();
+            async_write(s1, sr,
+                [&](error_code ec, std::size_t bytes_transferred)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(std::this_thread::get_id() == id);
+                    n = bytes_transferred;
+                });
+            async_read(s2, b, got,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.restart();
+            ioc.run();
+            BEAST_EXPECT(sr.is_done());
+            BEAST_EXPECT(n >= data.size());
+            BEAST_EXPECT(got.body() == data);
+            pool.join();
+        }
+    }
+
+    // Sending on a read executor does not copy through the buffer
+    void
+    testSendfileReadahead(std::string const& path)
+    {
+        using boost::asio::ip::tcp;
+        boost::asio::io_context ioc;
+        boost::asio::io_context pool;
+        tcp::acceptor a{ioc, tcp::endpoint{
+            boost::asio::ip::make_address_v4("127.0.0.1"), 0}};
+        tcp::socket s1{ioc};
+        tcp::socket s2{ioc};
+        s1.connect(a.local_endpoint());
+        a.accept(s2);
+
+        error_code ec;
+        response<file_body> res{status::ok, 11};
+        res.body().open(path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.body().buffer_size(16, false);
+        res.body().read_executor(pool.get_executor());
+        res.prepare_payload();
+        response_serializer<file_body> sr{res};
+        write_header(s1, sr, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+
+        std::size_t n = 0;
+        async_write_some(s1, sr,
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n = bytes_transferred;
+            });
+        pool.run();
+        ioc.run();
+        BEAST_EXPECT(n > res.body().buffer_size());
+    }
+
+    // Close the socket while the file is read on another executor
+    void
+    testSendfileClose(std::string const& path)
+    {
+        using boost::asio::ip::tcp;
+        boost::asio::io_context ioc;
+        boost::asio::io_context pool;
+        tcp::acceptor a{ioc, tcp::endpoint{
+            boost::asio::ip::make_address_v4("127.0.0.1"), 0}};
+        tcp::socket s1{ioc};
+        tcp::socket s2{ioc};
+        s1.connect(a.local_endpoint());
+        a.accept(s2);
+
+        error_code ec;
+        response<file_body> res{status::ok, 11};
+        res.body().open(path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.body().read_executor(pool.get_executor());
+        res.prepare_payload();
+        response_serializer<file_body> sr{res};
+        write_header(s1, sr, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+
+        // The read is queued on the pool, and the descriptor
+        // is reused by a new connection before it runs.
+        bool invoked = false;
+        async_write_some(s1, sr,
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                invoked = true;
+                BEAST_EXPECTS(ec == boost::asio::error::operation_aborted,
+                    ec.message());
+                BEAST_EXPECT(bytes_transferred == 0);
+            });
+        s1.close();
+        tcp::socket s3{ioc};
+        tcp::socket s4{ioc};
+        s3.connect(a.local_endpoint());
+        a.accept(s4);
+
+        pool.run();
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(! sr.is_done());
+        BEAST_EXPECT(s4.available() == 0);
+    }
+
+    void
+    testSendfile()
+    {
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string data;
+        for(std::size_t i = 0; data.size() < 3000000; ++i)
+            data += std::to_string(i) + " ";
+        {
+            error_code ec;
+            file f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(data.data(), data.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        doTestSendfile(path, data, false, 0);
+        doTestSendfile(path, data, false, 1000);
+        doTestSendfile(path, data, true, 0);
+        testSendfileReadahead(path);
+        testSendfileClose(path);
+        error_code ec;
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+#endif
+
     void
     run() override
     {
         doTestFileBody<file_stdio>();
+        testBufferSize<file_stdio>();
     #if BOOST_BEAST_USE_WIN32_FILE
         doTestFileBody<file_win32>();
+        testBufferSize<file_win32>();
     #endif
     #if BOOST_BEAST_USE_POSIX_FILE
         doTestFileBody<file_posix>();
+        testBufferSize<file_posix>();
+    #endif
+    #if BOOST_BEAST_USE_SENDFILE
+        testSendfile();
     #endif
     }
 };
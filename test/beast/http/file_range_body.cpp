@@ -0,0 +1,428 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/file_range_body.hpp>
+
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/file_stdio.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class file_range_body_test : public beast::unit_test::suite
+{
+public:
+    using range_type = std::pair<std::uint64_t, std::uint64_t>;
+
+    struct lambda
+    {
+        std::string& out;
+        std::size_t n = 0;
+
+        explicit
+        lambda(std::string& out_)
+            : out(out_)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            n = boost::asio::buffer_size(buffers);
+            out += buffers_to_string(buffers);
+        }
+    };
+
+    std::string path_;
+    std::string data_;
+
+    void
+    make_file()
+    {
+        path_ = boost::filesystem::unique_path().string<std::string>();
+        for(std::size_t i = 0; data_.size() < 100000; ++i)
+            data_ += std::to_string(i) + " ";
+        error_code ec;
+        file f;
+        f.open(path_.c_str(), file_mode::write, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        f.write(data_.data(), data_.size(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    template<class File>
+    response<basic_file_range_body<File>>
+    make_response(string_view range)
+    {
+        response<basic_file_range_body<File>> res{status::ok, 11};
+        res.set(field::content_type, "text/plain");
+        error_code ec;
+        res.body().open(path_.c_str(), file_mode::read, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        prepare_range(res, range);
+        res.prepare_payload();
+        return res;
+    }
+
+    // Returns the serialized body
+    template<class File>
+    std::string
+    serialize(response<basic_file_range_body<File>>& res)
+    {
+        serializer<false, basic_file_range_body<File>> sr{res};
+        sr.split(true);
+        std::string out;
+        error_code ec;
+        while(! sr.is_header_done())
+        {
+            lambda visit{out};
+            sr.next(ec, visit);
+            BEAST_EXPECTS(! ec, ec.message());
+            sr.consume(visit.n);
+        }
+        out.clear();
+        while(! sr.is_done())
+        {
+            lambda visit{out};
+            sr.next(ec, visit);
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                break;
+            sr.consume(visit.n);
+        }
+        BEAST_EXPECT(res.payload_size() &&
+            *res.payload_size() == out.size());
+        return out;
+    }
+
+    void
+    testParse()
+    {
+        std::vector<range_type> v;
+        auto const check =
+            [&](string_view s, std::uint64_t size,
+                detail::byte_ranges result,
+                std::vector<range_type> const& expected)
+            {
+                BEAST_EXPECTS(detail::parse_byte_ranges(
+                    s, size, v) == result, s);
+                if(result == detail::byte_ranges::ok)
+                    BEAST_EXPECTS(v == expected, s);
+            };
+        using detail::byte_ranges;
+        check("bytes=0-499", 1000, byte_ranges::ok, {{0, 499}});
+        check("bytes=500-999", 1000, byte_ranges::ok, {{500, 999}});
+        check("bytes=500-", 1000, byte_ranges::ok, {{500, 999}});
+        check("bytes=-500", 1000, byte_ranges::ok, {{500, 999}});
+        check("bytes=-5000", 1000, byte_ranges::ok, {{0, 999}});
+        check("bytes=900-5000", 1000, byte_ranges::ok, {{900, 999}});
+        check("bytes=0-0,-1", 1000, byte_ranges::ok, {{0, 0}, {999, 999}});
+        check("BYTES = 1-2 , 4-5,", 1000, byte_ranges::ok, {{1, 2}, {4, 5}});
+        check("bytes=,,1-2", 1000, byte_ranges::ok, {{1, 2}});
+        check("bytes=1000-,2-3", 1000, byte_ranges::ok, {{2, 3}});
+
+        check("bytes=1000-", 1000, byte_ranges::unsatisfiable, {});
+        check("bytes=-0", 1000, byte_ranges::unsatisfiable, {});
+        check("bytes=0-", 0, byte_ranges::unsatisfiable, {});
+        check("bytes=1000-2000,1500-", 1000, byte_ranges::unsatisfiable, {});
+
+        check("", 1000, byte_ranges::ignore, {});
+        check("bytes", 1000, byte_ranges::ignore, {});
+        check("bytes=", 1000, byte_ranges::ignore, {});
+        check("items=0-1", 1000, byte_ranges::ignore, {});
+        check("bytes=1", 1000, byte_ranges::ignore, {});
+        check("bytes=2-1", 1000, byte_ranges::ignore, {});
+        check("bytes=a-b", 1000, byte_ranges::ignore, {});
+        check("bytes=-", 1000, byte_ranges::ignore, {});
+        check("bytes=1-2;3-4", 1000, byte_ranges::ignore, {});
+        check("bytes=99999999999999999999-", 1000, byte_ranges::ignore, {});
+
+        // sorted and coalesced
+        check("bytes=500-599,0-9", 1000, byte_ranges::ok, {{0, 9}, {500, 599}});
+        check("bytes=0-9,5-14", 1000, byte_ranges::ok, {{0, 14}});
+        check("bytes=10-19,0-9", 1000, byte_ranges::ok, {{0, 19}});
+        check("bytes=0-9,0-9", 1000, byte_ranges::ok, {{0, 9}});
+        check("bytes=0-99,10-19,-1", 1000, byte_ranges::ok, {{0, 99}, {999, 999}});
+        check("bytes=0-499,500-", 1000, byte_ranges::ok, {{0, 999}});
+
+        // more than the whole file
+        check("bytes=0-,0-", 1000, byte_ranges::ignore, {});
+        check("bytes=0-599,500-999", 1000, byte_ranges::ignore, {});
+        check("bytes=-1000,0-0", 1000, byte_ranges::ignore, {});
+        {
+            std::string s = "bytes=0-";
+            for(int i = 1; i < 64; ++i)
+                s += ",0-";
+            check(s, 1000, byte_ranges::ignore, {});
+        }
+
+        std::string many = "bytes=0-0";
+        for(int i = 1; i < 65; ++i)
+            many += "," + std::to_string(i) + "-" + std::to_string(i);
+        check(many, 1000, byte_ranges::ignore, {});
+    }
+
+    template<class File>
+    void
+    testWhole()
+    {
+        for(auto const range : {"", "bytes=2-1", "pages=1-2"})
+        {
+            auto res = make_response<File>(range);
+            BEAST_EXPECT(res.result() == status::ok);
+            BEAST_EXPECT(res[field::accept_ranges] == "bytes");
+            BEAST_EXPECT(res.count(field::content_range) == 0);
+            BEAST_EXPECT(res.body().whole());
+            BEAST_EXPECT(serialize(res) == data_);
+        }
+    }
+
+    template<class File>
+    void
+    testSingle()
+    {
+        auto res = make_response<File>("bytes=50000-50099");
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(res[field::content_type] == "text/plain");
+        BEAST_EXPECT(res[field::content_range] ==
+            "bytes 50000-50099/" + std::to_string(data_.size()));
+        BEAST_EXPECT(res[field::content_length] == "100");
+        BEAST_EXPECT(serialize(res) == data_.substr(50000, 100));
+
+        // suffix
+        res = make_response<File>("bytes=-10");
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(serialize(res) == data_.substr(data_.size() - 10));
+
+        // open ended, with a small buffer
+        res = make_response<File>("bytes=1-");
+        res.body().buffer_size(100, false);
+        BEAST_EXPECT(serialize(res) == data_.substr(1));
+    }
+
+    template<class File>
+    void
+    testMultiple()
+    {
+        auto res = make_response<File>("bytes=0-9, 20000-29999, -5");
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(res.count(field::content_range) == 0);
+        auto const boundary = res.body().boundary().to_string();
+        BEAST_EXPECT(boundary.size() > 0);
+        BEAST_EXPECT(res[field::content_type] ==
+            "multipart/byteranges; boundary=" + boundary);
+        auto const size = std::to_string(data_.size());
+        BEAST_EXPECT(serialize(res) ==
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-9/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(0, 10) + "\r\n"
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 20000-29999/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(20000, 10000) + "\r\n"
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes " +
+                std::to_string(data_.size() - 5) + "-" +
+                std::to_string(data_.size() - 1) + "/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(data_.size() - 5) + "\r\n"
+            "--" + boundary + "--\r\n");
+
+        // a new, random boundary each time
+        BEAST_EXPECT(boundary.size() >= 16);
+        BEAST_EXPECT(std::all_of(boundary.begin(), boundary.end(),
+            [](char c)
+            {
+                return std::isalnum(static_cast<unsigned char>(c)) != 0;
+            }));
+        auto res2 = make_response<File>("bytes=0-0,2-2");
+        BEAST_EXPECT(res2.body().boundary() != boundary);
+    }
+
+    template<class File>
+    void
+    testOverlap()
+    {
+        // Repeated ranges would send the file many times
+        auto res = make_response<File>("bytes=0-,0-,0-,0-");
+        BEAST_EXPECT(res.result() == status::ok);
+        BEAST_EXPECT(res.body().whole());
+        BEAST_EXPECT(res.count(field::content_range) == 0);
+        BEAST_EXPECT(serialize(res) == data_);
+
+        // Overlapping ranges are sent once, in order
+        res = make_response<File>("bytes=200-299,0-99,50-149");
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(res.body().ranges().size() == 2);
+        auto const boundary = res.body().boundary().to_string();
+        auto const size = std::to_string(data_.size());
+        BEAST_EXPECT(serialize(res) ==
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-149/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(0, 150) + "\r\n"
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 200-299/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(200, 100) + "\r\n"
+            "--" + boundary + "--\r\n");
+
+        // Coalesced into a single range
+        res = make_response<File>("bytes=10-19,0-9");
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(res.body().boundary().empty());
+        BEAST_EXPECT(res[field::content_range] ==
+            "bytes 0-19/" + size);
+        BEAST_EXPECT(res[field::content_type] == "text/plain");
+        BEAST_EXPECT(serialize(res) == data_.substr(0, 20));
+    }
+
+    template<class File>
+    void
+    testReset()
+    {
+        auto res = make_response<File>("bytes=0-0,2-2");
+        BEAST_EXPECT(! res.body().boundary().empty());
+
+        // a file which is not open fails, leaving nothing behind
+        error_code ec;
+        res.body().reset(File{}, ec);
+        BEAST_EXPECT(ec);
+        BEAST_EXPECT(! res.body().is_open());
+        BEAST_EXPECT(res.body().whole());
+        BEAST_EXPECT(res.body().ranges().empty());
+        BEAST_EXPECT(res.body().boundary().empty());
+        BEAST_EXPECT(res.body().size() == 0);
+        BEAST_EXPECT(res.body().file_size() == 0);
+
+        // open clears the ranges
+        res = make_response<File>("bytes=0-0,2-2");
+        res.body().open(path_.c_str(), file_mode::read, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(res.body().whole());
+        BEAST_EXPECT(res.body().boundary().empty());
+        BEAST_EXPECT(res.body().size() == data_.size());
+    }
+
+    template<class File>
+    void
+    testPrepareAgain()
+    {
+        auto const size = std::to_string(data_.size());
+
+        // the parts keep the type of the file
+        auto res = make_response<File>("bytes=0-0,2-2");
+        prepare_range(res, "bytes=0-0,2-2");
+        res.prepare_payload();
+        auto const boundary = res.body().boundary().to_string();
+        BEAST_EXPECT(res[field::content_type] ==
+            "multipart/byteranges; boundary=" + boundary);
+        BEAST_EXPECT(serialize(res) ==
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-0/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(0, 1) + "\r\n"
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 2-2/" + size + "\r\n"
+            "\r\n" +
+            data_.substr(2, 1) + "\r\n"
+            "--" + boundary + "--\r\n");
+
+        // a single range
+        prepare_range(res, "bytes=0-9");
+        res.prepare_payload();
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(res[field::content_type] == "text/plain");
+        BEAST_EXPECT(serialize(res) == data_.substr(0, 10));
+
+        // the whole file
+        prepare_range(res, "");
+        res.prepare_payload();
+        BEAST_EXPECT(res.result() == status::ok);
+        BEAST_EXPECT(res.count(field::content_range) == 0);
+        BEAST_EXPECT(res[field::content_type] == "text/plain");
+        BEAST_EXPECT(serialize(res) == data_);
+
+        // reopening the file loses the recorded type
+        res = make_response<File>("bytes=0-0,2-2");
+        error_code ec;
+        res.body().open(path_.c_str(), file_mode::read, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        prepare_range(res, "bytes=0-0,2-2");
+        BEAST_EXPECT(res.body().boundary().size() > 0);
+        res.prepare_payload();
+        BEAST_EXPECT(serialize(res).find(
+            "Content-Type: multipart") == std::string::npos);
+    }
+
+    template<class File>
+    void
+    testUnsatisfiable()
+    {
+        auto res = make_response<File>(
+            "bytes=" + std::to_string(data_.size()) + "-");
+        BEAST_EXPECT(res.result() == status::range_not_satisfiable);
+        BEAST_EXPECT(res[field::content_range] ==
+            "bytes */" + std::to_string(data_.size()));
+        BEAST_EXPECT(! res.body().whole());
+        BEAST_EXPECT(serialize(res).empty());
+
+        // the body can be reused for another range
+        prepare_range(res, "bytes=0-1");
+        res.prepare_payload();
+        BEAST_EXPECT(res.result() == status::partial_content);
+        BEAST_EXPECT(serialize(res) == data_.substr(0, 2));
+    }
+
+    template<class File>
+    void
+    doTest()
+    {
+        testWhole<File>();
+        testSingle<File>();
+        testMultiple<File>();
+        testUnsatisfiable<File>();
+        testOverlap<File>();
+        testReset<File>();
+        testPrepareAgain<File>();
+    }
+
+    void
+    run() override
+    {
+        testParse();
+        make_file();
+        doTest<file>();
+        doTest<file_stdio>();
+        error_code ec;
+        boost::filesystem::remove(path_, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,file_range_body);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,436 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/flat_fields.hpp>
+
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/test/test_allocator.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <sstream>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class flat_fields_test : public beast::unit_test::suite
+{
+public:
+    // Hands out memory from a fixed buffer,
+    // and counts the number of allocations.
+    struct arena
+    {
+        char buf[8192];
+        std::size_t used = 0;
+        std::size_t count = 0;
+    };
+
+    template<class T>
+    class arena_allocator
+    {
+        template<class U>
+        friend class arena_allocator;
+
+        arena* a_;
+
+    public:
+        using value_type = T;
+
+        explicit
+        arena_allocator(arena& a) noexcept
+            : a_(&a)
+        {
+        }
+
+        template<class U>
+        arena_allocator(arena_allocator<U> const& other) noexcept
+            : a_(other.a_)
+        {
+        }
+
+        value_type*
+        allocate(std::size_t n)
+        {
+            auto const size = (n * sizeof(T) + 15) & ~std::size_t{15};
+            if(size > sizeof(a_->buf) - a_->used)
+                BOOST_THROW_EXCEPTION(std::bad_alloc{});
+            auto const p = a_->buf + a_->used;
+            a_->used += size;
+            ++a_->count;
+            return reinterpret_cast<value_type*>(p);
+        }
+
+        void
+        deallocate(value_type*, std::size_t) noexcept
+        {
+        }
+
+        template<class U>
+        friend
+        bool
+        operator==(arena_allocator const& lhs,
+            arena_allocator<U> const& rhs) noexcept
+        {
+            return lhs.a_ == rhs.a_;
+        }
+
+        template<class U>
+        friend
+        bool
+        operator!=(arena_allocator const& lhs,
+            arena_allocator<U> const& rhs) noexcept
+        {
+            return ! (lhs == rhs);
+        }
+    };
+
+    using arena_fields = basic_flat_fields<arena_allocator<char>>;
+
+    BOOST_STATIC_ASSERT(is_fields<flat_fields>::value);
+    BOOST_STATIC_ASSERT(is_fields<arena_fields>::value);
+    BOOST_STATIC_ASSERT(std::is_nothrow_move_constructible<flat_fields>::value);
+    BOOST_STATIC_ASSERT(std::is_nothrow_move_assignable<flat_fields>::value);
+
+    template<class Fields>
+    static
+    std::size_t
+    size(Fields const& f)
+    {
+        return std::distance(f.begin(), f.end());
+    }
+
+    template<bool isRequest, class Fields>
+    static
+    std::string
+    to_string(header<isRequest, Fields> const& h)
+    {
+        std::stringstream ss;
+        ss << h;
+        return ss.str();
+    }
+
+    // Fill a request header with the same content in both containers
+    template<class Fields>
+    static
+    void
+    fill(request_header<Fields>& req)
+    {
+        req.method(verb::get);
+        req.target("/index.html");
+        req.version(11);
+        req.set(field::host, "www.example.com");
+        req.set(field::user_agent, "Beast");
+        req.set(field::accept, "text/html");
+        req.insert("X-Custom", "1");
+        req.set(field::accept_encoding, "gzip, deflate");
+        req.insert("x-custom", "2");
+        req.set(field::connection, "keep-alive");
+    }
+
+    void
+    testMembers()
+    {
+        using namespace test;
+
+        // compare equal
+        using equal_t = test::test_allocator<char,
+            true, true, true, true, true>;
+
+        // compare not equal
+        using unequal_t = test::test_allocator<char,
+            false, true, true, true, true>;
+
+        // construction
+        {
+            flat_fields f;
+            BEAST_EXPECT(f.begin() == f.end());
+            unequal_t a1;
+            basic_flat_fields<unequal_t> f2{a1};
+            BEAST_EXPECT(f2.get_allocator() == a1);
+            BEAST_EXPECT(f2.get_allocator() != unequal_t{});
+        }
+
+        // move construction
+        {
+            flat_fields f1;
+            f1.insert("1", "1");
+            flat_fields f2{std::move(f1)};
+            BEAST_EXPECT(f2["1"] == "1");
+            BEAST_EXPECT(f1["1"] == "");
+            BEAST_EXPECT(size(f1) == 0);
+        }
+        {
+            basic_flat_fields<unequal_t> f1;
+            f1.insert("1", "1");
+            unequal_t a;
+            basic_flat_fields<unequal_t> f2{std::move(f1), a};
+            BEAST_EXPECT(f2["1"] == "1");
+            BEAST_EXPECT(size(f1) == 0);
+        }
+        {
+            basic_flat_fields<equal_t> f1;
+            f1.insert("1", "1");
+            equal_t a;
+            basic_flat_fields<equal_t> f2{std::move(f1), a};
+            BEAST_EXPECT(f2["1"] == "1");
+            BEAST_EXPECT(size(f1) == 0);
+        }
+
+        // copy construction
+        {
+            flat_fields f1;
+            f1.insert("1", "1");
+            f1.insert("2", "2");
+            flat_fields f2{f1};
+            BEAST_EXPECT(f1["1"] == "1");
+            BEAST_EXPECT(f2["1"] == "1");
+            BEAST_EXPECT(f2["2"] == "2");
+            BEAST_EXPECT(f1.begin()->value().data() !=
+                f2.begin()->value().data());
+            basic_flat_fields<unequal_t> f3;
+            f3.insert("1", "1");
+            unequal_t a;
+            basic_flat_fields<unequal_t> f4(f3, a);
+            BEAST_EXPECT(f4.get_allocator() == a);
+            BEAST_EXPECT(f4["1"] == "1");
+        }
+
+        // move assignment
+        {
+            flat_fields f1;
+            f1.insert("1", "1");
+            flat_fields f2;
+            f2.insert("2", "2");
+            f2 = std::move(f1);
+            BEAST_EXPECT(f1.begin() == f1.end());
+            BEAST_EXPECT(f2["1"] == "1");
+            BEAST_EXPECT(f2.count("2") == 0);
+        }
+        {
+            // propagate_on_container_move_assignment : false
+            using pocma_t = test::test_allocator<char,
+                false, true, false, true, true>;
+            basic_flat_fields<pocma_t> f1;
+            f1.insert("1", "1");
+            basic_flat_fields<pocma_t> f2;
+            f2 = std::move(f1);
+            BEAST_EXPECT(f1.begin() == f1.end());
+            BEAST_EXPECT(f2["1"] == "1");
+        }
+
+        // copy assignment
+        {
+            flat_fields f1;
+            f1.insert("1", "1");
+            flat_fields f2;
+            f2 = f1;
+            BEAST_EXPECT(f1["1"] == "1");
+            BEAST_EXPECT(f2["1"] == "1");
+            auto const& f3 = f2;
+            f2 = f3;
+            BEAST_EXPECT(f2["1"] == "1");
+        }
+
+        // swap
+        {
+            using pocs_t = test::test_allocator<char,
+                false, true, true, true, true>;
+            pocs_t a1, a2;
+            basic_flat_fields<pocs_t> f1{a1};
+            f1.insert("1", "1");
+            basic_flat_fields<pocs_t> f2{a2};
+            swap(f1, f2);
+            BEAST_EXPECT(f1.get_allocator() == a2);
+            BEAST_EXPECT(f2.get_allocator() == a1);
+            BEAST_EXPECT(f1.begin() == f1.end());
+            BEAST_EXPECT(f2["1"] == "1");
+        }
+    }
+
+    void
+    testModifiers()
+    {
+        // erase from the middle, lookup and at
+        {
+            flat_fields f;
+            f.insert(field::age, 1);
+            f.insert("X", 2);
+            f.insert(field::body, 3);
+            BEAST_EXPECT(f.at(field::body) == "3");
+            BEAST_EXPECT(f.at("x") == "2");
+            BEAST_EXPECT(f[field::close] == "");
+            try
+            {
+                f.at(field::close);
+                fail();
+            }
+            catch(std::out_of_range const&)
+            {
+                pass();
+            }
+            auto it = f.erase(std::next(f.begin()));
+            BEAST_EXPECT(it->name() == field::body);
+            BEAST_EXPECT(f.count("X") == 0);
+            BEAST_EXPECT(f[field::age] == "1");
+            BEAST_EXPECT(f[field::body] == "3");
+            it = f.erase(it);
+            BEAST_EXPECT(it == f.end());
+            BEAST_EXPECT(size(f) == 1);
+            f.clear();
+            BEAST_EXPECT(size(f) == 0);
+            BEAST_EXPECT(f.count(field::age) == 0);
+            f.insert(field::age, 4);
+            BEAST_EXPECT(f[field::age] == "4");
+        }
+
+        // values are trimmed, and may refer to the container
+        {
+            flat_fields f;
+            f.insert("A", " 1 ");
+            BEAST_EXPECT(f["A"] == "1");
+            for(int i = 0; i < 100; ++i)
+                f.insert("B", f["A"]);
+            BEAST_EXPECT(f.count("b") == 100);
+            f.set("A", f.begin()->name_string());
+            BEAST_EXPECT(f["A"] == "A");
+            f.set("A", std::string(10000, '*'));
+            f.set("C", f["A"]);
+            BEAST_EXPECT(f["C"] == std::string(10000, '*'));
+        }
+
+        // the method and target move the fields
+        {
+            request_header<flat_fields> req;
+            req.set(field::host, "example.com");
+            req.method_string("FOO");
+            req.target("/");
+            BEAST_EXPECT(req.method_string() == "FOO");
+            BEAST_EXPECT(req.target() == "/");
+            req.target(std::string(1000, '/'));
+            BEAST_EXPECT(req[field::host] == "example.com");
+            req.method_string(req.target());
+            BEAST_EXPECT(req.method_string() == req.target());
+            req.method(verb::get);
+            req.target("");
+            BEAST_EXPECT(req.target() == "");
+            BEAST_EXPECT(req[field::host] == "example.com");
+        }
+
+        // too large
+        {
+            flat_fields f;
+            try
+            {
+                f.insert("X", std::string(70000, '*'));
+                fail();
+            }
+            catch(std::length_error const&)
+            {
+                pass();
+            }
+            BEAST_EXPECT(size(f) == 0);
+        }
+    }
+
+    void
+    testSerialize()
+    {
+        {
+            request_header<fields> r1;
+            request_header<flat_fields> r2;
+            fill(r1);
+            fill(r2);
+            BEAST_EXPECT(to_string(r1) == to_string(r2));
+            BEAST_EXPECT(std::next(r2.begin(), 4)->value() == "2");
+            r1.erase(field::user_agent);
+            r2.erase(field::user_agent);
+            r1.method_string("PURGE");
+            r2.method_string("PURGE");
+            BEAST_EXPECT(to_string(r1) == to_string(r2));
+        }
+        {
+            response<string_body, fields> r1{status::not_found, 10};
+            response<string_body, flat_fields> r2{status::not_found, 10};
+            r1.reason("Gone Fishing");
+            r2.reason("Gone Fishing");
+            r1.set(field::server, "Beast");
+            r2.set(field::server, "Beast");
+            r1.body() = "*";
+            r2.body() = "*";
+            r1.prepare_payload();
+            r2.prepare_payload();
+            BEAST_EXPECT(to_string(r1.base()) == to_string(r2.base()));
+            std::stringstream s1;
+            s1 << r1;
+            std::stringstream s2;
+            s2 << r2;
+            BEAST_EXPECT(s1.str() == s2.str());
+        }
+        {
+            // trailers
+            flat_fields f;
+            f.insert(field::expires, "never");
+            f.insert("Checksum", "0");
+            flat_fields::writer w{f};
+            BEAST_EXPECT(buffers_to_string(w.get()) ==
+                "Expires: never\r\nChecksum: 0\r\n\r\n");
+        }
+    }
+
+    void
+    testArena()
+    {
+        // A typical request costs one allocation
+        arena a;
+        {
+            request_header<arena_fields> req{
+                arena_allocator<char>{a}};
+            fill(req);
+            for(int i = 0; i < 8; ++i)
+                req.insert("X-Field-" + std::to_string(i), i);
+            BEAST_EXPECT(a.count == 1);
+            BEAST_EXPECT(req.count("x-custom") == 2);
+            BEAST_EXPECT(req["X-Field-7"] == "7");
+        }
+
+        // Growth keeps the contents
+        {
+            flat_fields f;
+            for(int i = 0; i < 1000; ++i)
+                f.insert(std::to_string(i % 10), i);
+            BEAST_EXPECT(size(f) == 1000);
+            BEAST_EXPECT(f.count("7") == 100);
+            auto const r = f.equal_range("7");
+            BEAST_EXPECT(r.first->value() == "7");
+            BEAST_EXPECT(std::prev(r.second)->value() == "997");
+        }
+    }
+
+    void
+    run() override
+    {
+        testMembers();
+        testModifiers();
+        testSerialize();
+        testArena();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,flat_fields);
+
+} // http
+} // beast
+} // boost
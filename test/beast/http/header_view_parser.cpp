@@ -0,0 +1,450 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/header_view_parser.hpp>
+
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/ostream.hpp>
+#include <boost/beast/experimental/test/stream.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/parser.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <algorithm>
+#include <array>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class header_view_parser_test : public beast::unit_test::suite
+{
+public:
+    boost::asio::io_context ioc_;
+
+    static
+    boost::asio::const_buffer
+    buf(string_view s)
+    {
+        return {s.data(), s.size()};
+    }
+
+    // Returns `true` if `s` lies within `buffer`
+    static
+    bool
+    within(string_view s, string_view buffer)
+    {
+        return std::less_equal<char const*>{}(
+                buffer.data(), s.data()) &&
+            std::less_equal<char const*>{}(
+                s.data() + s.size(), buffer.data() + buffer.size());
+    }
+
+    template<bool isRequest>
+    void
+    checkFields(
+        header_view_parser<isRequest> const& p,
+        header<isRequest> const& h)
+    {
+        BEAST_EXPECT(p.version() == h.version());
+        BEAST_EXPECT(static_cast<std::size_t>(
+            std::distance(p.begin(), p.end())) ==
+            static_cast<std::size_t>(
+                std::distance(h.begin(), h.end())));
+        // basic_fields groups fields with the same name,
+        // the views present them in the order received.
+        for(auto it = p.begin(); it != p.end(); ++it)
+        {
+            auto const ordinal = std::count_if(p.begin(), it,
+                [&](typename header_view_parser<
+                    isRequest>::value_type const& e)
+                {
+                    return iequals(e.name_string(), it->name_string());
+                });
+            auto const r = h.equal_range(it->name_string());
+            auto hit = r.first;
+            for(auto i = ordinal; i > 0 && hit != r.second; --i)
+                ++hit;
+            if(! BEAST_EXPECT(hit != r.second))
+                continue;
+            BEAST_EXPECT(it->name() == hit->name());
+            BEAST_EXPECT(it->name_string() == hit->name_string());
+            BEAST_EXPECT(it->value() == hit->value());
+        }
+    }
+
+    void
+    check(
+        header_view_parser<true> const& p,
+        header<true> const& h)
+    {
+        BEAST_EXPECT(p.method() == h.method());
+        BEAST_EXPECT(p.method_string() == h.method_string());
+        BEAST_EXPECT(p.target() == h.target());
+        checkFields(p, h);
+    }
+
+    void
+    check(
+        header_view_parser<false> const& p,
+        header<false> const& h)
+    {
+        BEAST_EXPECT(p.result_int() == h.result_int());
+        if(! p.reason().empty())
+            BEAST_EXPECT(p.reason() == h.reason());
+        checkFields(p, h);
+    }
+
+    // Parse with both parsers, splitting the input at every position
+    template<bool isRequest>
+    void
+    doMatrix(string_view s)
+    {
+        error_code ec;
+        parser<isRequest, empty_body> p0;
+        p0.put(buf(s), ec);
+        if(! BEAST_EXPECTS(! ec, ec.message()))
+            return;
+        BEAST_EXPECT(p0.is_header_done());
+        for(std::size_t n = 0; n < s.size(); ++n)
+        {
+            header_view_parser<isRequest> p;
+            auto used = p.put(buf(s.substr(0, n)), ec);
+            // Nothing is consumed until the header is complete
+            BEAST_EXPECT(used == 0);
+            BEAST_EXPECTS(ec == error::need_more, ec.message());
+            used = p.put(buf(s), ec);
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                continue;
+            BEAST_EXPECT(used == s.size());
+            BEAST_EXPECT(p.is_header_done());
+            BEAST_EXPECT(! p.is_pinned());
+            check(p, p0.get().base());
+            for(auto const& e : p)
+            {
+                BEAST_EXPECT(within(e.name_string(), s));
+                BEAST_EXPECT(within(e.value(), s));
+            }
+        }
+    }
+
+    void
+    testParse()
+    {
+        doMatrix<true>(
+            "GET /index.html HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "User-Agent: test\r\n"
+            "Accept: */*\r\n"
+            "X-Custom:   first  \r\n"
+            "accept: text/html\r\n"
+            "Empty:\r\n"
+            "x-custom: second\r\n"
+            "\r\n");
+        doMatrix<true>(
+            "FROB * HTTP/1.0\r\n"
+            "\r\n");
+        doMatrix<false>(
+            "HTTP/1.1 404 Not Found\r\n"
+            "Server: test\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n");
+        doMatrix<false>(
+            "HTTP/1.0 299 \r\n"
+            "\r\n");
+    }
+
+    void
+    testLookup()
+    {
+        string_view const s =
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "X-Custom: one\r\n"
+            "Accept: a\r\n"
+            "x-custom: two\r\n"
+            "ACCEPT: b\r\n"
+            "\r\n";
+        error_code ec;
+        request_header_view_parser<> p;
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p.method() == verb::get);
+        BEAST_EXPECT(p.target() == "/");
+        BEAST_EXPECT(p.version() == 11);
+        BEAST_EXPECT(p[field::host] == "localhost");
+        BEAST_EXPECT(p["host"] == "localhost");
+        BEAST_EXPECT(p[field::accept] == "a");
+        BEAST_EXPECT(p["X-CUSTOM"] == "one");
+        BEAST_EXPECT(p[field::server].empty());
+        BEAST_EXPECT(p["X-Missing"].empty());
+        BEAST_EXPECT(p.count(field::accept) == 2);
+        BEAST_EXPECT(p.count("Accept") == 2);
+        BEAST_EXPECT(p.count("x-custom") == 2);
+        BEAST_EXPECT(p.count("x-missing") == 0);
+        BEAST_EXPECT(p.find(field::server) == p.end());
+        BEAST_EXPECT(p.find("x-missing") == p.end());
+        auto it = p.find("X-Custom");
+        if(BEAST_EXPECT(it != p.end()))
+        {
+            BEAST_EXPECT(it->name() == field::unknown);
+            BEAST_EXPECT(it->name_string() == "X-Custom");
+            BEAST_EXPECT(it - p.begin() == 1);
+        }
+        BEAST_EXPECT(p.cend() - p.cbegin() == 5);
+
+        response_header_view_parser<> p2;
+        p2.put(buf(
+            "HTTP/1.1 299 Whatever\r\n"
+            "\r\n"), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p2.result() == status::unknown);
+        BEAST_EXPECT(p2.result_int() == 299);
+        BEAST_EXPECT(p2.reason() == "Whatever");
+        BEAST_EXPECT(p2.begin() == p2.end());
+    }
+
+    void
+    testPin()
+    {
+        std::string s =
+            "HTTP/1.1 200 OK\r\n"
+            "Server: test\r\n"
+            "Set-Cookie: a=1\r\n"
+            "\r\n";
+        error_code ec;
+        response_header_view_parser<> p;
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(! p.is_pinned());
+        BEAST_EXPECT(within(p[field::server], s));
+        p.pin();
+        BEAST_EXPECT(p.is_pinned());
+        p.pin();
+        std::fill(&s[0], &s[0] + s.size(), '*');
+        BEAST_EXPECT(p.result() == status::ok);
+        BEAST_EXPECT(p.reason() == "OK");
+        BEAST_EXPECT(p[field::server] == "test");
+        BEAST_EXPECT(p.begin()->name_string() == "Server");
+        BEAST_EXPECT(p[field::set_cookie] == "a=1");
+        BEAST_EXPECT(! within(p[field::server], s));
+    }
+
+    void
+    testMultiBuffer()
+    {
+        // The parser flattens the input into
+        // temporary storage, so the header is pinned.
+        std::string s1 =
+            "GET / HTTP/1.1\r\n"
+            "Host: loc";
+        std::string s2 =
+            "alhost\r\n"
+            "User-Agent: test\r\n"
+            "\r\n";
+        std::string s = s1 + s2;
+        error_code ec;
+        request_header_view_parser<> p;
+        auto const used =
+            p.put(buffers_cat(buf(s1), buf(s2)), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(used == s1.size() + s2.size());
+        BEAST_EXPECT(p.is_pinned());
+        std::fill(&s1[0], &s1[0] + s1.size(), '*');
+        std::fill(&s2[0], &s2[0] + s2.size(), '*');
+        BEAST_EXPECT(p.method_string() == "GET");
+        BEAST_EXPECT(p[field::host] == "localhost");
+        BEAST_EXPECT(p[field::user_agent] == "test");
+
+        // A single buffer is used in place
+        request_header_view_parser<> p2;
+        std::array<boost::asio::const_buffer, 1> const bs{{buf(s)}};
+        p2.put(bs, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(! p2.is_pinned());
+    }
+
+    void
+    testObsFold()
+    {
+        std::string s =
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "X-Folded: one\r\n"
+            "  two\r\n"
+            "\tthree\r\n"
+            "X-Leading:\r\n"
+            " value\r\n"
+            "User-Agent: test\r\n"
+            "\r\n";
+        error_code ec;
+        request_header_view_parser<> p;
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p.is_pinned());
+        std::fill(&s[0], &s[0] + s.size(), '*');
+        BEAST_EXPECT(p[field::host] == "localhost");
+        BEAST_EXPECT(p["X-Folded"] == "one two three");
+        BEAST_EXPECT(p["X-Leading"] == "value");
+        BEAST_EXPECT(p[field::user_agent] == "test");
+
+        // A leading empty line is not a copy
+        string_view const s2 =
+            "GET / HTTP/1.1\r\n"
+            "X-Leading:\r\n"
+            " value\r\n"
+            "\r\n";
+        request_header_view_parser<> p2;
+        p2.put(buf(s2), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(! p2.is_pinned());
+        BEAST_EXPECT(p2["X-Leading"] == "value");
+    }
+
+    void
+    testMaterialize()
+    {
+        string_view const s =
+            "GET /a HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n";
+        error_code ec;
+        request_header_view_parser<> p;
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        auto& h = p.get();
+        BEAST_EXPECT(&p.get() == &h);
+        BEAST_EXPECT(h.method() == verb::get);
+        BEAST_EXPECT(h.target() == "/a");
+        BEAST_EXPECT(h.version() == 11);
+        BEAST_EXPECT(h[field::host] == "localhost");
+        h.target("/b");
+        h.erase(field::connection);
+        h.set(field::via, "1.1 proxy");
+        // The views show the header as received
+        BEAST_EXPECT(p.target() == "/a");
+        BEAST_EXPECT(p[field::connection] == "keep-alive");
+        BEAST_EXPECT(p.count(field::via) == 0);
+        auto h2 = p.release();
+        BEAST_EXPECT(h2.target() == "/b");
+        BEAST_EXPECT(h2.count(field::connection) == 0);
+        BEAST_EXPECT(h2[field::via] == "1.1 proxy");
+        BEAST_EXPECT(p.get().target() == "/a");
+
+        // unknown method
+        request_header_view_parser<> p2;
+        p2.put(buf(
+            "FROB / HTTP/1.0\r\n"
+            "\r\n"), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p2.method() == verb::unknown);
+        BEAST_EXPECT(p2.get().method_string() == "FROB");
+        BEAST_EXPECT(p2.get().version() == 10);
+
+        response_header_view_parser<> p3;
+        p3.put(buf(
+            "HTTP/1.1 404 Nope\r\n"
+            "Server: test\r\n"
+            "\r\n"), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        auto const h3 = p3.release();
+        BEAST_EXPECT(h3.result() == status::not_found);
+        BEAST_EXPECT(h3.reason() == "Nope");
+        BEAST_EXPECT(h3[field::server] == "test");
+    }
+
+    void
+    testBody()
+    {
+        string_view const s =
+            "POST / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n"
+            "Hello";
+        {
+            error_code ec;
+            request_header_view_parser<> p;
+            p.eager(true);
+            p.put(buf(s), ec);
+            BEAST_EXPECTS(ec == error::unexpected_body, ec.message());
+        }
+        {
+            error_code ec;
+            request_header_view_parser<> p;
+            auto const used = p.put(buf(s), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p.is_header_done());
+            p.get().set(field::via, "1.1 proxy");
+            request_parser<string_body> p2{std::move(p)};
+            p2.put(buf(s.substr(used)), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p2.is_done());
+            auto const& m = p2.get();
+            BEAST_EXPECT(m.method() == verb::post);
+            BEAST_EXPECT(m[field::host] == "localhost");
+            BEAST_EXPECT(m[field::via] == "1.1 proxy");
+            BEAST_EXPECT(m.body() == "Hello");
+        }
+    }
+
+    void
+    testRead()
+    {
+        test::stream c{ioc_};
+        c.read_size(3);
+        ostream(c.buffer()) <<
+            "POST /upload HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "User-Agent: test\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "5\r\n"
+            "Hello\r\n"
+            "0\r\n\r\n";
+        flat_buffer b;
+        request_header_view_parser<> p;
+        error_code ec;
+        read_header(c, b, p, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(! p.is_pinned());
+        BEAST_EXPECT(p.target() == "/upload");
+        BEAST_EXPECT(p[field::user_agent] == "test");
+        BEAST_EXPECT(p.chunked());
+        request_parser<string_body> p2{std::move(p)};
+        read(c, b, p2, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p2.get().target() == "/upload");
+        BEAST_EXPECT(p2.get()[field::host] == "localhost");
+        BEAST_EXPECT(p2.get().body() == "Hello");
+    }
+
+    void
+    run() override
+    {
+        testParse();
+        testLookup();
+        testPin();
+        testMultiBuffer();
+        testObsFold();
+        testMaterialize();
+        testBody();
+        testRead();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,header_view_parser);
+
+} // http
+} // beast
+} // boost
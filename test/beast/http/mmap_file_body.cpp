@@ -0,0 +1,256 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/mmap_file_body.hpp>
+
+#if BOOST_BEAST_USE_MMAP_FILE
+
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/parser.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class mmap_file_body_test : public beast::unit_test::suite
+{
+public:
+    struct lambda
+    {
+        std::string& out;
+        std::size_t n = 0;
+        std::size_t count = 0;
+
+        explicit
+        lambda(std::string& out_)
+            : out(out_)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            n = boost::asio::buffer_size(buffers);
+            out += buffers_to_string(buffers);
+            ++count;
+        }
+    };
+
+    static
+    std::string
+    make_payload(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(static_cast<char>('a' + i % 26));
+        return s;
+    }
+
+    static
+    void
+    write_file(std::string const& path, std::string const& s)
+    {
+        std::ofstream os(path, std::ios::binary);
+        os.write(s.data(), s.size());
+    }
+
+    static
+    std::string
+    read_file(std::string const& path)
+    {
+        std::ifstream is(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>{is},
+            std::istreambuf_iterator<char>{}};
+    }
+
+    // Serialize the file, returning the number of calls to the visitor
+    std::size_t
+    serialize(std::string const& path, file_mode mode,
+        std::size_t limit, std::string& out)
+    {
+        error_code ec;
+        response<mmap_file_body> res{status::ok, 11};
+        res.body().open(path.c_str(), mode, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.prepare_payload();
+        serializer<false, mmap_file_body> sr{res};
+        if(limit)
+            sr.limit(limit);
+        std::size_t calls = 0;
+        while(! sr.is_done())
+        {
+            lambda visit{out};
+            sr.next(ec, visit);
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                break;
+            sr.consume(visit.n);
+            ++calls;
+        }
+        return calls;
+    }
+
+    void
+    testWriter()
+    {
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        auto const payload = make_payload(1000000);
+        write_file(path, payload);
+        std::string const header =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 1000000\r\n"
+            "\r\n";
+
+        // The mapping is presented in a single buffer
+        {
+            std::string out;
+            auto const calls = serialize(
+                path, file_mode::scan, 0, out);
+            BEAST_EXPECT(calls == 1);
+            BEAST_EXPECT(out == header + payload);
+        }
+
+        // Partial writes
+        {
+            std::string out;
+            auto const calls = serialize(
+                path, file_mode::read, 10000, out);
+            BEAST_EXPECT(calls > 100);
+            BEAST_EXPECT(out == header + payload);
+        }
+
+        // Unmapped files are read in pieces
+        {
+            std::string out;
+            serialize(path, file_mode::append_existing, 0, out);
+            BEAST_EXPECT(out == header + payload);
+        }
+
+        // Empty file
+        {
+            write_file(path, "");
+            std::string out;
+            serialize(path, file_mode::scan, 0, out);
+            BEAST_EXPECT(out ==
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n");
+        }
+
+        error_code ec;
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    doParse(std::string const& s, std::string const& payload)
+    {
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        error_code ec;
+        {
+            response_parser<mmap_file_body> p;
+            p.eager(true);
+            p.get().body().open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            string_view sv = s;
+            while(! p.is_done())
+            {
+                auto const n = p.put(boost::asio::buffer(
+                    sv.data(), (std::min)(sv.size(),
+                        std::size_t{65536})), ec);
+                if(! BEAST_EXPECTS(! ec, ec.message()))
+                    break;
+                sv.remove_prefix(n);
+            }
+        }
+        BEAST_EXPECT(read_file(path) == payload);
+        boost::filesystem::remove(temp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    testReader()
+    {
+        auto const payload = make_payload(300000);
+
+        // With a Content-Length the body lands in the mapping
+        doParse(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 300000\r\n"
+            "\r\n" + payload, payload);
+
+        // Otherwise the file is written to
+        std::string s =
+            "HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n";
+        for(std::size_t i = 0; i < payload.size(); i += 50000)
+            s += "c350\r\n" + payload.substr(i, 50000) + "\r\n";
+        s += "0\r\n\r\n";
+        doParse(s, payload);
+
+        doParse(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n", "");
+
+        // A body dropped part way leaves only what was received
+        {
+            auto const temp = boost::filesystem::unique_path();
+            auto const path = temp.string<std::string>();
+            std::string const s =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 300000\r\n"
+                "\r\n" + payload.substr(0, 100000);
+            error_code ec;
+            {
+                response_parser<mmap_file_body> p;
+                p.eager(true);
+                p.get().body().open(path.c_str(), file_mode::write, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                string_view sv = s;
+                while(! sv.empty())
+                {
+                    auto const n = p.put(
+                        boost::asio::buffer(sv.data(), sv.size()), ec);
+                    if(! BEAST_EXPECTS(! ec, ec.message()))
+                        break;
+                    sv.remove_prefix(n);
+                }
+                BEAST_EXPECT(! p.is_done());
+            }
+            BEAST_EXPECT(read_file(path) == payload.substr(0, 100000));
+            boost::filesystem::remove(temp, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+    }
+
+    void
+    run() override
+    {
+        testWriter();
+        testReader();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,mmap_file_body);
+
+} // http
+} // beast
+} // boost
+
+#endif
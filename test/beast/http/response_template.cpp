@@ -0,0 +1,300 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/response_template.hpp>
+
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/flat_fields.hpp>
+#include <boost/beast/http/write.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class response_template_test : public beast::unit_test::suite
+{
+public:
+    char const* date_ = "Sun, 06 Nov 1994 08:49:37 GMT";
+
+    template<class Fields>
+    static
+    std::string
+    str(header<false, Fields> const& h)
+    {
+        std::stringstream ss;
+        ss << h;
+        return ss.str();
+    }
+
+    template<class Allocator>
+    static
+    std::string
+    str(basic_response_template<Allocator> const& t)
+    {
+        return buffers_to_string(t.data());
+    }
+
+    static
+    response_header<>
+    make_header()
+    {
+        response_header<> h;
+        h.result(status::ok);
+        h.version(11);
+        h.set(field::server, "Beast");
+        h.set(field::content_type, "text/plain");
+        h.insert("X-Custom", "1");
+        return h;
+    }
+
+    void
+    testFreeze()
+    {
+        auto h = make_header();
+        response_template t{h};
+        BEAST_EXPECT(str(t) == str(h));
+        BEAST_EXPECT(t.version() == 11);
+        BEAST_EXPECT(t.result() == status::ok);
+        BEAST_EXPECT(t.result_int() == 200);
+        BEAST_EXPECT(! t.content_length());
+        BEAST_EXPECT(t.date().empty());
+
+        h.version(10);
+        h.result(299);
+        h.reason("Fine");
+        response_template t2{h};
+        BEAST_EXPECT(str(t2) == str(h));
+        BEAST_EXPECT(t2.result() == status::unknown);
+        BEAST_EXPECT(t2.result_int() == 299);
+
+        // no fields
+        response_header<> h3;
+        response_template t3{h3};
+        BEAST_EXPECT(str(t3) == str(h3));
+    }
+
+    void
+    testSlots()
+    {
+        auto h = make_header();
+        response_template t{h};
+
+        t.content_length(42);
+        BEAST_EXPECT(t.content_length() == std::uint64_t{42});
+        h.set(field::content_length, "42");
+        BEAST_EXPECT(str(t) == str(h));
+
+        // Date goes before Content-Length
+        t.date(date_);
+        BEAST_EXPECT(t.date() == date_);
+        h.erase(field::content_length);
+        h.set(field::date, date_);
+        h.set(field::content_length, "42");
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.result(status::not_found);
+        BEAST_EXPECT(t.result() == status::not_found);
+        h.result(status::not_found);
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.content_length(0);
+        h.set(field::content_length, "0");
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.content_length(18446744073709551615ULL);
+        h.set(field::content_length, "18446744073709551615");
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.content_length(boost::none);
+        h.erase(field::content_length);
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.date("");
+        h.erase(field::date);
+        BEAST_EXPECT(str(t) == str(h));
+        BEAST_EXPECT(t.date().empty());
+
+        // setting the same date again
+        t.date(date_);
+        t.date(t.date());
+        BEAST_EXPECT(t.date() == date_);
+        h.set(field::date, date_);
+        BEAST_EXPECT(str(t) == str(h));
+
+        // setting part of the current date
+        t.date(t.date().substr(5, 11));
+        BEAST_EXPECT(t.date() == string_view{date_}.substr(5, 11));
+        t.date(t.date().substr(0, 2));
+        BEAST_EXPECT(t.date() == string_view{date_}.substr(5, 2));
+        t.date(date_);
+        BEAST_EXPECT(str(t) == str(h));
+
+        // every known status
+        for(unsigned i = 0; i < 1000; ++i)
+        {
+            t.result(i);
+            h.result(i);
+            if(str(t) != str(h))
+            {
+                BEAST_EXPECTS(false, std::to_string(i));
+                break;
+            }
+        }
+        pass();
+    }
+
+    void
+    testInitialSlots()
+    {
+        response_header<> h;
+        h.set(field::date, date_);
+        h.set(field::content_length, "7");
+        h.set(field::server, "Beast");
+        response_template t{h};
+        BEAST_EXPECT(t.date() == date_);
+        BEAST_EXPECT(t.content_length() == std::uint64_t{7});
+
+        // slots are moved after the frozen fields
+        response_header<> h2;
+        h2.set(field::server, "Beast");
+        h2.set(field::date, date_);
+        h2.set(field::content_length, "7");
+        BEAST_EXPECT(str(t) == str(h2));
+    }
+
+    void
+    testReason()
+    {
+        std::string const reason(100, 'x');
+        auto h = make_header();
+        h.reason(reason);
+        response_template t{h};
+        BEAST_EXPECT(str(t) == str(h));
+
+        t.result(status::ok);
+        h.reason("");
+        BEAST_EXPECT(str(t) == str(h));
+
+        // the longest reason-phrase after the slots were written
+        response_header<> h2;
+        h2.result(status::ok);
+        h2.set(field::server, "Beast");
+        response_template t2{h2};
+        t2.content_length(5);
+        t2.result(status::network_connect_timeout_error);
+        h2.result(status::network_connect_timeout_error);
+        h2.set(field::content_length, "5");
+        BEAST_EXPECT(str(t2) == str(h2));
+    }
+
+    void
+    testCopy()
+    {
+        response_template t{make_header()};
+        t.content_length(1);
+        auto t2 = t;
+        t2.content_length(2);
+        t2.result(status::created);
+        BEAST_EXPECT(t.content_length() == std::uint64_t{1});
+        BEAST_EXPECT(t.result() == status::ok);
+        BEAST_EXPECT(str(t) != str(t2));
+
+        response_template t3{std::move(t2)};
+        BEAST_EXPECT(t3.result() == status::created);
+        t = t3;
+        BEAST_EXPECT(str(t) == str(t3));
+    }
+
+    void
+    testFlatFields()
+    {
+        response_header<flat_fields> h;
+        h.result(status::ok);
+        h.set(field::server, "Beast");
+        h.set(field::content_type, "text/html");
+        response_template t{h};
+        BEAST_EXPECT(str(t) == str(h));
+    }
+
+    void
+    testErrors()
+    {
+        response_template t{make_header()};
+        try
+        {
+            t.result(1000u);
+            fail("", __FILE__, __LINE__);
+        }
+        catch(std::invalid_argument const&)
+        {
+            pass();
+        }
+        BEAST_EXPECT(t.result() == status::ok);
+
+        auto const bad =
+            [&](response_header<> const& h)
+            {
+                try
+                {
+                    response_template t2{h};
+                    fail("", __FILE__, __LINE__);
+                }
+                catch(std::invalid_argument const&)
+                {
+                    pass();
+                }
+            };
+        {
+            response_header<> h;
+            h.set(field::content_length, "x");
+            bad(h);
+        }
+        {
+            response_header<> h;
+            h.set(field::content_length, "");
+            bad(h);
+        }
+        {
+            response_header<> h;
+            h.insert(field::content_length, "1");
+            h.insert(field::content_length, "1");
+            bad(h);
+        }
+        {
+            response_header<> h;
+            h.insert(field::date, date_);
+            h.insert(field::date, date_);
+            bad(h);
+        }
+    }
+
+    void
+    run() override
+    {
+        testFreeze();
+        testSlots();
+        testInitialSlots();
+        testReason();
+        testCopy();
+        testFlatFields();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,response_template);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/websocket/detail/mask.hpp>
+
+#include <boost/beast/unit_test/suite.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+class mask_test : public beast::unit_test::suite
+{
+public:
+    static
+    unsigned char
+    key_byte(std::uint32_t key, std::size_t i)
+    {
+        return static_cast<unsigned char>(
+            (key >> (8 * (i % 4))) & 0xff);
+    }
+
+    void
+    testMask()
+    {
+        std::uint32_t const key = 0x9a3c51e7;
+        std::vector<unsigned char> v(300);
+        for(std::size_t i = 0; i < v.size(); ++i)
+            v[i] = static_cast<unsigned char>(i * 7 + 3);
+
+        // every offset and length, to cover the
+        // unaligned head, word body, and tail
+        for(std::size_t off = 0; off < 2 * sizeof(std::size_t); ++off)
+        {
+            for(std::size_t n = 0; off + n <= v.size(); ++n)
+            {
+                auto w = v;
+                prepared_key pk;
+                prepare_key(pk, key);
+                boost::asio::mutable_buffer b(&w[off], n);
+                mask_inplace(b, pk);
+                bool ok = true;
+                for(std::size_t i = 0; i < w.size(); ++i)
+                {
+                    auto expected = v[i];
+                    if(i >= off && i < off + n)
+                        expected ^= key_byte(key, i - off);
+                    if(w[i] != expected)
+                        ok = false;
+                }
+                BEAST_EXPECTS(ok, std::to_string(off) +
+                    "," + std::to_string(n));
+
+                // the key must rotate by n
+                prepared_key pk0;
+                prepare_key(pk0, key);
+                rol(pk0, n % 4);
+                BEAST_EXPECT(pk == pk0);
+            }
+        }
+    }
+
+    void
+    testSplit()
+    {
+        // masking a sequence of buffers is the
+        // same as masking their concatenation
+        std::uint32_t const key = 0x01020304;
+        std::vector<unsigned char> v(257);
+        for(std::size_t i = 0; i < v.size(); ++i)
+            v[i] = static_cast<unsigned char>(i);
+        for(std::size_t i = 0; i <= v.size(); i += 5)
+        {
+            auto w = v;
+            std::array<boost::asio::mutable_buffer, 2> bs{{
+                {&w[0], i}, {&w[0] + i, w.size() - i}}};
+            prepared_key pk;
+            prepare_key(pk, key);
+            mask_inplace(bs, pk);
+            bool ok = true;
+            for(std::size_t j = 0; j < w.size(); ++j)
+                if(w[j] != (v[j] ^ key_byte(key, j)))
+                    ok = false;
+            BEAST_EXPECTS(ok, std::to_string(i));
+        }
+    }
+
+    void
+    run() override
+    {
+        testMask();
+        testSplit();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,mask);
+
+} // detail
+} // websocket
+} // beast
+} // boost
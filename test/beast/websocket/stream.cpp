@@ -45,6 +45,10 @@ public:
         ws.secure_prng(true);
         ws.secure_prng(false);
 
+        BEAST_EXPECT(! ws.idle_compaction());
+        ws.idle_compaction(true);
+        BEAST_EXPECT(ws.idle_compaction());
+
         auto const bad =
         [&](permessage_deflate const& pmd)
         {
@@ -691,6 +691,17 @@ public:
             return ws.write_some(fin, buffers);
         }
 
+        template<
+            class NextLayer, bool deflateSupported,
+            class MessageSequence>
+        std::size_t
+        write_batch(
+            stream<NextLayer, deflateSupported>& ws,
+            MessageSequence const& messages) const
+        {
+            return ws.write_batch(messages);
+        }
+
         template<
             class NextLayer, bool deflateSupported,
             class ConstBufferSequence>
@@ -999,6 +1010,22 @@ public:
             return bytes_transferred;
         }
 
+        template<
+            class NextLayer, bool deflateSupported,
+            class MessageSequence>
+        std::size_t
+        write_batch(
+            stream<NextLayer, deflateSupported>& ws,
+            MessageSequence const& messages) const
+        {
+            error_code ec;
+            auto const bytes_transferred =
+                ws.async_write_batch(messages, yield_[ec]);
+            if(ec)
+                throw system_error{ec};
+            return bytes_transferred;
+        }
+
         template<
             class NextLayer, bool deflateSupported,
             class ConstBufferSequence>
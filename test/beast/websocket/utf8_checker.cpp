@@ -14,6 +14,7 @@
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/unit_test/suite.hpp>
 #include <array>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -566,6 +567,87 @@ public:
         }
     }
 
+    void
+    testLongBuffers()
+    {
+        // Whole buffers take the wide path when the CPU
+        // supports it, single bytes always go through the
+        // scalar code. Both must agree on every input.
+        auto const one_byte_at_a_time =
+            [](std::vector<std::uint8_t> const& v)
+            {
+                utf8_checker u;
+                for(auto c : v)
+                    if(! u.write(&c, 1))
+                        return false;
+                return u.finish();
+            };
+        auto const all_at_once =
+            [](std::vector<std::uint8_t> const& v)
+            {
+                utf8_checker u;
+                if(! u.write(v.data(), v.size()))
+                    return false;
+                return u.finish();
+            };
+        auto const append =
+            [](std::vector<std::uint8_t>& v, std::uint32_t cp)
+            {
+                if(cp < 0x80)
+                {
+                    v.push_back(static_cast<std::uint8_t>(cp));
+                }
+                else if(cp < 0x800)
+                {
+                    v.push_back(static_cast<std::uint8_t>(0xc0 | (cp >> 6)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | (cp & 0x3f)));
+                }
+                else if(cp < 0x10000)
+                {
+                    v.push_back(static_cast<std::uint8_t>(0xe0 | (cp >> 12)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | ((cp >> 6) & 0x3f)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | (cp & 0x3f)));
+                }
+                else
+                {
+                    v.push_back(static_cast<std::uint8_t>(0xf0 | (cp >> 18)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | ((cp >> 12) & 0x3f)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | ((cp >> 6) & 0x3f)));
+                    v.push_back(static_cast<std::uint8_t>(0x80 | (cp & 0x3f)));
+                }
+            };
+
+        std::uint32_t const cps[] = {
+            'a', '{', 0x7f, 0x80, 0x7ff, 0x800, 0xd7ff, 0xe000,
+            0xfffd, 0xffff, 0x10000, 0x10ffff };
+        std::uint8_t const noise[] = {
+            0x00, 0x41, 0x7f, 0x80, 0xbf, 0xc0, 0xc1, 0xc2, 0xdf,
+            0xe0, 0xed, 0xef, 0xf0, 0xf4, 0xf5, 0xff };
+        std::uint32_t seed = 1;
+        auto const rand =
+            [&](std::uint32_t n)
+            {
+                seed = seed * 1103515245 + 12345;
+                return (seed >> 16) % n;
+            };
+        for(int iter = 0; iter < 2000; ++iter)
+        {
+            std::vector<std::uint8_t> v;
+            auto const n = 16 + rand(200);
+            while(v.size() < n)
+                append(v, cps[rand(sizeof(cps) / sizeof(cps[0]))]);
+            BEAST_EXPECT(all_at_once(v));
+            BEAST_EXPECT(one_byte_at_a_time(v));
+            // corrupt a byte or truncate
+            if(rand(4) == 0)
+                v.resize(v.size() - 1 - rand(3));
+            else
+                v[rand(static_cast<std::uint32_t>(v.size()))] =
+                    noise[rand(sizeof(noise))];
+            BEAST_EXPECT(all_at_once(v) == one_byte_at_a_time(v));
+        }
+    }
+
     void
     run() override
     {
@@ -576,6 +658,7 @@ public:
         testWithStreamBuffer();
         testBranches();
         AutodeskTests();
+        testLongBuffers();
         // 6.4.2
         AutobahnTest(std::vector<std::vector<std::uint8_t>>{
             { 0xCE, 0xBA, 0xE1, 0xBD, 0xB9, 0xCF, 0x83, 0xCE, 0xBC, 0xCE, 0xB5, 0xF4 },
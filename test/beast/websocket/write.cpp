@@ -11,7 +11,11 @@
 #include <boost/beast/websocket/stream.hpp>
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <thread>
+#include <vector>
 
 #include "test.hpp"
 
@@ -22,6 +26,38 @@ namespace websocket {
 class write_test : public websocket_test_suite
 {
 public:
+    static
+    std::vector<std::string>
+    batch_messages(std::size_t count)
+    {
+        std::vector<std::string> v;
+        for(std::size_t i = 0; i < count; ++i)
+            v.emplace_back(i % 7 == 3 ? 300 : i % 5,
+                static_cast<char>('a' + i % 26));
+        return v;
+    }
+
+    template<class Wrap, class Stream>
+    void
+    checkBatch(Wrap const& w, Stream& ws,
+        std::vector<std::string> const& v)
+    {
+        std::size_t total = 0;
+        std::vector<boost::asio::const_buffer> bs;
+        for(auto const& s : v)
+        {
+            bs.emplace_back(s.data(), s.size());
+            total += s.size();
+        }
+        BEAST_EXPECT(w.write_batch(ws, bs) == total);
+        for(auto const& s : v)
+        {
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        }
+    }
+
     template<bool deflateSupported, class Wrap>
     void
     doTestWrite(Wrap const& w)
@@ -146,6 +182,139 @@ public:
             BEAST_EXPECT(buffers_to_string(b.data()) == s);
         });
 
+        // mask in place
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(false);
+            ws.mask_in_place(true);
+            std::string const s = "Hello, world!";
+            std::string v = s;
+            w.write(ws, buffer(&v[0], v.size()));
+            // the key is never zero
+            BEAST_EXPECT(v != s);
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // mask in place, autofrag
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(true);
+            ws.mask_in_place(true);
+            ws.binary(true);
+            std::string const s = random_string();
+            std::string v = s;
+            std::array<boost::asio::mutable_buffer, 2> bs{{
+                buffer(&v[0], 7), buffer(&v[7], v.size() - 7)}};
+            w.write(ws, bs);
+            BEAST_EXPECT(v != s);
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // mask in place, many buffers
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(false);
+            ws.mask_in_place(true);
+            std::string const s(1000, '*');
+            std::string v = s;
+            std::vector<boost::asio::mutable_buffer> bs;
+            for(std::size_t i = 0; i < v.size(); i += 5)
+                bs.emplace_back(&v[i], 5);
+            w.write(ws, bs);
+            // each buffer spans every byte of the key
+            for(std::size_t i = 0; i < v.size(); i += 5)
+                BEAST_EXPECT(v.compare(i, 5, s, i, 5) != 0);
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // mask in place, constant buffers are copied
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.mask_in_place(true);
+            std::string const s = "Hello";
+            w.write(ws, buffer(s));
+            BEAST_EXPECT(s == "Hello");
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // batch
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.binary(true);
+            checkBatch(w, ws, batch_messages(12));
+        });
+
+        // batch, small write buffer
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(false);
+            ws.write_buffer_size(64);
+            checkBatch(w, ws, batch_messages(8));
+        });
+
+        // batch, mask in place
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.mask_in_place(true);
+            auto const v = batch_messages(10);
+            auto v1 = v;
+            std::vector<boost::asio::mutable_buffer> bs;
+            for(auto& s : v1)
+                bs.emplace_back(&s[0], s.size());
+            w.write_batch(ws, bs);
+            for(auto const& s : v)
+            {
+                flat_buffer b;
+                w.read(ws, b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            }
+        });
+
+        // idle compaction
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.idle_compaction(true);
+            ws.binary(true);
+            for(int i = 0; i < 3; ++i)
+            {
+                std::string const s(300 * i, '*');
+                w.write(ws, buffer(s));
+                flat_buffer b;
+                w.read(ws, b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            }
+            checkBatch(w, ws, batch_messages(6));
+        });
+
+        // batch, empty
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            std::vector<boost::asio::const_buffer> bs;
+            BEAST_EXPECT(w.write_batch(ws, bs) == 0);
+            std::string const s = "Hello";
+            w.write(ws, buffer(s));
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
         // nomask
         doStreamLoop([&](test::stream& ts)
         {
@@ -197,6 +366,61 @@ public:
             }
             ts.close();
         });
+
+        // nomask, autofrag, many frames and buffers
+        doStreamLoop([&](test::stream& ts)
+        {
+            echo_server es{log, kind::async_client};
+            ws_type_t<deflateSupported> ws{ts};
+            ws.next_layer().connect(es.stream());
+            try
+            {
+                es.async_handshake();
+                w.accept(ws);
+                ws.auto_fragment(true);
+                ws.write_buffer_size(8);
+                std::string s;
+                for(std::size_t i = 0; i < 1000; ++i)
+                    s.push_back(static_cast<char>('a' + i % 26));
+                std::vector<boost::asio::const_buffer> bs;
+                for(std::size_t i = 0; i < s.size(); i += 5)
+                    bs.emplace_back(&s[i], 5);
+                w.write(ws, bs);
+                flat_buffer b;
+                w.read(ws, b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+                w.close(ws, {});
+            }
+            catch(...)
+            {
+                ts.close();
+                throw;
+            }
+            ts.close();
+        });
+
+        // nomask, batch with more frames than fit in one write
+        doStreamLoop([&](test::stream& ts)
+        {
+            echo_server es{log, kind::async_client};
+            ws_type_t<deflateSupported> ws{ts};
+            ws.next_layer().connect(es.stream());
+            try
+            {
+                es.async_handshake();
+                w.accept(ws);
+                ws.auto_fragment(true);
+                ws.write_buffer_size(128);
+                checkBatch(w, ws, batch_messages(40));
+                w.close(ws, {});
+            }
+            catch(...)
+            {
+                ts.close();
+                throw;
+            }
+            ts.close();
+        });
     }
 
     template<class Wrap>
@@ -238,6 +462,15 @@ public:
             BEAST_EXPECT(buffers_to_string(b.data()) == s);
         });
 
+        // deflate, batch
+        doTest(pmd, [&](ws_type& ws)
+        {
+            auto v = batch_messages(10);
+            v.insert(v.begin() + 4, random_string());
+            ws.binary(true);
+            checkBatch(w, ws, v);
+        });
+
         // deflate, no context takeover
         pmd.client_no_context_takeover = true;
         doTest(pmd, [&](ws_type& ws)
@@ -249,6 +482,46 @@ public:
             w.read(ws, b);
             BEAST_EXPECT(buffers_to_string(b.data()) == s);
         });
+
+        // deflate, no context takeover, batch
+        doTest(pmd, [&](ws_type& ws)
+        {
+            auto v = batch_messages(10);
+            v.insert(v.begin() + 4, random_string());
+            ws.binary(true);
+            checkBatch(w, ws, v);
+        });
+
+        pmd.server_no_context_takeover = true;
+        // deflate, no context takeover, pooled state
+        doTest(pmd, [&](ws_type& ws)
+        {
+            ws.binary(true);
+            w.write(ws, boost::asio::const_buffer{});
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(b.size() == 0);
+            auto const& s = random_string();
+            w.write(ws, buffer(s));
+            b.consume(b.size());
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // deflate, no context takeover, idle compaction
+        doTest(pmd, [&](ws_type& ws)
+        {
+            ws.idle_compaction(true);
+            ws.binary(true);
+            for(int i = 0; i < 2; ++i)
+            {
+                auto const& s = random_string();
+                w.write(ws, buffer(s));
+                flat_buffer b;
+                w.read(ws, b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            }
+        });
     }
 
     void
@@ -268,6 +541,289 @@ public:
         });
     }
 
+    void
+    testDeflateExecutor()
+    {
+        using boost::asio::buffer;
+
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.client_no_context_takeover = true;
+
+        std::string s;
+        while(s.size() < 300000)
+            s += random_string();
+
+        boost::asio::thread_pool pool(2);
+        for(int i = 0; i < 2; ++i)
+        {
+            boost::asio::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            wsc.set_option(pmd);
+            wss.set_option(pmd);
+            wsc.deflate_executor(pool.get_executor());
+            wsc.binary(true);
+            wsc.next_layer().connect(wss.next_layer());
+            wsc.async_handshake(
+                "localhost", "/", [](error_code){});
+            wss.async_accept([](error_code){});
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(wsc.is_open());
+            BEAST_EXPECT(wss.is_open());
+            for(auto const& m : {s, random_string()})
+            {
+                if(i == 0)
+                {
+                    wsc.write(buffer(m));
+                }
+                else
+                {
+                    error_code ec;
+                    std::size_t n = 0;
+                    wsc.async_write(buffer(m),
+                        [&](error_code ec_, std::size_t n_)
+                        {
+                            ec = ec_;
+                            n = n_;
+                        });
+                    ioc.run();
+                    ioc.restart();
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(n == m.size());
+                }
+                flat_buffer b;
+                wss.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == m);
+            }
+        }
+    }
+
+    void
+    testDeflateExecutorDestroy()
+    {
+        using boost::asio::buffer;
+
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.client_no_context_takeover = true;
+
+        std::string s;
+        while(s.size() < 300000)
+            s += random_string();
+
+        auto const connect =
+            [&](boost::asio::io_context& ioc,
+                stream<test::stream>& wsc,
+                stream<test::stream>& wss)
+            {
+                wsc.set_option(pmd);
+                wss.set_option(pmd);
+                wsc.binary(true);
+                wsc.next_layer().connect(wss.next_layer());
+                wsc.async_handshake(
+                    "localhost", "/", [](error_code){});
+                wss.async_accept([](error_code){});
+                ioc.run();
+                ioc.restart();
+                BEAST_EXPECT(wsc.is_open());
+                BEAST_EXPECT(wss.is_open());
+            };
+
+        // The io_context is destroyed while chunks are compressing
+        {
+            boost::asio::io_context helper;
+            std::weak_ptr<int> alive;
+            {
+                boost::asio::io_context ioc;
+                stream<test::stream> wsc{ioc};
+                stream<test::stream> wss{ioc};
+                connect(ioc, wsc, wss);
+                wsc.deflate_executor(helper.get_executor());
+                auto sp = std::make_shared<int>(0);
+                alive = sp;
+                wsc.async_write(buffer(s),
+                    [this, sp](error_code, std::size_t)
+                    {
+                        fail("", __FILE__, __LINE__);
+                    });
+                sp.reset();
+                ioc.poll();
+                BEAST_EXPECT(! alive.expired());
+            }
+            // The parked operation went away with the stream
+            BEAST_EXPECT(alive.expired());
+            helper.run();
+        }
+
+        // The helper destroys the chunks without compressing them
+        {
+            boost::asio::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            connect(ioc, wsc, wss);
+            std::unique_ptr<boost::asio::io_context> helper(
+                new boost::asio::io_context);
+            wsc.deflate_executor(helper->get_executor());
+            bool invoked = false;
+            wsc.async_write(buffer(s),
+                [&](error_code ec, std::size_t)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(ec ==
+                        boost::asio::error::operation_aborted,
+                            ec.message());
+                });
+            ioc.poll();
+            BEAST_EXPECT(! invoked);
+            helper.reset();
+            wsc.deflate_executor({});
+            ioc.run();
+            BEAST_EXPECT(invoked);
+        }
+    }
+
+    void
+    testDeflateExecutorTcp()
+    {
+        using boost::asio::buffer;
+        namespace ip = boost::asio::ip;
+
+        // The stream's executor is not the helper's executor type
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.client_no_context_takeover = true;
+
+        std::string s;
+        while(s.size() < 300000)
+            s += random_string();
+
+        boost::asio::thread_pool pool(2);
+        boost::asio::io_context ioc;
+        ip::tcp::acceptor a{ioc, ip::tcp::endpoint{
+            ip::make_address_v4("127.0.0.1"), 0}};
+        stream<ip::tcp::socket> wsc{ioc};
+        stream<ip::tcp::socket> wss{ioc};
+        wsc.set_option(pmd);
+        wss.set_option(pmd);
+        wsc.deflate_executor(pool.get_executor());
+        wsc.binary(true);
+        wsc.next_layer().connect(a.local_endpoint());
+        a.accept(wss.next_layer());
+        wsc.async_handshake(
+            "localhost", "/", [](error_code){});
+        wss.async_accept([](error_code){});
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(wsc.is_open());
+        BEAST_EXPECT(wss.is_open());
+
+        // synchronous
+        {
+            flat_buffer b;
+            error_code ec;
+            std::thread t(
+                [&]
+                {
+                    wss.read(b, ec);
+                });
+            wsc.write(buffer(s));
+            t.join();
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        }
+
+        // asynchronous
+        {
+            flat_buffer b;
+            error_code ec1, ec2;
+            std::size_t n = 0;
+            wsc.async_write(buffer(s),
+                [&](error_code ec, std::size_t n_)
+                {
+                    ec1 = ec;
+                    n = n_;
+                });
+            wss.async_read(b,
+                [&](error_code ec, std::size_t)
+                {
+                    ec2 = ec;
+                });
+            ioc.run();
+            BEAST_EXPECTS(! ec1, ec1.message());
+            BEAST_EXPECTS(! ec2, ec2.message());
+            BEAST_EXPECT(n == s.size());
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        }
+    }
+
+    void
+    testMaskInPlaceNoFrag()
+    {
+        // Without auto_fragment a message is sent as one
+        // frame, however many buffers the caller passes.
+        boost::asio::io_context ioc;
+        stream<test::stream> wsc{ioc};
+        stream<test::stream> wss{ioc};
+        wsc.next_layer().connect(wss.next_layer());
+        wsc.async_handshake(
+            "localhost", "/", [](error_code){});
+        wss.async_accept([](error_code){});
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(wsc.is_open());
+        BEAST_EXPECT(wss.is_open());
+        wsc.auto_fragment(false);
+        wsc.mask_in_place(true);
+        wsc.binary(true);
+
+        std::string const s(1000, '*');
+        auto const check =
+            [&]
+            {
+                // header, 16-bit length, key, payload
+                auto const m = wss.next_layer().str();
+                BEAST_EXPECT(m.size() == 8 + s.size());
+                BEAST_EXPECT(static_cast<
+                    unsigned char>(m[0]) == 0x82);
+                flat_buffer b;
+                wss.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            };
+
+        // synchronous
+        {
+            std::string v = s;
+            std::vector<boost::asio::mutable_buffer> bs;
+            for(std::size_t i = 0; i < v.size(); i += 5)
+                bs.emplace_back(&v[i], 5);
+            BEAST_EXPECT(wsc.write(bs) == s.size());
+            check();
+        }
+
+        // asynchronous
+        {
+            std::string v = s;
+            std::vector<boost::asio::mutable_buffer> bs;
+            for(std::size_t i = 0; i < v.size(); i += 5)
+                bs.emplace_back(&v[i], 5);
+            std::size_t n = 0;
+            wsc.async_write(bs,
+                [&](error_code ec, std::size_t n_)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = n_;
+                });
+            ioc.run();
+            BEAST_EXPECT(n == s.size());
+            check();
+        }
+    }
+
     void
     testWriteSuspend()
     {
@@ -671,6 +1227,10 @@ public:
     run() override
     {
         testWrite();
+        testDeflateExecutor();
+        testDeflateExecutorDestroy();
+        testDeflateExecutorTcp();
+        testMaskInPlaceNoFrag();
         testWriteSuspend();
         testAsyncWriteFrame();
         testIssue300();
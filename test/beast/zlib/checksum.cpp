@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/zlib/checksum.hpp>
+
+#include <boost/beast/unit_test/suite.hpp>
+#include <random>
+#include <string>
+
+#include "zlib-1.2.11/zlib.h"
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+class checksum_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    random_string(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        std::mt19937 g;
+        std::uniform_int_distribution<std::uint32_t> d0{0, 255};
+        while(n--)
+            s.push_back(static_cast<char>(d0(g)));
+        return s;
+    }
+
+    void
+    testCrc32()
+    {
+        BEAST_EXPECT(zlib::crc32(0, "", 0) == 0);
+        BEAST_EXPECT(zlib::crc32(0, "123456789", 9) == 0xcbf43926);
+
+        auto const s = random_string(20000);
+        auto const p = reinterpret_cast<Bytef const*>(s.data());
+
+        // every size and alignment around the vector thresholds
+        for(std::size_t i = 0; i < 16; ++i)
+            for(std::size_t n = 0; n < 300; ++n)
+                BEAST_EXPECT(zlib::crc32(0, s.data() + i, n) ==
+                    ::crc32(0, p + i, static_cast<uInt>(n)));
+
+        // large and chained
+        auto const want = ::crc32(0, p, static_cast<uInt>(s.size()));
+        BEAST_EXPECT(zlib::crc32(0, s.data(), s.size()) == want);
+        std::uint32_t crc = 0;
+        for(std::size_t i = 0; i < s.size(); i += 777)
+            crc = zlib::crc32(crc, s.data() + i,
+                (std::min)(std::size_t{777}, s.size() - i));
+        BEAST_EXPECT(crc == want);
+    }
+
+    void
+    testAdler32()
+    {
+        BEAST_EXPECT(zlib::adler32(1, "", 0) == 1);
+        BEAST_EXPECT(zlib::adler32(1, "Wikipedia", 9) == 0x11e60398);
+
+        auto const s = random_string(20000);
+        auto const p = reinterpret_cast<Bytef const*>(s.data());
+
+        for(std::size_t i = 0; i < 16; ++i)
+            for(std::size_t n = 0; n < 300; ++n)
+                BEAST_EXPECT(zlib::adler32(1, s.data() + i, n) ==
+                    ::adler32(1, p + i, static_cast<uInt>(n)));
+
+        // runs long enough to need several reductions
+        std::string const ff(20000, '\xff');
+        BEAST_EXPECT(zlib::adler32(1, ff.data(), ff.size()) ==
+            ::adler32(1, reinterpret_cast<Bytef const*>(ff.data()),
+                static_cast<uInt>(ff.size())));
+
+        auto const want = ::adler32(1, p, static_cast<uInt>(s.size()));
+        BEAST_EXPECT(zlib::adler32(1, s.data(), s.size()) == want);
+        std::uint32_t adler = 1;
+        for(std::size_t i = 0; i < s.size(); i += 777)
+            adler = zlib::adler32(adler, s.data() + i,
+                (std::min)(std::size_t{777}, s.size() - i));
+        BEAST_EXPECT(adler == want);
+    }
+
+    void
+    run() override
+    {
+        testCrc32();
+        testAdler32();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,zlib,checksum);
+
+} // zlib
+} // beast
+} // boost
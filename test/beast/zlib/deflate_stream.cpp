@@ -103,13 +103,13 @@ public:
 
     static
     std::string
-    decompress(string_view const& in)
+    decompress(string_view const& in, int windowBits = -15)
     {
         int result;
         std::string out;
         z_stream zs;
         memset(&zs, 0, sizeof(zs));
-        result = inflateInit2(&zs, -15);
+        result = inflateInit2(&zs, windowBits);
         try
         {
             zs.next_in = (Bytef*)in.data();
@@ -132,6 +132,9 @@ public:
                 if(result == Z_STREAM_END)
                     break;
             }
+            // a wrapped stream must end with a matching trailer
+            if(windowBits > 0 && result != Z_STREAM_END)
+                throw std::logic_error("inflate incomplete");
             out.resize(zs.total_out);
             inflateEnd(&zs);
         }
@@ -274,6 +277,76 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void
+    doFastHash(int level, int windowBits, std::string const& check)
+    {
+        deflate_stream ds;
+        ds.fast_hash(true);
+        for(int i = 0; i < 2; ++i)
+        {
+            z_params zs;
+            ds.reset(level, windowBits, 8, Strategy::normal);
+            std::string out;
+            out.resize(ds.upper_bound(check.size()));
+            zs.next_in = check.data();
+            zs.avail_in = check.size();
+            zs.next_out = &out[0];
+            zs.avail_out = out.size();
+            error_code ec;
+            ds.write(zs, Flush::full, ec);
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                return;
+            out.resize(zs.total_out);
+            BEAST_EXPECT(decompress(out) == check);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    doFormat(
+        Format format,
+        std::string const& check,
+        std::size_t step)
+    {
+        deflate_stream ds;
+        ds.format(format);
+        for(int i = 0; i < 2; ++i)
+        {
+            z_params zs;
+            ds.reset(6, 15, 8, Strategy::normal);
+            std::string out;
+            zs.next_in = check.data();
+            zs.avail_in = check.size();
+            for(;;)
+            {
+                out.resize(zs.total_out + step);
+                zs.next_out = &out[zs.total_out];
+                zs.avail_out = step;
+                error_code ec;
+                ds.write(zs, Flush::finish, ec);
+                if(ec == error::end_of_stream)
+                    break;
+                if(! BEAST_EXPECTS(! ec, ec.message()))
+                    return;
+            }
+            out.resize(zs.total_out);
+            BEAST_EXPECT(out.size() <=
+                ds.upper_bound(check.size()));
+            try
+            {
+                BEAST_EXPECT(decompress(out,
+                    format == Format::gzip ? 31 : 15) == check);
+            }
+            catch(std::logic_error const& e)
+            {
+                fail(e.what(), __FILE__, __LINE__);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
     void
     doMatrix(std::string const& check, pmf_t pmf)
     {
@@ -302,6 +375,37 @@ public:
         doMatrix(corpus1(1024), &self::doDeflate1_beast);
     }
 
+    void
+    testFastHash()
+    {
+        auto const c1 = corpus1(100000);
+        auto const c2 = corpus2(100000);
+        for(int level = 1; level <= 9; ++level)
+        {
+            for(int windowBits = 9; windowBits <= 15; windowBits += 3)
+            {
+                doFastHash(level, windowBits, c1);
+                doFastHash(level, windowBits, c2);
+            }
+        }
+    }
+
+    void
+    testFormat()
+    {
+        auto const c1 = corpus1(100000);
+        auto const c2 = corpus2(10000);
+        for(auto format : {Format::zlib, Format::gzip})
+        {
+            doFormat(format, "", 1);
+            doFormat(format, "Hello, world!", 1);
+            doFormat(format, "Hello, world!", 1024);
+            doFormat(format, c1, 7);
+            doFormat(format, c1, 65536);
+            doFormat(format, c2, 1000);
+        }
+    }
+
     void
     run() override
     {
@@ -310,6 +414,8 @@ public:
             sizeof(deflate_stream) << std::endl;
 
         testDeflate();
+        testFastHash();
+        testFormat();
     }
 };
 
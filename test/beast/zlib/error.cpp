@@ -54,6 +54,13 @@ public:
         check("beast.zlib", error::over_subscribed_length);
         check("beast.zlib", error::incomplete_length_set);
 
+        check("beast.zlib", error::incorrect_header_check);
+        check("beast.zlib", error::unknown_compression_method);
+        check("beast.zlib", error::invalid_window_size);
+        check("beast.zlib", error::need_dictionary);
+        check("beast.zlib", error::incorrect_data_check);
+        check("beast.zlib", error::incorrect_length_check);
+
         check("beast.zlib", error::general);
     }
 };
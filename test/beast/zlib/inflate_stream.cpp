@@ -101,6 +101,43 @@ public:
         return out;
     }
 
+    // Compress with a zlib or gzip wrapper
+    static
+    std::string
+    compress_wrapped(
+        string_view const& in,
+        int windowBits,             // 9..15 zlib, 25..31 gzip
+        gz_header* header = nullptr)
+    {
+        int result;
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        result = deflateInit2(
+            &zs,
+            Z_DEFAULT_COMPRESSION,
+            Z_DEFLATED,
+            windowBits,
+            8,
+            Z_DEFAULT_STRATEGY);
+        if(result != Z_OK)
+            throw std::logic_error{"deflateInit2 failed"};
+        if(header)
+            deflateSetHeader(&zs, header);
+        std::string out;
+        out.resize(deflateBound(&zs,
+            static_cast<uLong>(in.size())) + 1024);
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = static_cast<uInt>(out.size());
+        result = deflate(&zs, Z_FINISH);
+        if(result != Z_STREAM_END)
+            throw std::logic_error("deflate failed");
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return out;
+    }
+
     //--------------------------------------------------------------------------
 
     enum Split
@@ -348,6 +385,21 @@ public:
             m(Beast{full, once, Flush::block}, check);
         }
 
+        // overlapping matches at every short distance
+        for(std::size_t dist = 1; dist <= 17; ++dist)
+        {
+            std::string check;
+            for(std::size_t i = 0; i < 2000; ++i)
+                check.push_back(static_cast<char>(
+                    'a' + (i % dist) + (i / 700)));
+            Matrix m{*this};
+            m.level(6);
+            m.window(15);
+            m.strategy(Z_DEFAULT_STRATEGY);
+            m(Beast{once, full}, check);
+            m(Beast{half, half}, check);
+        }
+
         // VFALCO Fails, but I'm unsure of what the correct
         //        behavior of Z_TREES/Flush::trees is.
 #if 0
@@ -362,6 +414,166 @@ public:
 #endif
     }
 
+    // Inflate, providing at most step bytes of input per call
+    static
+    error_code
+    inflate_wrapped(
+        Format format,
+        std::string const& in,
+        std::string& out,
+        std::size_t step)
+    {
+        inflate_stream is;
+        is.format(format);
+        out.clear();
+        std::size_t pos = 0;
+        error_code ec;
+        for(;;)
+        {
+            char buf[512];
+            auto const n = (std::min)(step, in.size() - pos);
+            z_params zs;
+            zs.next_in = in.data() + pos;
+            zs.avail_in = n;
+            zs.next_out = buf;
+            zs.avail_out = sizeof(buf);
+            is.write(zs, Flush::sync, ec);
+            pos += n - zs.avail_in;
+            out.append(buf, sizeof(buf) - zs.avail_out);
+            if(ec == error::need_buffers && pos < in.size())
+                ec = {};
+            else if(ec)
+                break;
+        }
+        return ec;
+    }
+
+    void
+    testFormat()
+    {
+        auto const c1 = corpus1(50000);
+        auto const c2 = corpus2(5000);
+
+        auto const check =
+            [&](Format format, std::string const& in,
+                std::string const& want, std::size_t step)
+            {
+                std::string out;
+                auto const ec = inflate_wrapped(format, in, out, step);
+                BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+                BEAST_EXPECT(out == want);
+            };
+
+        for(std::size_t step : {1, 3, 1000000})
+        {
+            check(Format::zlib, compress_wrapped("", 15), "", step);
+            check(Format::zlib, compress_wrapped(c1, 15), c1, step);
+            check(Format::zlib, compress_wrapped(c2, 9), c2, step);
+            check(Format::gzip, compress_wrapped("", 31), "", step);
+            check(Format::gzip, compress_wrapped(c1, 31), c1, step);
+            check(Format::gzip, compress_wrapped(c2, 31), c2, step);
+        }
+
+        // gzip with optional header fields
+        {
+            std::string extra = "extra field";
+            std::string name = "name.txt";
+            std::string comment = "a comment";
+            gz_header h;
+            memset(&h, 0, sizeof(h));
+            h.text = 1;
+            h.time = 1234567;
+            h.os = 3;
+            h.extra = (Bytef*)&extra[0];
+            h.extra_len = static_cast<uInt>(extra.size());
+            h.name = (Bytef*)&name[0];
+            h.comment = (Bytef*)&comment[0];
+            h.hcrc = 1;
+            auto const in = compress_wrapped(c1, 31, &h);
+            check(Format::gzip, in, c1, 1);
+            check(Format::gzip, in, c1, 1000000);
+
+            auto bad = in;
+            bad[15] ^= 1;
+            std::string out;
+            BEAST_EXPECT(inflate_wrapped(Format::gzip, bad, out, 7) ==
+                error::incorrect_header_check);
+        }
+
+        auto const expect_error =
+            [&](Format format, std::string const& in, error e)
+            {
+                std::string out;
+                auto const ec = inflate_wrapped(format, in, out, 1000000);
+                BEAST_EXPECTS(ec == e, ec.message());
+            };
+
+        // corrupt headers and trailers
+        {
+            auto const in = compress_wrapped(c1, 15);
+            auto bad = in;
+            bad[1] ^= 1;
+            expect_error(Format::zlib, bad, error::incorrect_header_check);
+            bad = in;
+            bad.back() ^= 1;
+            expect_error(Format::zlib, bad, error::incorrect_data_check);
+            expect_error(Format::gzip, in, error::incorrect_header_check);
+        }
+        {
+            auto const in = compress_wrapped(c1, 31);
+            auto bad = in;
+            bad[2] = 7;
+            expect_error(Format::gzip, bad, error::unknown_compression_method);
+            bad = in;
+            bad[bad.size() - 5] ^= 1;
+            expect_error(Format::gzip, bad, error::incorrect_data_check);
+            bad = in;
+            bad.back() ^= 1;
+            expect_error(Format::gzip, bad, error::incorrect_length_check);
+        }
+        {
+            // window larger than the inflate window
+            auto const in = compress_wrapped(c1, 15);
+            inflate_stream is;
+            is.format(Format::zlib);
+            is.reset(9);
+            std::string out(c1.size(), 0);
+            z_params zs;
+            zs.next_in = in.data();
+            zs.avail_in = in.size();
+            zs.next_out = &out[0];
+            zs.avail_out = out.size();
+            error_code ec;
+            is.write(zs, Flush::sync, ec);
+            BEAST_EXPECTS(ec == error::invalid_window_size, ec.message());
+        }
+    }
+
+    void
+    testClear()
+    {
+        auto const check = corpus1(5000);
+        auto const in = compress(check, 6, 15, 8, Z_DEFAULT_STRATEGY);
+        inflate_stream is;
+        is.reset(15);
+        for(int i = 0; i < 3; ++i)
+        {
+            std::string out;
+            out.resize(check.size() + 100);
+            z_params zs;
+            zs.next_in = in.data();
+            zs.avail_in = in.size();
+            zs.next_out = &out[0];
+            zs.avail_out = out.size();
+            error_code ec;
+            is.write(zs, Flush::sync, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            out.resize(zs.total_out);
+            BEAST_EXPECT(out == check);
+            is.clear();
+        }
+    }
+
     void
     run() override
     {
@@ -369,6 +581,8 @@ public:
             "sizeof(inflate_stream) == " <<
             sizeof(inflate_stream) << std::endl;
         testInflate();
+        testFormat();
+        testClear();
     }
 };
 
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class field_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // The previous lookup, one unordered_map per name length
+    class map_table
+    {
+        struct hash
+        {
+            std::size_t
+            operator()(string_view s) const
+            {
+                auto const n = s.size();
+                return
+                    beast::detail::ascii_tolower(s[0]) *
+                    beast::detail::ascii_tolower(s[n/2]) ^
+                    beast::detail::ascii_tolower(s[n-1]);
+            }
+        };
+
+        struct iequal
+        {
+            bool
+            operator()(string_view lhs, string_view rhs) const
+            {
+                return iequals(lhs, rhs);
+            }
+        };
+
+        using map_type = std::unordered_map<
+            string_view, field, hash, iequal>;
+
+        std::vector<map_type> by_size_;
+
+    public:
+        map_table()
+        {
+            auto const& tab = detail::get_field_table();
+            std::size_t high = 0;
+            for(auto const& s : tab)
+                if(high < s.size())
+                    high = s.size();
+            by_size_.resize(high + 1);
+            for(auto& map : by_size_)
+                map.max_load_factor(.15f);
+            for(std::size_t i = 1; i < tab.size(); ++i)
+            {
+                auto const& s = tab.begin()[i];
+                by_size_[s.size()].emplace(
+                    s, static_cast<field>(i));
+            }
+        }
+
+        field
+        string_to_field(string_view s) const
+        {
+            if(s.size() >= by_size_.size())
+                return field::unknown;
+            auto const& map = by_size_[s.size()];
+            if(map.empty())
+                return field::unknown;
+            auto it = map.find(s);
+            if(it == map.end())
+                return field::unknown;
+            return it->second;
+        }
+    };
+
+    // Names as they appear in typical traffic
+    std::vector<std::string>
+    request_names()
+    {
+        return {
+            "Host", "User-Agent", "Accept", "Accept-Language",
+            "Accept-Encoding", "Referer", "Connection", "Cookie",
+            "Upgrade-Insecure-Requests", "Cache-Control",
+            "If-Modified-Since", "If-None-Match", "Authorization",
+            "Content-Type", "Content-Length", "Origin",
+            "X-Forwarded-For", "X-Forwarded-Proto", "X-Request-Id",
+            "Sec-Fetch-Mode", "Sec-Fetch-Site", "DNT", "Pragma"
+        };
+    }
+
+    std::vector<std::string>
+    response_names()
+    {
+        return {
+            "Date", "Server", "Content-Type", "Content-Length",
+            "Connection", "Cache-Control", "Expires", "Last-Modified",
+            "ETag", "Vary", "Set-Cookie", "Location",
+            "Transfer-Encoding", "Content-Encoding", "Accept-Ranges",
+            "Age", "Strict-Transport-Security", "X-Frame-Options",
+            "X-Content-Type-Options", "Access-Control-Allow-Origin"
+        };
+    }
+
+    // The same names as sent by HTTP/2 gateways
+    static
+    std::vector<std::string>
+    lower(std::vector<std::string> v)
+    {
+        for(auto& s : v)
+            for(auto& c : s)
+                c = beast::detail::ascii_tolower(c);
+        return v;
+    }
+
+    template<class F>
+    double
+    nanoseconds(std::vector<std::string> const& v, F const& f)
+    {
+        std::size_t const repeat = 2000000;
+        std::size_t found = 0;
+        auto const t0 = clock_type::now();
+        for(std::size_t i = 0; i < repeat; ++i)
+            for(auto const& s : v)
+                if(f(s) != field::unknown)
+                    ++found;
+        std::chrono::duration<double, std::nano> const elapsed =
+            clock_type::now() - t0;
+        BEAST_EXPECT(found > 0);
+        return elapsed.count() / (repeat * v.size());
+    }
+
+    void
+    check(map_table const& map, std::vector<std::string> const& v)
+    {
+        for(auto const& s : v)
+            BEAST_EXPECTS(
+                map.string_to_field(s) == string_to_field(s), s);
+    }
+
+    void
+    run() override
+    {
+        map_table const map;
+        struct set
+        {
+            char const* name;
+            std::vector<std::string> v;
+        };
+        std::vector<set> const sets = {
+            { "requests", request_names() },
+            { "responses", response_names() },
+            { "requests, lower case", lower(request_names()) },
+            { "responses, lower case", lower(response_names()) }
+        };
+        for(auto const& e : sets)
+        {
+            check(map, e.v);
+            auto const t0 = nanoseconds(e.v,
+                [&](string_view s)
+                {
+                    return map.string_to_field(s);
+                });
+            auto const t1 = nanoseconds(e.v,
+                [](string_view s)
+                {
+                    return string_to_field(s);
+                });
+            log <<
+                e.name << ": "
+                "unordered_map " << t0 << " ns, "
+                "perfect hash " << t1 << " ns" << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,field);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/file_stdio.hpp>
+#include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/mmap_file_body.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class file_body_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // Size of the file served in each trial
+    static std::size_t constexpr file_size = 64 * 1024 * 1024;
+
+    // Accepts the serialized buffers without copying them, so that
+    // mostly the cost of producing them is measured. One byte of
+    // every page is read, so that mapped pages are faulted in.
+    struct sink
+    {
+        std::size_t n = 0;
+        unsigned& sum;
+
+        explicit
+        sink(unsigned& sum_)
+            : sum(sum_)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            for(auto it = boost::asio::buffer_sequence_begin(buffers);
+                it != boost::asio::buffer_sequence_end(buffers); ++it)
+            {
+                boost::asio::const_buffer b = *it;
+                auto const p = static_cast<unsigned char const*>(b.data());
+                for(std::size_t i = 0; i < b.size(); i += 4096)
+                    sum += p[i];
+                n += b.size();
+            }
+        }
+    };
+
+    std::string path_;
+    unsigned sum_ = 0;
+
+    void
+    make_file()
+    {
+        path_ = boost::filesystem::unique_path().string<std::string>();
+        std::vector<char> v(1024 * 1024);
+        std::mt19937 rng;
+        for(auto& c : v)
+            c = static_cast<char>(rng());
+        error_code ec;
+        file f;
+        f.open(path_.c_str(), file_mode::write, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        for(std::size_t i = 0; i < file_size / v.size(); ++i)
+        {
+            f.write(v.data(), v.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+    }
+
+    // Returns the throughput in MB/s of serializing the file.
+    // `f` is called to configure each message body.
+    template<class Body, class F>
+    double
+    throughput(F const& f)
+    {
+        std::size_t const repeat = 8;
+        std::uint64_t total = 0;
+        auto const t0 = clock_type::now();
+        for(std::size_t i = 0; i < repeat; ++i)
+        {
+            error_code ec;
+            response<Body> res{status::ok, 11};
+            res.body().open(path_.c_str(), file_mode::scan, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f(res.body());
+            res.prepare_payload();
+            serializer<false, Body> sr{res};
+            while(! sr.is_done())
+            {
+                sink visit{sum_};
+                sr.next(ec, visit);
+                if(! BEAST_EXPECTS(! ec, ec.message()))
+                    return 0;
+                sr.consume(visit.n);
+                total += visit.n;
+            }
+        }
+        std::chrono::duration<double> const elapsed =
+            clock_type::now() - t0;
+        BEAST_EXPECT(total > repeat * file_size);
+        return (static_cast<double>(total) /
+            elapsed.count()) / (1024 * 1024);
+    }
+
+    template<class File>
+    void
+    doBench(char const* name)
+    {
+        using body = basic_file_body<File>;
+        struct size
+        {
+            std::size_t n;
+            bool adaptive;
+
+            void
+            operator()(typename body::value_type& v) const
+            {
+                v.buffer_size(n, adaptive);
+            }
+        };
+        log << name << std::endl;
+        log <<
+            "  fixed 4KB:       " <<
+            throughput<body>(size{4096, false}) << " MB/s" << std::endl;
+        log <<
+            "  adaptive 64KB:   " <<
+            throughput<body>(size{65536, true}) << " MB/s" << std::endl;
+        log <<
+            "  adaptive 1MB:    " <<
+            throughput<body>(size{1024 * 1024, true}) << " MB/s" << std::endl;
+        log <<
+            "  fixed 1MB:       " <<
+            throughput<body>(size{1024 * 1024, false}) << " MB/s" << std::endl;
+    }
+
+    struct no_options
+    {
+        template<class T>
+        void
+        operator()(T&) const
+        {
+        }
+    };
+
+    void
+    run() override
+    {
+        make_file();
+
+        // Warm the page cache
+        throughput<file_body>(no_options{});
+
+        doBench<file_stdio>("file_stdio");
+    #if BOOST_BEAST_USE_POSIX_FILE
+        doBench<file_posix>("file_posix");
+    #endif
+    #if BOOST_BEAST_USE_WIN32_FILE
+        doBench<file_win32>("file_win32");
+    #endif
+    #if BOOST_BEAST_USE_MMAP_FILE
+        log << "mmap_file_body" << std::endl;
+        log <<
+            "  mapping:         " <<
+            throughput<mmap_file_body>(no_options{}) <<
+            " MB/s" << std::endl;
+    #endif
+
+        log << "(checksum " << sum_ << ")" << std::endl;
+        error_code ec;
+        boost::filesystem::remove(path_, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,file_body);
+
+} // http
+} // beast
+} // boost
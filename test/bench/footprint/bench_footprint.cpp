@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/experimental/test/stream.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count the bytes currently allocated from the free store,
+// so the heap memory owned by a stream can be measured.
+
+namespace {
+
+std::atomic<std::size_t> live_bytes{0};
+
+// Keeps the returned storage aligned for any type
+std::size_t constexpr header_size = sizeof(std::max_align_t);
+
+} // (anon)
+
+void*
+operator new(std::size_t n)
+{
+    auto const p = static_cast<char*>(
+        std::malloc(n + header_size));
+    if(! p)
+        throw std::bad_alloc{};
+    *reinterpret_cast<std::size_t*>(p) = n;
+    live_bytes += n;
+    return p + header_size;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    if(! p)
+        return;
+    auto const b = static_cast<char*>(p) - header_size;
+    live_bytes -= *reinterpret_cast<std::size_t*>(b);
+    std::free(b);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class footprint_test : public beast::unit_test::suite
+{
+public:
+    using ws_type = stream<test::stream&>;
+
+    struct connection
+    {
+        test::stream ts1;
+        test::stream ts2;
+        std::unique_ptr<ws_type> client;
+        std::unique_ptr<ws_type> server;
+        flat_buffer b1;
+        flat_buffer b2;
+
+        explicit
+        connection(boost::asio::io_context& ioc)
+            : ts1(ioc)
+            , ts2(ioc)
+            , client(new ws_type(ts1))
+            , server(new ws_type(ts2))
+        {
+            ts1.connect(ts2);
+        }
+    };
+
+    struct result
+    {
+        std::size_t client;
+        std::size_t server;
+    };
+
+    // Returns the bytes used by each stream, after
+    // the handshake and one message in each direction.
+    result
+    measure(permessage_deflate const& pmd, bool idle)
+    {
+        std::size_t const count = 100;
+        std::string const msg(1000, '*');
+        boost::asio::io_context ioc;
+        std::vector<std::unique_ptr<connection>> v;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            v.emplace_back(new connection(ioc));
+            auto& c = *v.back();
+            c.client->set_option(pmd);
+            c.server->set_option(pmd);
+            c.client->idle_compaction(idle);
+            c.server->idle_compaction(idle);
+            c.server->async_accept(
+                [&](error_code ec)
+                {
+                    if(! BEAST_EXPECTS(! ec, ec.message()))
+                        return;
+                    c.server->async_read(c.b2,
+                        [&](error_code ec, std::size_t)
+                        {
+                            if(! BEAST_EXPECTS(! ec, ec.message()))
+                                return;
+                            c.server->async_write(c.b2.data(),
+                                [&](error_code ec, std::size_t)
+                                {
+                                    BEAST_EXPECTS(! ec, ec.message());
+                                });
+                        });
+                });
+            c.client->async_handshake("localhost", "/",
+                [&](error_code ec)
+                {
+                    if(! BEAST_EXPECTS(! ec, ec.message()))
+                        return;
+                    c.client->async_write(boost::asio::buffer(msg),
+                        [&](error_code ec, std::size_t)
+                        {
+                            if(! BEAST_EXPECTS(! ec, ec.message()))
+                                return;
+                            c.client->async_read(c.b1,
+                                [&](error_code ec, std::size_t)
+                                {
+                                    BEAST_EXPECTS(! ec, ec.message());
+                                });
+                        });
+                });
+        }
+        ioc.run();
+        for(auto& c : v)
+        {
+            BEAST_EXPECT(c->b1.size() == msg.size());
+            c->b1 = flat_buffer{};
+            c->b2 = flat_buffer{};
+        }
+
+        // Destroy the clients, then the servers
+        result r;
+        auto const n0 = live_bytes.load();
+        for(auto& c : v)
+            c->client.reset();
+        auto const n1 = live_bytes.load();
+        for(auto& c : v)
+            c->server.reset();
+        auto const n2 = live_bytes.load();
+        r.client = (n0 - n1) / count;
+        r.server = (n1 - n2) / count;
+        return r;
+    }
+
+    void
+    report(char const* what, permessage_deflate const& pmd)
+    {
+        auto const r0 = measure(pmd, false);
+        auto const r1 = measure(pmd, true);
+        log <<
+            what << ": " <<
+            "client " << r0.client << " bytes, " <<
+            "server " << r0.server << " bytes; " <<
+            "idle compaction: " <<
+            "client " << r1.client << " bytes, " <<
+            "server " << r1.server << " bytes" << std::endl;
+        BEAST_EXPECT(r1.client <= r0.client);
+        BEAST_EXPECT(r1.server <= r0.server);
+    }
+
+    void
+    run() override
+    {
+        log << "Bytes per idle stream" << std::endl;
+
+        permessage_deflate pmd;
+        report("no pmd", pmd);
+
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        report("pmd", pmd);
+
+        pmd.client_no_context_takeover = true;
+        pmd.server_no_context_takeover = true;
+        report("pmd, no context takeover", pmd);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,footprint);
+
+} // websocket
+} // beast
+} // boost
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/websocket/detail/mask.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class mask_test : public beast::unit_test::suite
+{
+    std::mt19937 rng_;
+
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // The original byte at a time kernel, for comparison
+    static
+    void
+    mask_bytes(
+        boost::asio::mutable_buffer& b,
+        websocket::detail::prepared_key& key)
+    {
+        auto n = b.size();
+        auto mask = key;
+        auto p = static_cast<unsigned char*>(b.data());
+        while(n >= 4)
+        {
+            for(int i = 0; i < 4; ++i)
+                p[i] ^= mask[i];
+            p += 4;
+            n -= 4;
+        }
+        if(n > 0)
+        {
+            for(std::size_t i = 0; i < n; ++i)
+                p[i] ^= mask[i];
+            websocket::detail::rol(key, n);
+        }
+    }
+
+    template<class F>
+    double
+    throughput(std::size_t size, F const& f)
+    {
+        // Mask roughly 1GB per trial
+        std::size_t const repeat =
+            (std::max)(std::size_t{1}, (1024 * 1024 * 1024) / size);
+        std::vector<unsigned char> v(size);
+        for(auto& c : v)
+            c = static_cast<unsigned char>(rng_());
+        websocket::detail::prepared_key key;
+        websocket::detail::prepare_key(key, rng_());
+        auto const t0 = clock_type::now();
+        for(std::size_t i = 0; i < repeat; ++i)
+        {
+            boost::asio::mutable_buffer b(v.data(), v.size());
+            f(b, key);
+        }
+        std::chrono::duration<double> const elapsed =
+            clock_type::now() - t0;
+        BEAST_EXPECT(v.size() == size);
+        return (static_cast<double>(size) * repeat /
+            elapsed.count()) / (1024 * 1024 * 1024);
+    }
+
+    void
+    run() override
+    {
+        for(std::size_t size : {
+            16, 125, 1024, 4096, 16384, 65536, 1024 * 1024 })
+        {
+            auto const bytes = throughput(size,
+                [](boost::asio::mutable_buffer& b,
+                    websocket::detail::prepared_key& key)
+                {
+                    mask_bytes(b, key);
+                });
+            auto const words = throughput(size,
+                [](boost::asio::mutable_buffer& b,
+                    websocket::detail::prepared_key& key)
+                {
+                    websocket::detail::mask_inplace(b, key);
+                });
+            log <<
+                "size " << size << ": "
+                "bytes " << bytes << " GB/s, "
+                "mask_inplace " << words << " GB/s" << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,mask);
+
+} // beast
+} // boost
@@ -19,7 +19,9 @@
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/unit_test/suite.hpp>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 namespace boost {
@@ -129,6 +131,40 @@ public:
             }
     }
 
+    template<class Parser, class Arg>
+    void
+    testParser3(std::size_t repeat, corpus const& v, Arg const& arg)
+    {
+        while(repeat--)
+            for(auto const& b : v)
+            {
+                Parser p{arg};
+                p.header_limit((std::numeric_limits<std::uint32_t>::max)());
+                error_code ec;
+                feed(b.data(), p, ec);
+                if(! BEAST_EXPECTS(! ec, ec.message()))
+                    log << buffers_to_string(b.data()) << std::endl;
+            }
+    }
+
+    // Parse only the header of each message
+    template<class Parser>
+    void
+    testHeader(std::size_t repeat, corpus const& v)
+    {
+        while(repeat--)
+            for(auto const& b : v)
+            {
+                Parser p;
+                p.header_limit((std::numeric_limits<std::uint32_t>::max)());
+                error_code ec;
+                p.put(b.data(), ec);
+                if(! BEAST_EXPECTS(! ec, ec.message()))
+                    log << buffers_to_string(b.data()) << std::endl;
+                BEAST_EXPECT(p.is_header_done());
+            }
+    }
+
     template<class Function>
     void
     timedTest(std::size_t repeat, std::string const& name, Function&& f)
@@ -225,6 +261,178 @@ public:
         }
     };
 
+    // Stores the header in a Fields container, to measure the container
+    template<bool isRequest, class Fields>
+    struct fields_parser : basic_parser<
+        isRequest, fields_parser<isRequest, Fields>>
+    {
+        header<isRequest, Fields> h;
+
+        template<class... Args>
+        explicit
+        fields_parser(Args&&... args)
+            : h(std::forward<Args>(args)...)
+        {
+        }
+
+        void
+        on_request_impl(verb method, string_view method_str,
+            string_view target, int version, error_code& ec)
+        {
+            h.target(target);
+            if(method != verb::unknown)
+                h.method(method);
+            else
+                h.method_string(method_str);
+            h.version(version);
+            ec.assign(0, ec.category());
+        }
+
+        void
+        on_response_impl(int code,
+            string_view reason,
+                int version, error_code& ec)
+        {
+            h.result(code);
+            h.reason(reason);
+            h.version(version);
+            ec.assign(0, ec.category());
+        }
+
+        void
+        on_field_impl(field name,
+            string_view name_string, string_view value, error_code& ec)
+        {
+            h.insert(name, name_string, value);
+            ec.assign(0, ec.category());
+        }
+
+        void
+        on_header_impl(error_code& ec)
+        {
+            ec.assign(0, ec.category());
+        }
+
+        void
+        on_body_init_impl(
+            boost::optional<std::uint64_t> const&,
+            error_code& ec)
+        {
+            ec.assign(0, ec.category());
+        }
+
+        std::size_t
+        on_body_impl(string_view s, error_code& ec)
+        {
+            ec.assign(0, ec.category());
+            return s.size();
+        }
+
+        void
+        on_chunk_header_impl(std::uint64_t,
+            string_view, error_code& ec)
+        {
+            ec.assign(0, ec.category());
+        }
+
+        std::size_t
+        on_chunk_body_impl(std::uint64_t,
+            string_view s, error_code& ec)
+        {
+            ec.assign(0, ec.category());
+            return s.size();
+        }
+
+        void
+        on_finish_impl(error_code& ec)
+        {
+            ec.assign(0, ec.category());
+        }
+    };
+
+    // Memory for the fields of one message. The arena is
+    // reused once everything allocated from it is freed.
+    struct arena
+    {
+        std::size_t used = 0;
+        std::size_t count = 0;
+        std::aligned_storage<65536, 16>::type buf;
+
+        char*
+        data()
+        {
+            return reinterpret_cast<char*>(&buf);
+        }
+    };
+
+    template<class T>
+    class arena_allocator
+    {
+        template<class U>
+        friend class arena_allocator;
+
+        arena* a_;
+
+    public:
+        using value_type = T;
+
+        explicit
+        arena_allocator(arena& a) noexcept
+            : a_(&a)
+        {
+        }
+
+        template<class U>
+        arena_allocator(arena_allocator<U> const& other) noexcept
+            : a_(other.a_)
+        {
+        }
+
+        value_type*
+        allocate(std::size_t n)
+        {
+            auto const size = (n * sizeof(T) + 15) & ~std::size_t{15};
+            if(size > sizeof(a_->buf) - a_->used)
+                return static_cast<value_type*>(
+                    ::operator new(n * sizeof(T)));
+            auto const p = a_->data() + a_->used;
+            a_->used += size;
+            ++a_->count;
+            return reinterpret_cast<value_type*>(p);
+        }
+
+        void
+        deallocate(value_type* p, std::size_t) noexcept
+        {
+            auto const c = reinterpret_cast<char*>(p);
+            if(std::less<char*>{}(c, a_->data()) ||
+                ! std::less<char*>{}(c, a_->data() + sizeof(a_->buf)))
+                return ::operator delete(p);
+            if(--a_->count == 0)
+                a_->used = 0;
+        }
+
+        template<class U>
+        friend
+        bool
+        operator==(arena_allocator const& lhs,
+            arena_allocator<U> const& rhs) noexcept
+        {
+            return lhs.a_ == rhs.a_;
+        }
+
+        template<class U>
+        friend
+        bool
+        operator!=(arena_allocator const& lhs,
+            arena_allocator<U> const& rhs) noexcept
+        {
+            return ! (lhs == rhs);
+        }
+    };
+
+    using arena_fields = basic_flat_fields<arena_allocator<char>>;
+
     void
     testSpeed()
     {
@@ -263,6 +471,48 @@ public:
                     false, dynamic_body, fields>>(
                         Repeat, cres_);
             });
+        timedTest(Trials, "http::basic_parser, fields",
+            [&]
+            {
+                testParser2<fields_parser<true, fields>>(
+                    Repeat, creq_);
+                testParser2<fields_parser<false, fields>>(
+                    Repeat, cres_);
+            });
+        timedTest(Trials, "http::basic_parser, flat_fields",
+            [&]
+            {
+                testParser2<fields_parser<true, flat_fields>>(
+                    Repeat, creq_);
+                testParser2<fields_parser<false, flat_fields>>(
+                    Repeat, cres_);
+            });
+        timedTest(Trials, "http::basic_parser, flat_fields, arena",
+            [&]
+            {
+                arena a;
+                arena_allocator<char> const alloc{a};
+                testParser3<fields_parser<true, arena_fields>>(
+                    Repeat, creq_, alloc);
+                testParser3<fields_parser<false, arena_fields>>(
+                    Repeat, cres_, alloc);
+            });
+        timedTest(Trials, "http::parser, header only",
+            [&]
+            {
+                testHeader<request_parser<empty_body>>(
+                    Repeat, creq_);
+                testHeader<response_parser<empty_body>>(
+                    Repeat, cres_);
+            });
+        timedTest(Trials, "http::header_view_parser",
+            [&]
+            {
+                testHeader<request_header_view_parser<>>(
+                    Repeat, creq_);
+                testHeader<response_header_view_parser<>>(
+                    Repeat, cres_);
+            });
 #if 1
         timedTest(Trials, "nodejs_parser",
             [&]
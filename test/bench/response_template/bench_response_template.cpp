@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/http/response_template.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class response_template_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static std::size_t constexpr repeat = 1000000;
+
+    char const* date_ = "Sun, 06 Nov 1994 08:49:37 GMT";
+
+    // Stands in for the socket
+    char out_[4096];
+    std::size_t total_ = 0;
+
+    struct visit
+    {
+        response_template_test& self;
+        std::size_t& n;
+
+        template<class ConstBufferSequence>
+        void
+        operator()(error_code&, ConstBufferSequence const& buffers)
+        {
+            n = 0;
+            for(auto it = boost::asio::buffer_sequence_begin(buffers);
+                it != boost::asio::buffer_sequence_end(buffers); ++it)
+            {
+                boost::asio::const_buffer const b = *it;
+                std::memcpy(self.out_ + n, b.data(), b.size());
+                n += b.size();
+            }
+            self.total_ += n;
+        }
+    };
+
+    template<class Fields>
+    void
+    serialize(response<empty_body, Fields> const& res)
+    {
+        error_code ec;
+        serializer<false, empty_body, Fields> sr{res};
+        do
+        {
+            std::size_t n;
+            sr.next(ec, visit{*this, n});
+            sr.consume(n);
+        }
+        while(! sr.is_done());
+    }
+
+    template<class Fields>
+    static
+    void
+    fill(header<false, Fields>& h)
+    {
+        h.set(field::server, "Beast/188");
+        h.set(field::content_type, "text/html; charset=utf-8");
+        h.set(field::cache_control, "public, max-age=3600");
+        h.set(field::vary, "Accept-Encoding");
+        h.set(field::x_frame_options, "SAMEORIGIN");
+    }
+
+    template<class F>
+    double
+    nanoseconds(F const& f)
+    {
+        total_ = 0;
+        auto const t0 = clock_type::now();
+        for(std::size_t i = 0; i < repeat; ++i)
+            f(i);
+        std::chrono::duration<double, std::nano> const elapsed =
+            clock_type::now() - t0;
+        BEAST_EXPECT(total_ > 0);
+        return elapsed.count() / repeat;
+    }
+
+    // Every response builds its header
+    void
+    testBuild()
+    {
+        auto const ns = nanoseconds(
+            [&](std::size_t i)
+            {
+                response<empty_body> res;
+                res.result(status::ok);
+                fill(res);
+                res.set(field::date, date_);
+                res.content_length(i);
+                serialize(res);
+            });
+        log << "fields, built per response: " << ns << " ns" << std::endl;
+    }
+
+    // The header is kept, only the slots change
+    void
+    testReuse()
+    {
+        response<empty_body> res;
+        fill(res);
+        auto const ns = nanoseconds(
+            [&](std::size_t i)
+            {
+                res.result(status::ok);
+                res.set(field::date, date_);
+                res.content_length(i);
+                serialize(res);
+            });
+        log << "fields, reused: " << ns << " ns" << std::endl;
+    }
+
+    void
+    testTemplate()
+    {
+        response_header<> h;
+        fill(h);
+        response_template t{h};
+        auto const ns = nanoseconds(
+            [&](std::size_t i)
+            {
+                t.result(status::ok);
+                t.date(date_);
+                t.content_length(i);
+                auto const b = t.data();
+                std::memcpy(out_, b.data(), b.size());
+                total_ += b.size();
+            });
+        log << "response_template: " << ns << " ns" << std::endl;
+    }
+
+    void
+    testSame()
+    {
+        response<empty_body> res;
+        res.result(status::ok);
+        fill(res);
+        res.set(field::date, date_);
+        res.content_length(1234);
+        std::size_t n = 0;
+        {
+            error_code ec;
+            serializer<false, empty_body> sr{res};
+            sr.next(ec, visit{*this, n});
+        }
+        std::string const expected(out_, n);
+        response_header<> h;
+        fill(h);
+        response_template t{h};
+        t.date(date_);
+        t.content_length(1234);
+        auto const b = t.data();
+        BEAST_EXPECT(std::string(
+            static_cast<char const*>(b.data()), b.size()) == expected);
+    }
+
+    void
+    run() override
+    {
+        testSame();
+        testBuild();
+        testReuse();
+        testTemplate();
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,response_template);
+
+} // http
+} // beast
+} // boost
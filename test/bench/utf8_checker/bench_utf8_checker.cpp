@@ -86,11 +86,31 @@ public:
         return s;
     }
 
+    // Text with roughly one multi-byte
+    // code point in every eight
+    std::string
+    corpus_utf8(std::size_t n)
+    {
+        static char const* const cps[] = {
+            "\xc3\xa9", "\xd0\x96", "\xe2\x82\xac",
+            "\xe6\x97\xa5", "\xf0\x9f\x98\x80" };
+        std::string s;
+        s.reserve(n + 4);
+        while(s.size() < n)
+        {
+            if(rand(8) == 0)
+                s.append(cps[rand(5)]);
+            else
+                s.push_back(static_cast<char>(' ' + rand(95)));
+        }
+        return s;
+    }
+
     void
     checkBeast(std::string const& s)
     {
-        beast::websocket::detail::check_utf8(
-            s.data(), s.size());
+        BEAST_EXPECT(beast::websocket::detail::check_utf8(
+            s.data(), s.size()));
     }
 
 #if BEAST_USE_BOOST_LOCALE_BENCHMARK
@@ -122,6 +142,7 @@ public:
     run() override
     {
         auto const s = corpus(32 * 1024 * 1024);
+        auto const u = corpus_utf8(32 * 1024 * 1024);
         for(int i = 0; i < 5; ++ i)
         {
             auto const elapsed = test([&]{
@@ -133,6 +154,17 @@ public:
             });
             log << "beast:  " << throughput(elapsed, s.size()) << " char/s" << std::endl;
         }
+        for(int i = 0; i < 5; ++ i)
+        {
+            auto const elapsed = test([&]{
+                checkBeast(u);
+                checkBeast(u);
+                checkBeast(u);
+                checkBeast(u);
+                checkBeast(u);
+            });
+            log << "beast (utf8):  " << throughput(elapsed, u.size()) << " char/s" << std::endl;
+        }
     #if BEAST_USE_BOOST_LOCALE_BENCHMARK
         for(int i = 0; i < 5; ++ i)
         {
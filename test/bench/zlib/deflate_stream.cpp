@@ -65,11 +65,12 @@ public:
     }
 
     std::string
-    doDeflateBeast(string_view const& in)
+    doDeflateBeast(string_view const& in, bool fast = false)
     {
         z_params zs;
         memset(&zs, 0, sizeof(zs));
         deflate_stream ds;
+        ds.fast_hash(fast);
         ds.reset(
             Z_DEFAULT_COMPRESSION,
             15,
@@ -119,6 +120,27 @@ public:
         return out;
     }
 
+    std::string
+    doInflateZLib(string_view const& in, std::size_t size)
+    {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if(inflateInit2(&zs, -15) != Z_OK)
+            throw std::logic_error("inflateInit2 failed");
+        std::string out;
+        out.resize(size);
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = static_cast<uInt>(out.size());
+        auto const result = inflate(&zs, Z_SYNC_FLUSH);
+        inflateEnd(&zs);
+        if(result != Z_OK && result != Z_STREAM_END)
+            throw std::logic_error("inflate failed");
+        out.resize(zs.total_out);
+        return out;
+    }
+
     void
     doCorpus(
         std::size_t size,
@@ -130,50 +152,51 @@ public:
         log <<
             std::left << std::setw(10) << (std::to_string(size) + "B") <<
             std::right << std::setw(12) << "Beast" << "     " <<
-            std::right << std::setw(12) << "ZLib" <<
+            std::right << std::setw(12) << "ZLib" << "     " <<
+            std::right << std::setw(12) << "Fast hash" <<
                 std::endl;
-        for(std::size_t i = 0; i < trials; ++i)
-        {
-            test::timer t;
-            log << std::left << std::setw(10) << "corpus1";
-            std::string out1;
-            for(std::size_t j = 0; j < repeat; ++j)
-                out1 = doDeflateBeast(c1);
-            auto const t1 =
-                test::throughput(t.elapsed(), size * repeat);
-            log << std::right << std::setw(12) << t1 << " B/s ";
-            std::string out2;
-            for(std::size_t j = 0; j < repeat; ++j)
-                out2 = doDeflateZLib(c1);
-            BEAST_EXPECT(out1 == out2);
-            auto const t2 =
-                test::throughput(t.elapsed(), size * repeat);
-            log << std::right << std::setw(12) << t2 << " B/s";
-            log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
-            log << std::endl;
-        }
-        for(std::size_t i = 0; i < trials; ++i)
-        {
-            test::timer t;
-            log << std::left << std::setw(10) << "corpus2";
-            std::string out1;
-            for(std::size_t j = 0; j < repeat; ++j)
-                out1 = doDeflateBeast(c2);
-            auto const t1 =
-                test::throughput(t.elapsed(), size * repeat);
-            log << std::right << std::setw(12) << t1 << " B/s ";
-            std::string out2;
-            for(std::size_t j = 0; j < repeat; ++j)
-                out2 = doDeflateZLib(c2);
-            BEAST_EXPECT(out1 == out2);
-            auto const t2 =
-                test::throughput(t.elapsed(), size * repeat);
-            log << std::right << std::setw(12) << t2 << " B/s";
-            log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
-            log << std::endl;
-        }
+        auto const corpus =
+            [&](char const* name, std::string const& c)
+            {
+                for(std::size_t i = 0; i < trials; ++i)
+                {
+                    test::timer t;
+                    log << std::left << std::setw(10) << name;
+                    std::string out1;
+                    for(std::size_t j = 0; j < repeat; ++j)
+                        out1 = doDeflateBeast(c);
+                    auto const t1 =
+                        test::throughput(t.elapsed(), size * repeat);
+                    log << std::right << std::setw(12) << t1 << " B/s ";
+                    t = {};
+                    std::string out2;
+                    for(std::size_t j = 0; j < repeat; ++j)
+                        out2 = doDeflateZLib(c);
+                    BEAST_EXPECT(out1 == out2);
+                    auto const t2 =
+                        test::throughput(t.elapsed(), size * repeat);
+                    log << std::right << std::setw(12) << t2 << " B/s ";
+                    t = {};
+                    std::string out3;
+                    for(std::size_t j = 0; j < repeat; ++j)
+                        out3 = doDeflateBeast(c, true);
+                    auto const t3 =
+                        test::throughput(t.elapsed(), size * repeat);
+                    BEAST_EXPECT(doInflateZLib(out3, size) == c);
+                    log << std::right << std::setw(12) << t3 << " B/s";
+                    log << std::right << std::setw(8) <<
+                        int(double(t1)*100/t2-100) << "%";
+                    log << std::right << std::setw(8) <<
+                        int(double(t3)*100/t2-100) << "%";
+                    log << std::right << std::setw(10) <<
+                        out1.size() << "B";
+                    log << std::right << std::setw(10) <<
+                        out3.size() << "B";
+                    log << std::endl;
+                }
+            };
+        corpus("corpus1", c1);
+        corpus("corpus2", c2);
         log << std::endl;
     }
 
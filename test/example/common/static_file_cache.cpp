@@ -0,0 +1,324 @@
+//
+// Copyright (c) 2016-2017 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include "example/common/static_file_cache.hpp"
+
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/unit_test/suite.hpp>
+#include <boost/filesystem.hpp>
+
+namespace boost {
+namespace beast {
+
+class static_file_cache_test : public beast::unit_test::suite
+{
+public:
+    std::string root_;
+
+    void
+    make_file(std::string const& name, std::string const& data)
+    {
+        error_code ec;
+        file f;
+        f.open((root_ + "/" + name).c_str(), file_mode::write, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        f.write(data.data(), data.size(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    static
+    std::string
+    text(std::size_t n)
+    {
+        std::string s;
+        for(std::size_t i = 0; s.size() < n; ++i)
+            s += "line " + std::to_string(i % 10) + "\n";
+        s.resize(n);
+        return s;
+    }
+
+    static
+    http::request<http::string_body>
+    make_request(
+        string_view accept_encoding,
+        string_view if_none_match = {})
+    {
+        http::request<http::string_body> req{http::verb::get, "/", 11};
+        if(! accept_encoding.empty())
+            req.set(http::field::accept_encoding, accept_encoding);
+        if(! if_none_match.empty())
+            req.set(http::field::if_none_match, if_none_match);
+        return req;
+    }
+
+    // Return the value of a field in a serialized header, or
+    // "-" if the field is absent.
+    static
+    std::string
+    field_value(
+        static_file_cache::response const& res,
+        string_view name)
+    {
+        auto const h = buffers_to_string(res.header().data());
+        auto const key = "\r\n" + name.to_string() + ": ";
+        auto const pos = h.find(key);
+        if(pos == std::string::npos)
+            return "-";
+        auto const first = pos + key.size();
+        return h.substr(first, h.find("\r\n", first) - first);
+    }
+
+    std::shared_ptr<static_file_cache::asset const>
+    get(static_file_cache& cache, string_view target)
+    {
+        error_code ec;
+        auto p = cache.get(target, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p != nullptr);
+        return p;
+    }
+
+    void
+    testAcceptEncoding()
+    {
+        static_file_cache cache{root_};
+        auto const a = get(cache, "/index.html");
+        if(! BEAST_EXPECT(! a->gzip().empty()))
+            return;
+
+        auto const check =
+            [&](string_view accept_encoding, bool gzip)
+            {
+                auto const res = static_file_cache::make_response(
+                    *a, make_request(accept_encoding));
+                BEAST_EXPECTS(res.header().result() == http::status::ok,
+                    accept_encoding);
+                if(gzip)
+                {
+                    BEAST_EXPECTS(field_value(res, "Content-Encoding") ==
+                        "gzip", accept_encoding);
+                    BEAST_EXPECTS(res.body().size() == a->gzip().size(),
+                        accept_encoding);
+                }
+                else
+                {
+                    BEAST_EXPECTS(field_value(res,
+                        "Content-Encoding") == "-", accept_encoding);
+                    BEAST_EXPECTS(res.body().size() ==
+                        a->identity().size(), accept_encoding);
+                }
+                BEAST_EXPECTS(*res.header().content_length() ==
+                    res.body().size(), accept_encoding);
+            };
+
+        check("",                       false);
+        check("gzip",                   true);
+        check("GZip",                   true);
+        check("x-gzip",                 true);
+        check("deflate, gzip",          true);
+        check("deflate",                false);
+        check("identity",               false);
+        check("gzip;q=0",               false);
+        check("gzip;q=0.000",           false);
+        check("gzip;q=0.5",             true);
+        check("*",                      true);
+        check("*;q=0",                  false);
+
+        // an explicit gzip takes precedence over "*"
+        check("*;q=0, gzip",            true);
+        check("gzip, *;q=0",            true);
+        check("gzip;q=0, *",            false);
+        check("*, gzip;q=0",            false);
+        check("x-gzip;q=0, gzip",       true);
+
+        // a file not worth compressing is always sent as is
+        auto const b = get(cache, "/image.png");
+        BEAST_EXPECT(b->gzip().empty());
+        auto const res = static_file_cache::make_response(
+            *b, make_request("gzip"));
+        BEAST_EXPECT(field_value(res, "Content-Encoding") == "-");
+        BEAST_EXPECT(field_value(res, "Vary") == "-");
+    }
+
+    void
+    testResponse()
+    {
+        static_file_cache cache{root_};
+        auto const a = get(cache, "/index.html");
+
+        // the version and keep-alive follow the request
+        auto req = make_request("");
+        auto res = static_file_cache::make_response(*a, req);
+        BEAST_EXPECT(res.header().version() == 11);
+        BEAST_EXPECT(field_value(res, "Connection") == "-");
+        res = static_file_cache::make_response(*a, req, false);
+        BEAST_EXPECT(field_value(res, "Connection") == "close");
+        req.version(10);
+        res = static_file_cache::make_response(*a, req);
+        BEAST_EXPECT(res.header().version() == 10);
+        BEAST_EXPECT(field_value(res, "Connection") == "-");
+        req.keep_alive(true);
+        res = static_file_cache::make_response(*a, req);
+        BEAST_EXPECT(field_value(res, "Connection") == "keep-alive");
+
+        // a HEAD response has the length but no body
+        req.method(http::verb::head);
+        res = static_file_cache::make_response(*a, req);
+        BEAST_EXPECT(res.body().size() == 0);
+        BEAST_EXPECT(*res.header().content_length() ==
+            a->identity().size());
+
+        // the date is set per response, and the
+        // complete response is header then body
+        req.method(http::verb::get);
+        res = static_file_cache::make_response(*a, req);
+        res.header().date("Sun, 06 Nov 1994 08:49:37 GMT");
+        BEAST_EXPECT(field_value(res, "Date") ==
+            "Sun, 06 Nov 1994 08:49:37 GMT");
+        BEAST_EXPECT(buffers_to_string(res.buffers()) ==
+            buffers_to_string(res.header().data()) +
+                a->identity().to_string());
+    }
+
+    void
+    testETag()
+    {
+        static_file_cache cache{root_};
+        auto const a = get(cache, "/index.html");
+        BEAST_EXPECT(! a->etag().empty());
+        BEAST_EXPECT(! a->gzip_etag().empty());
+        BEAST_EXPECT(a->etag() != a->gzip_etag());
+
+        auto const check =
+            [&](string_view accept_encoding,
+                string_view if_none_match, bool not_modified)
+            {
+                auto const res = static_file_cache::make_response(
+                    *a, make_request(accept_encoding, if_none_match));
+                if(not_modified)
+                {
+                    BEAST_EXPECTS(res.header().result() ==
+                        http::status::not_modified, if_none_match);
+                    BEAST_EXPECTS(res.body().size() == 0, if_none_match);
+                    BEAST_EXPECTS(! res.header().content_length(),
+                        if_none_match);
+                }
+                else
+                {
+                    BEAST_EXPECTS(res.header().result() ==
+                        http::status::ok, if_none_match);
+                    BEAST_EXPECTS(res.body().size() > 0, if_none_match);
+                }
+            };
+
+        auto const& e = a->etag();
+        auto const& g = a->gzip_etag();
+
+        // each encoding carries its own tag
+        BEAST_EXPECT(field_value(static_file_cache::make_response(
+            *a, make_request("")), "ETag") == e);
+        BEAST_EXPECT(field_value(static_file_cache::make_response(
+            *a, make_request("gzip")), "ETag") == g);
+
+        check("",       e,                      true);
+        check("",       g,                      false);
+        check("gzip",   g,                      true);
+        check("gzip",   e,                      false);
+        check("gzip",   "W/" + g,               true);
+        check("gzip",   "\"x\", " + g,          true);
+        check("gzip",   "\"x\",\t" + g + " ",   true);
+        check("",       "\"x\", " + g,          false);
+        check("",       "*",                    true);
+        check("gzip",   "\"x\"",                false);
+    }
+
+    void
+    testEviction()
+    {
+        // room for two of the three files
+        auto const n = text(1000).size();
+        static_file_cache cache{root_, 2 * n + n / 2};
+        auto const a = get(cache, "/a.png");
+        auto const b = get(cache, "/b.png");
+        BEAST_EXPECT(cache.size() == 2 * n);
+
+        // use a, so b is the least recently used
+        BEAST_EXPECT(get(cache, "/a.png") == a);
+        auto const c = get(cache, "/c.png");
+        BEAST_EXPECT(cache.size() == 2 * n);
+        BEAST_EXPECT(get(cache, "/a.png") == a);
+        BEAST_EXPECT(get(cache, "/c.png") == c);
+
+        // b was evicted and is loaded again, evicting a
+        auto const b2 = get(cache, "/b.png");
+        BEAST_EXPECT(b2 != b);
+        BEAST_EXPECT(b2->identity() == b->identity());
+        BEAST_EXPECT(get(cache, "/c.png") == c);
+        BEAST_EXPECT(get(cache, "/a.png") != a);
+
+        cache.erase("/a.png");
+        BEAST_EXPECT(cache.size() == n);
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+    }
+
+    void
+    testGet()
+    {
+        static_file_cache cache{root_, 64 * 1024, 20000};
+        error_code ec;
+
+        // directories map to their index
+        BEAST_EXPECT(get(cache, "/") == get(cache, "/index.html"));
+        BEAST_EXPECT(get(cache, "/?x=1") == get(cache, "/index.html"));
+
+        BEAST_EXPECT(! cache.get("/../index.html", ec));
+        BEAST_EXPECT(ec);
+        BEAST_EXPECT(! cache.get("index.html", ec));
+        BEAST_EXPECT(ec);
+        BEAST_EXPECT(! cache.get("/missing.html", ec));
+        BEAST_EXPECT(ec);
+
+        // too large to cache, but not an error
+        BEAST_EXPECT(! cache.get("/large.txt", ec));
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    run() override
+    {
+        auto const dir =
+            boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path();
+        boost::filesystem::create_directories(dir);
+        root_ = dir.string<std::string>();
+        make_file("index.html", text(10000));
+        make_file("image.png", text(1000));
+        make_file("a.png", text(1000));
+        make_file("b.png", text(1000));
+        make_file("c.png", text(1000));
+        make_file("large.txt", text(30000));
+
+        testAcceptEncoding();
+        testETag();
+        testResponse();
+        testEviction();
+        testGet();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,example,static_file_cache);
+
+} // beast
+} // boost